@@ -0,0 +1,37 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Bloco de uma arena; os blocos formam uma lista do mais novo ao mais antigo
+typedef struct ArenaChunk {
+    struct ArenaChunk *prev;
+    size_t cap;              // bytes úteis em data[]
+    size_t used;             // bytes já entregues
+    max_align_t data[];
+} ArenaChunk;
+
+// Alocador "bump": cada alocação só avança um ponteiro no bloco atual
+typedef struct Arena {
+    ArenaChunk *head;
+} Arena;
+
+// Arena da compilação corrente: tokens, lexemas, AST, tipos e símbolos
+extern Arena compile_arena;
+
+// Memória não inicializada, alinhada a max_align_t
+void *arena_alloc(Arena *a, size_t n);
+
+// Igual a arena_alloc, mas zerada
+void *arena_calloc(Arena *a, size_t n);
+
+// Redimensiona p (alocado com old bytes); cresce no lugar se for o último bloco
+void *arena_grow(Arena *a, void *p, size_t old, size_t n);
+
+// Copia n bytes de s e acrescenta '\0'
+char *arena_strndup(Arena *a, const char *s, size_t n);
+
+// Devolve todos os blocos de uma vez
+void arena_release(Arena *a);
+
+#endif // ARENA_H
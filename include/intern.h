@@ -0,0 +1,14 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+#include <stddef.h>
+
+// Devolve o ponteiro canônico (terminado em '\0') para s[0..len).
+// Nomes iguais => ponteiros iguais, então comparar nomes vira '=='.
+// As strings e a tabela vivem na compile_arena.
+const char *intern(const char *s, size_t len);
+
+// Esquece a tabela (chamar junto com arena_release da compile_arena)
+void intern_reset(void);
+
+#endif // INTERN_H
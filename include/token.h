@@ -19,6 +19,7 @@ typedef enum {
     TK_SYM_MINUS,   // '-'
     TK_SYM_STAR,    // '*'
     TK_SYM_SLASH,   // '/'
+    TK_SYM_PERCENT, // '%'
     TK_AND,         // '&&'
     TK_OR,          // '||'
     TK_SYM_SEMI,    // ';'
@@ -46,6 +47,7 @@ typedef struct Token {
     size_t len;
     int line, col;
     int ival;        // valor literal para TK_NUM
+    const char *name; // nome internado para TK_IDENT (ver intern.h)
 } Token;
 
 #endif
\ No newline at end of file
@@ -8,6 +8,8 @@ typedef struct Type {
     struct Type *base;     // para ponteiros, arrays etc.
     struct Type **params;  // para funções
     int param_count;
+    struct Type *ptr_cache; // pointer_to(this), criado sob demanda
+    struct Type *hnext;     // encadeamento na tabela de tipos de função
 } Type;
 
 extern Type *ty_int;
@@ -15,6 +17,9 @@ extern Type *ty_void;
 
 void init_types(void);
 
+/* Tipos são canônicos: a mesma estrutura devolve sempre o mesmo Type*,
+ * então igualdade de tipos é comparação de ponteiros. func_type copia
+ * 'params' quando o tipo é novo (o vetor do chamador pode ser temporário). */
 Type *pointer_to(Type *base);
 Type *func_type(Type *ret, Type **params, int n);
 
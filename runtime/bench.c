@@ -0,0 +1,51 @@
+/* runtime/bench.c — custo das rotinas de runtime/ no QEMU
+ *
+ * Compilado com o arm-none-eabi-gcc (-nostdlib) e ligado a divide.s e
+ * memory.s; cada kernel é um executável próprio (-DKERNEL=n) e o plugin
+ * de contagem de instruções do QEMU (libinsn.so) dá o total. O kernel 0
+ * é o laço vazio: descontado dele, sobra o custo das N chamadas.
+ *   make -C runtime bench
+ */
+#define N 1000
+
+typedef unsigned int size_t;
+void *memcpy(void *dst, const void *src, size_t n);
+void *memset(void *dst, int c, size_t n);
+int __aeabi_idiv(int n, int d);
+unsigned __aeabi_uidiv(unsigned n, unsigned d);
+
+static unsigned buf_a[256 + 1];
+static unsigned buf_b[256 + 1];
+volatile int sink;
+
+int main(void) {
+    int s = 0;
+    for (int i = 1; i <= N; i++) {
+#if KERNEL == 1         /* divisão com sinal, quociente de até 16 bits */
+        s += __aeabi_idiv(i * 37 * 17, -(i & 15) - 1);
+#elif KERNEL == 2       /* sem sinal, dividendo de 32 bits */
+        s += __aeabi_uidiv(0x80000000u + i * 4099u, (unsigned)i);
+#elif KERNEL == 3       /* memcpy de 1 KiB alinhado */
+        memcpy(buf_a, buf_b, 1024);
+#elif KERNEL == 4       /* memcpy de 1 KiB com origem desalinhada */
+        memcpy(buf_a, (char *)buf_b + 1, 1024);
+#elif KERNEL == 5       /* memset de 1 KiB a partir de um byte ímpar */
+        memset((char *)buf_a + 1, i, 1023);
+#endif
+        __asm__ volatile("" ::: "memory");   // o laço vazio não some
+    }
+    sink = s;
+    return 0;
+}
+
+/* ponto de entrada: pilha, main e saída pelo semihosting */
+__asm__(
+    "    .text\n"
+    "    .global _start\n"
+    "_start:\n"
+    "    ldr sp, =_stack_top\n"
+    "    bl  main\n"
+    "    mov r0, #0x18         @ SYS_EXIT\n"
+    "    ldr r1, =0x20026      @ ADP_Stopped_ApplicationExit\n"
+    "    svc 0x123456\n"
+    "    .ltorg\n");
@@ -0,0 +1,106 @@
+@ runtime/divide.s — divisão inteira do EABI para ARMv4 (sem udiv/clz)
+@
+@   __aeabi_uidiv(n, d)     r0 = n / d                  sem sinal
+@   __aeabi_uidivmod(n, d)  r0 = n / d, r1 = n % d      sem sinal
+@   __aeabi_idiv(n, d)      r0 = n / d                  com sinal
+@   __aeabi_idivmod(n, d)   r0 = n / d, r1 = n % d      com sinal
+@   __smulh(a, b)           r0 = (a * b) >> 32          com sinal
+@
+@ O núcleo é a divisão com restauração desenrolada: uma busca binária
+@ acha o maior k com d << k <= n (cinco comparações no lugar do clz que
+@ o ARMv4 não tem) e o fluxo entra na tabela de 32 passos exatamente no
+@ passo k, de modo que um quociente de b bits custa b passos de 3
+@ instruções e nenhum laço. Com sinal, os valores absolutos passam pelo
+@ mesmo núcleo e os sinais são corrigidos na saída (quociente negativo
+@ se os sinais diferem, resto com o sinal do dividendo).
+@
+@ Só r0–r3 e ip são usados (chamador salva). Divisão por zero devolve
+@ quociente 0 e resto n. A volta é sempre por bx lr: o chamador pode
+@ estar em Thumb (mycc -mthumb), e é para ele que __smulh existe, já
+@ que o Thumb não tem smull (a divisão por constante usa a metade alta).
+
+    .syntax unified
+    .text
+    .global __aeabi_uidiv
+    .global __aeabi_uidivmod
+    .global __aeabi_idiv
+    .global __aeabi_idivmod
+    .global __smulh
+
+__aeabi_idiv:
+__aeabi_idivmod:
+    eor     ip, r0, r1              @ bit 31: sinal do quociente
+    and     ip, ip, #0x80000000
+    orr     ip, ip, r0, lsr #31     @ bit 0: sinal do resto
+    cmp     r0, #0
+    rsblt   r0, r0, #0
+    cmp     r1, #0
+    rsblt   r1, r1, #0
+    b       .Ludivmod
+
+__aeabi_uidiv:
+__aeabi_uidivmod:
+    mov     ip, #0                  @ sem correção de sinal
+.Ludivmod:
+    cmp     r1, #0
+    beq     .Lzero
+    cmp     r0, r1
+    blo     .Lsmall                 @ n < d: q = 0, r = n
+
+    @ k = maior deslocamento com d << k <= n, isto é, d <= n >> k
+    mov     r3, #0
+    mov     r2, r0
+    cmp     r1, r2, lsr #16
+    movls   r2, r2, lsr #16
+    addls   r3, r3, #16
+    cmp     r1, r2, lsr #8
+    movls   r2, r2, lsr #8
+    addls   r3, r3, #8
+    cmp     r1, r2, lsr #4
+    movls   r2, r2, lsr #4
+    addls   r3, r3, #4
+    cmp     r1, r2, lsr #2
+    movls   r2, r2, lsr #2
+    addls   r3, r3, #2
+    cmp     r1, r2, lsr #1
+    addls   r3, r3, #1
+
+    @ entra no passo k: (31 - k) * 12 bytes depois do início da tabela
+    rsb     r3, r3, #31
+    add     r3, r3, r3, lsl #1
+    mov     r2, #0                  @ quociente
+    add     pc, pc, r3, lsl #2
+    mov     r0, r0                  @ não executada: pc já está 8 adiante
+
+    @ passo k: se n >= d << k, n -= d << k; q = 2q + (esse bit)
+    .irp    k, 31,30,29,28,27,26,25,24,23,22,21,20,19,18,17,16,15,14,13,12,11,10,9,8,7,6,5,4,3,2,1,0
+    cmp     r0, r1, lsl #\k
+    adc     r2, r2, r2
+    subhs   r0, r0, r1, lsl #\k
+    .endr
+
+    mov     r1, r0                  @ resto
+    mov     r0, r2                  @ quociente
+.Lsign:
+    cmp     ip, #0
+    bxeq    lr                      @ sem sinal, ou ambos positivos
+    tst     ip, #1
+    rsbne   r1, r1, #0
+    cmp     ip, #0
+    rsblt   r0, r0, #0
+    bx      lr
+
+.Lsmall:
+    mov     r1, r0
+    mov     r0, #0
+    b       .Lsign
+
+.Lzero:
+    mov     r1, r0
+    mov     r0, #0
+    b       .Lsign
+
+__smulh:
+    smull   r2, r3, r0, r1
+    mov     r0, r3
+    bx      lr
@@ -0,0 +1,91 @@
+@ runtime/memory.s — memcpy e memset para ARMv4
+@
+@   memcpy(dst, src, n)   copia n bytes; devolve dst
+@   memset(dst, c, n)     preenche n bytes com (c & 255); devolve dst
+@
+@ Os bytes até dst ficar alinhado a 4 vão um a um; o miolo vai de 16
+@ em 16 bytes com ldmia/stmia (4 registradores por instrução) e depois
+@ de palavra em palavra; a sobra final, de novo byte a byte. Em memcpy,
+@ se origem e destino têm alinhamentos diferentes, nenhum dos dois
+@ chega a 4 junto com o outro e a cópia toda é por bytes.
+@ As duas voltam com bx lr: o chamador pode estar em Thumb.
+
+    .syntax unified
+    .text
+    .global memcpy
+    .global memset
+
+memcpy:
+    stmfd   sp!, {r0, r4-r6}
+    eor     r3, r0, r1
+    tst     r3, #3
+    bne     .Lmc_bytes
+.Lmc_head:
+    tst     r0, #3
+    beq     .Lmc_aligned
+    subs    r2, r2, #1
+    blo     .Lmc_done
+    ldrb    r3, [r1], #1
+    strb    r3, [r0], #1
+    b       .Lmc_head
+.Lmc_aligned:
+    subs    r2, r2, #16
+    blo     .Lmc_tail
+.Lmc_16:
+    ldmia   r1!, {r3-r6}
+    stmia   r0!, {r3-r6}
+    subs    r2, r2, #16
+    bhs     .Lmc_16
+.Lmc_tail:
+    adds    r2, r2, #12             @ sobra (0..15) menos 4
+.Lmc_4:
+    ldrhs   r3, [r1], #4
+    strhs   r3, [r0], #4
+    subshs  r2, r2, #4
+    bhs     .Lmc_4
+    add     r2, r2, #4
+.Lmc_bytes:
+    subs    r2, r2, #1
+    ldrbhs  r3, [r1], #1
+    strbhs  r3, [r0], #1
+    bhs     .Lmc_bytes
+.Lmc_done:
+    ldmfd   sp!, {r0, r4-r6}
+    bx      lr
+
+memset:
+    mov     ip, r0                  @ r0 é devolvido
+    and     r1, r1, #255
+    orr     r1, r1, r1, lsl #8
+    orr     r1, r1, r1, lsl #16
+.Lms_head:
+    tst     ip, #3
+    beq     .Lms_aligned
+    subs    r2, r2, #1
+    bxlo    lr
+    strb    r1, [ip], #1
+    b       .Lms_head
+.Lms_aligned:
+    mov     r3, r1
+    subs    r2, r2, #16
+    blo     .Lms_tail
+    stmfd   sp!, {r4-r5}
+    mov     r4, r1
+    mov     r5, r1
+.Lms_16:
+    stmia   ip!, {r1, r3-r5}
+    subs    r2, r2, #16
+    bhs     .Lms_16
+    ldmfd   sp!, {r4-r5}
+.Lms_tail:
+    adds    r2, r2, #12             @ sobra (0..15) menos 4
+.Lms_4:
+    strhs   r1, [ip], #4
+    subshs  r2, r2, #4
+    bhs     .Lms_4
+    add     r2, r2, #4
+.Lms_bytes:
+    subs    r2, r2, #1
+    strbhs  r1, [ip], #1
+    bhs     .Lms_bytes
+    bx      lr
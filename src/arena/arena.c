@@ -0,0 +1,94 @@
+#include "arena.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_ALIGN      (sizeof(max_align_t))
+#define ARENA_MIN_CHUNK  (64 * 1024)
+#define ARENA_MAX_CHUNK  (4 * 1024 * 1024)
+
+Arena compile_arena;
+
+static size_t align_up(size_t n) {
+    return (n + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+}
+
+// Abre um bloco novo com pelo menos n bytes; tamanho dobra a cada bloco
+static ArenaChunk *new_chunk(Arena *a, size_t n) {
+    size_t cap = a->head ? a->head->cap * 2 : ARENA_MIN_CHUNK;
+    if (cap > ARENA_MAX_CHUNK) cap = ARENA_MAX_CHUNK;
+    if (cap < n) cap = align_up(n);
+    ArenaChunk *c = malloc(sizeof(ArenaChunk) + cap);
+    if (!c) { perror("malloc"); exit(1); }
+    c->prev = a->head;
+    c->cap  = cap;
+    c->used = 0;
+    a->head = c;
+    return c;
+}
+
+// Pedido maior que um bloco normal: bloco próprio, encadeado atrás do atual
+// para não desperdiçar o espaço que ainda resta nele
+static ArenaChunk *big_chunk(Arena *a, size_t n) {
+    ArenaChunk *c = malloc(sizeof(ArenaChunk) + n);
+    if (!c) { perror("malloc"); exit(1); }
+    c->cap  = n;
+    c->used = 0;
+    c->prev = a->head->prev;
+    a->head->prev = c;
+    return c;
+}
+
+void *arena_alloc(Arena *a, size_t n) {
+    n = align_up(n ? n : 1);
+    ArenaChunk *c = a->head;
+    if (c && n > ARENA_MAX_CHUNK / 4)
+        c = big_chunk(a, n);
+    else if (!c || c->cap - c->used < n)
+        c = new_chunk(a, n);
+    void *p = (char *)c->data + c->used;
+    c->used += n;
+    return p;
+}
+
+void *arena_calloc(Arena *a, size_t n) {
+    void *p = arena_alloc(a, n);
+    memset(p, 0, n);
+    return p;
+}
+
+void *arena_grow(Arena *a, void *p, size_t old, size_t n) {
+    if (!p)
+        return arena_alloc(a, n);
+    ArenaChunk *c = a->head;
+    size_t old_al = align_up(old ? old : 1);
+    // última alocação do bloco atual: basta avançar o topo
+    if ((char *)p + old_al == (char *)c->data + c->used) {
+        size_t start = (size_t)((char *)p - (char *)c->data);
+        size_t need  = align_up(n ? n : 1);
+        if (c->cap - start >= need) {
+            c->used = start + need;
+            return p;
+        }
+    }
+    void *q = arena_alloc(a, n);
+    memcpy(q, p, old < n ? old : n);
+    return q;
+}
+
+char *arena_strndup(Arena *a, const char *s, size_t n) {
+    char *r = arena_alloc(a, n + 1);
+    memcpy(r, s, n);
+    r[n] = '\0';
+    return r;
+}
+
+void arena_release(Arena *a) {
+    ArenaChunk *c = a->head;
+    while (c) {
+        ArenaChunk *prev = c->prev;
+        free(c);
+        c = prev;
+    }
+    a->head = NULL;
+}
@@ -1,352 +1,1925 @@
 #include "code_generator.h"
+#include "regalloc.h"
+#include "peephole.h"
+#include "isel.h"
+#include "arena.h"
+#include "intern.h"
+#include <ctype.h>
+#include <limits.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-typedef struct { const char *name; int offset; } Local;
+/* Registradores (AAPCS):
+ *   r0–r3  argumentos/retorno; vregs que não atravessam chamadas
+ *   r4–r10 callee-saved: vregs vivos através de chamadas (e os demais)
+ *   fp     base do quadro
+ *   ip, lr rascunho para operandos derramados e imediatos */
+#define REG_FP 11
+#define REG_IP 12
+#define REG_SP 13
+#define REG_LR 14
+#define NUM_ARG_REGS 4
+#define CALLEE_SAVED 0x7f0u        // r4–r10
 
-static FILE *out;
-static Local locals[256];
-static int   local_count;
-static int   stack_size;
-static int   label_id;
+static const int alloc_regs[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+#define NUM_ALLOC_REGS (int)(sizeof alloc_regs / sizeof alloc_regs[0])
 
-static int lookup_local(const char *name) {
-    for (int i = local_count - 1; i >= 0; i--)
-        if (strcmp(locals[i].name, name) == 0)
-            return locals[i].offset;
-    return 0;
+static FILE         *out;
+static MList         code;          // linhas já emitidas, ainda fora do arquivo
+static char          line[512];     // linha em construção
+static size_t        line_len;
+static IrFunc       *fn;
+static LiveInterval *iv;            // um intervalo por vreg
+static int          *vslot;         // slot do quadro de um vreg derramado
+static int          *uses;          // nº de leituras de cada vreg
+static int           saved_size;    // bytes de r4–r10 salvos no prólogo
+static int           nslots;        // slots do quadro (locais com '&' e derramados)
+static int           ncalls;        // chamadas na função (DIV e MOD inclusive)
+static int           frame_fp;      // quadro com fp: há slots na pilha
+static int           frame_lr;      // lr salvo no prólogo
+static int           lr_touched;    // lr serviu de rascunho
+static int           npushed;       // registradores empilhados no prólogo
+static unsigned      frame_mask;    // e quais são
+static int           emitted;       // instruções emitidas até aqui
+static int           pool_first;    // 1º uso de literal ainda sem .ltorg; -1 se nenhum
+static int           pool_id;
+static int           after_branch;  // última instrução foi um desvio incondicional
+static const char   *pred = "";     // condição das instruções emitidas (if-conversion)
+static int           thumb;         // função corrente em Thumb
+static int           iw_ret;        // volta com bx: o chamador pode estar no outro modo
+static int           push_depth;    // bytes empilhados para uma chamada (Thumb)
+static int           local_id;      // rótulos .Lt internos de uma instrução
+
+Isa codegen_isa = ISA_ARM;
+
+/* 'ldr rX, =...' alcança ±4 KB (no Thumb, 1 KB e só à frente): o pool
+ * vai no fim da função ou, antes disso, assim que o literal pendente
+ * mais antigo ficar longe demais */
+#define POOL_RANGE 900              // instruções (margem sobre 1023 palavras)
+#define THUMB_POOL_RANGE 200        // instruções de 2 bytes (bl tem 4)
+#define THUMB_NEAR_BYTES 1800       // função Thumb em que todo 'b' alcança o alvo
+#define BSS_INLINE 4                // até aqui a .bss é zerada com str; além, memset
+
+// Acumula texto; cada linha completa vira um nó de 'code'
+static void put(const char *s, size_t n) {
+    for (size_t k = 0; k < n; k++) {
+        if (s[k] == '\n') {
+            mlist_line(&code, line, line_len);
+            line_len = 0;
+        } else if (line_len < sizeof line) {
+            line[line_len++] = s[k];
+        }
+    }
+}
+
+static void emit(const char *fmt, ...) {
+    char buf[1024];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(buf, sizeof buf, fmt, ap);
+    va_end(ap);
+    if (*pred && buf[0] == ' ') {   // predicada: 'add' vira 'addgt'
+        size_t k = strspn(buf, " ");
+        k += strcspn(buf + k, " \n");
+        put(buf, k);
+        put(pred, strlen(pred));
+        put(buf + k, strlen(buf + k));
+    } else {
+        put(buf, strlen(buf));
+    }
+    if (fmt[0] == ' ') {            // linha de instrução (rótulos não contam)
+        emitted++;
+        after_branch = 0;
+    }
+}
+
+static void use_literal(void) {
+    if (pool_first < 0)
+        pool_first = emitted;
+}
+
+static void flush_pool(int force) {
+    if (pool_first < 0 || (!force && emitted - pool_first < (thumb ? THUMB_POOL_RANGE : POOL_RANGE)))
+        return;
+    if (after_branch || force) {
+        emit(".ltorg\n");
+    } else {                        // no meio do código: salta por cima
+        emit("    b .Lpool%d\n", pool_id);
+        emit(".ltorg\n.Lpool%d:\n", pool_id++);
+    }
+    pool_first = -1;
+}
+
+static const char *reg_name(int r) {
+    static const char *names[] = { "r0", "r1", "r2", "r3", "r4", "r5", "r6", "r7",
+                                   "r8", "r9", "r10", "fp", "ip", "sp", "lr", "pc" };
+    return names[r];
+}
+
+// Lista de registradores com faixas: {r4-r6, fp, lr}
+static void emit_reglist(unsigned mask) {
+    int first = 1;
+    emit("{");
+    for (int r = 0; r < 16; r++) {
+        if (!(mask & (1u << r))) continue;
+        int e = r;
+        while (e + 1 <= 10 && (mask & (1u << (e + 1))))
+            e++;
+        emit("%s%s", first ? "" : ", ", reg_name(r));
+        if (e > r)
+            emit("-%s", reg_name(e));
+        first = 0;
+        r = e;
+    }
+    emit("}");
+}
+
+static void emit_label(const IrBlock *b) {
+    emit(".L%s_%d", fn->name, b->id);
+}
+
+// Cópia entre registradores; no Thumb, entre r0–r7, só existe o movs
+static void emit_mov(int d, int s) {
+    if (d == s)
+        return;
+    emit("    %s %s, %s\n", thumb && d < 8 && s < 8 ? "movs" : "mov", reg_name(d), reg_name(s));
+}
+
+/* ------------------------------------------------------------------ */
+/* Interworking                                                        */
+/* ------------------------------------------------------------------ */
+
+/* Cada função é gerada em ARM ou em Thumb (-mthumb, -mthumb=auto). O
+ * ARMv4T só troca de modo no bx, pelo bit 0 do endereço: uma chamada
+ * para o outro modo passa por um stub, e quem pode voltar para o outro
+ * modo volta com bx (ldmfd/pop com pc e mov pc, lr não trocam).
+ *   de Thumb para ARM:  __f_from_thumb:  bx pc; nop; .arm; b f
+ *   de ARM para Thumb:  __f_from_arm:    ldr ip, =f; bx ip
+ * Funções de fora (o runtime) são ARM e sempre voltam com bx. */
+#define MODE_ARM   1u
+#define MODE_THUMB 2u
+
+typedef struct {
+    const char *name;
+    int         thumb;      // de fora do programa (o runtime): ARM
+    unsigned    ret_to;     // modos para onde ela pode voltar
+    unsigned    stubs;      // stubs pedidos: de ARM para ela, de Thumb para ela
+} FuncInfo;
+
+static FuncInfo *funcs;
+static int       nfuncs, funcs_cap;
+
+/* Nomes vêm internados (lexer): comparar é comparar ponteiros. Os
+ * literais daqui (main, rotinas do runtime) passam por INTERNED. */
+#define INTERNED(s) intern(s, sizeof s - 1)
+
+static FuncInfo *func_info(const char *name) {
+    for (int k = 0; k < nfuncs; k++)
+        if (funcs[k].name == name)
+            return &funcs[k];
+    if (nfuncs == funcs_cap) {
+        funcs_cap = funcs_cap ? 2 * funcs_cap : 16;
+        funcs = realloc(funcs, sizeof *funcs * funcs_cap);
+        if (!funcs) {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    funcs[nfuncs] = (FuncInfo){ name, 0, 0, 0 };
+    return &funcs[nfuncs++];
+}
+
+static unsigned mode_of(int in_thumb) {
+    return in_thumb ? MODE_THUMB : MODE_ARM;
+}
+
+// Algum desvio volta para um bloco que não vem depois no layout
+static int has_loop(IrFunc *f) {
+    char *seen = calloc(f->nblocks ? f->nblocks : 1, 1);
+    if (!seen) {
+        perror("calloc");
+        exit(1);
+    }
+    int loop = 0;
+    for (IrBlock *b = f->entry; b && !loop; b = b->next) {
+        seen[b->id] = 1;
+        IrInst *t = b->last;
+        if (t && (t->op == IR_JMP || t->op == IR_BR))
+            loop = seen[t->target->id] || (t->op == IR_BR && seen[t->target2->id]);
+    }
+    free(seen);
+    return loop;
+}
+
+/* Modo de cada função e para onde cada uma pode voltar: para o modo de
+ * quem a chama e, se ela é alvo de uma chamada de cauda em ARM, para
+ * onde voltaria quem a chamou assim (no Thumb a chamada de cauda é uma
+ * chamada comum). main volta para o _start, em ARM. */
+static void plan_modes(IrProgram *prog) {
+    nfuncs = 0;
+    for (IrFunc *f = prog->funcs; f; f = f->next)
+        func_info(f->name)->thumb = codegen_isa == ISA_THUMB ||
+                                    (codegen_isa == ISA_AUTO && !has_loop(f));
+    func_info(INTERNED("main"))->ret_to |= MODE_ARM;
+    for (int changed = 1; changed; ) {
+        changed = 0;
+        for (IrFunc *g = prog->funcs; g; g = g->next) {
+            FuncInfo gi = *func_info(g->name);
+            for (IrBlock *b = g->entry; b; b = b->next)
+                for (IrInst *i = b->first; i; i = i->next) {
+                    if (i->op != IR_CALL && i->op != IR_TAILCALL)
+                        continue;
+                    FuncInfo *c = func_info(i->sym);
+                    unsigned to = c->ret_to | mode_of(gi.thumb);
+                    if (i->op == IR_TAILCALL && !gi.thumb)
+                        to = c->ret_to | gi.ret_to;
+                    changed |= to != c->ret_to;
+                    c->ret_to = to;
+                }
+        }
+    }
+}
+
+/* Símbolo a chamar para alcançar sym a partir do modo corrente: o
+ * próprio, ou o stub de troca de modo (que passa a ser emitido) */
+static const char *call_target(const char *sym) {
+    static char buf[256];
+    FuncInfo *c = func_info(sym);
+    if (c->thumb == thumb)
+        return sym;
+    c->stubs |= mode_of(thumb);
+    snprintf(buf, sizeof buf, "__%s_from_%s", sym, thumb ? "thumb" : "arm");
+    return buf;
+}
+
+// Stubs pedidos pelas chamadas; devolve os bytes que ocupam
+static int emit_stubs(void) {
+    int bytes = 0, first = 1;
+    for (int k = 0; k < nfuncs; k++) {
+        if (!(funcs[k].stubs & MODE_THUMB))
+            continue;
+        emit(".thumb\n.align 2\n");       // bx pc vai para a palavra seguinte
+        emit(".thumb_func\n__%s_from_thumb:\n", funcs[k].name);
+        emit("    bx pc\n");
+        emit("    nop\n");
+        emit(".arm\n");
+        emit("    b %s\n", funcs[k].name);
+        bytes += 8;
+    }
+    for (int k = 0; k < nfuncs; k++) {
+        if (!(funcs[k].stubs & MODE_ARM))
+            continue;
+        if (first)
+            emit(".arm\n.align 2\n");
+        first = 0;
+        emit("__%s_from_arm:\n", funcs[k].name);
+        emit("    ldr ip, =%s\n", funcs[k].name);
+        emit("    bx ip\n");
+        bytes += 12;
+    }
+    if (!first)
+        emit(".ltorg\n");
+    return bytes;
+}
+
+/* ------------------------------------------------------------------ */
+/* Intervalos de vida dos vregs                                        */
+/* ------------------------------------------------------------------ */
+
+/* A instrução nº i (ordem de layout) lê seus operandos na posição 2i e
+ * define o resultado em 2i+1: um operando que morre ali pode ceder o
+ * registrador ao destino da mesma instrução. */
+
+static void extend(int v, int p) {
+    if (p < iv[v].start) iv[v].start = p;
+    if (p > iv[v].end)   iv[v].end   = p;
+}
+
+static void read_vreg(Operand o, int p) {
+    if (o.kind == OPD_VREG) {
+        extend(o.v, p);
+        uses[o.v]++;
+    }
+}
+
+static int is_call(const IrInst *i) {
+    /* DIV e MOD viram __aeabi_idiv e __aeabi_idivmod; no Thumb, MULH
+     * chama __smulh e a chamada de cauda é uma chamada comum */
+    return i->op == IR_CALL || i->op == IR_DIV || i->op == IR_MOD ||
+           (thumb && (i->op == IR_MULH || i->op == IR_TAILCALL));
+}
+
+static void build_intervals(void) {
+    int nv = fn->nvregs;
+    for (int v = 0; v < nv; v++)
+        iv[v] = (LiveInterval){ INT_MAX, -1, -1, 0 };
+    memset(uses, 0, sizeof(int) * nv);
+
+    int n = 0, nparams = 0;
+    for (IrBlock *b = fn->entry; b; b = b->next)
+        for (IrInst *i = b->first; i; i = i->next)
+            n++;
+    /* calls[p]: nº de chamadas em posições <= p; a chamada nº i fica em
+     * 2i+1, entre a leitura dos argumentos e a escrita do resultado */
+    int *calls = calloc(2 * n + 1, sizeof(int));
+    if (!calls) {
+        perror("calloc");
+        exit(1);
+    }
+
+    int idx = 0;
+    for (IrBlock *b = fn->entry; b; b = b->next) {
+        int first = idx;
+        for (IrInst *i = b->first; i; i = i->next, idx++) {
+            read_vreg(i->a, 2 * idx);
+            read_vreg(i->b, 2 * idx);
+            read_vreg(i->c, 2 * idx);
+            for (int k = 0; k < i->nargs; k++)
+                read_vreg(i->args[k], 2 * idx);
+            if (i->dst >= 0)
+                extend(i->dst, 2 * idx + 1);
+            if (i->op == IR_PARAM)
+                nparams = idx + 1;
+            if (is_call(i))
+                calls[2 * idx + 1] = 1;
+        }
+        if (idx == first)
+            continue;
+        for (int v = 0; v < nv; v++) {
+            if (bs_has(b->live_in, v))  extend(v, 2 * first);
+            if (bs_has(b->live_out, v)) extend(v, 2 * idx - 1);
+        }
+    }
+    for (int p = 1; p <= 2 * n; p++)
+        calls[p] += calls[p - 1];
+    ncalls = calls[2 * n];
+
+    /* PARAMs são um único movimento paralelo: seus intervalos se sobrepõem */
+    for (IrInst *i = fn->entry->first; i && i->op == IR_PARAM; i = i->next) {
+        iv[i->dst].start = 0;
+        if (iv[i->dst].end < 2 * nparams - 1)
+            iv[i->dst].end = 2 * nparams - 1;
+    }
+
+    /* quem está vivo durante uma chamada só pode morar em r4–r10 */
+    for (int v = 0; v < nv; v++)
+        if (iv[v].end >= 0 && calls[iv[v].end] - calls[iv[v].start] > 0)
+            iv[v].allow = CALLEE_SAVED;
+    free(calls);
+}
+
+/* ------------------------------------------------------------------ */
+/* Operandos                                                           */
+/* ------------------------------------------------------------------ */
+
+/* Deslocamento (em relação a fp) do slot nº k do quadro. O slot 0 fica
+ * no topo da pilha (sp) e os seguintes em endereços crescentes, então
+ * locais declaradas em sequência podem ir e vir num ldm/stm. */
+static int slot_off(int k) {
+    return -(saved_size + 4 * (nslots - k));
+}
+
+/* Constante em r pelo menor custo no ARM7TDMI: mov/mvn (1 ciclo),
+ * mov+orr ou mvn+bic (2 ciclos) e, só então, literal do pool (ldr: 3
+ * ciclos, 1S+1N+1I, e mais 4 bytes de pool). */
+static void load_imm(int r, int v) {
+    unsigned a, b;
+    if (r == REG_LR)
+        lr_touched = 1;
+    if (arm_imm((unsigned)v))
+        emit("    mov %s, #%d\n", reg_name(r), v);
+    else if (arm_imm(~(unsigned)v))
+        emit("    mvn %s, #%d\n", reg_name(r), ~v);
+    else if (two_chunks((unsigned)v, &a, &b)) {
+        emit("    mov %s, #%u\n", reg_name(r), a);
+        emit("    orr %s, %s, #%u\n", reg_name(r), reg_name(r), b);
+    } else if (two_chunks(~(unsigned)v, &a, &b)) {
+        emit("    mvn %s, #%u\n", reg_name(r), a);
+        emit("    bic %s, %s, #%u\n", reg_name(r), reg_name(r), b);
+    } else {
+        use_literal();
+        emit("    ldr %s, =%d\n", reg_name(r), v);
+    }
+}
+
+/* Rascunho para o segundo operando: ip, a menos que o primeiro já esteja
+ * nele. lr só entra nesse caso, e uma folha que o usa precisa salvá-lo. */
+static int other_scratch(int l) {
+    return l == REG_IP ? REG_LR : REG_IP;
+}
+
+// Soma/subtrai uma constante: imediato direto ou negado; senão via ip/lr
+static void emit_add_imm(int d, int l, int v, int add) {
+    int t = other_scratch(l);
+    if (arm_imm((unsigned)v))
+        emit("    %s %s, %s, #%d\n", add ? "add" : "sub", reg_name(d), reg_name(l), v);
+    else if (arm_imm(-(unsigned)v))
+        emit("    %s %s, %s, #%u\n", add ? "sub" : "add", reg_name(d), reg_name(l), -(unsigned)v);
+    else {
+        load_imm(t, v);
+        emit("    %s %s, %s, %s\n", add ? "add" : "sub", reg_name(d), reg_name(l), reg_name(t));
+    }
+}
+
+static const char *shift_name(IrOp op) {
+    return op == IR_SHL ? "lsl" : op == IR_SAR ? "asr" : "lsr";
+}
+
+// Registrador com o valor do operando (imediatos e derramados vão para 'scratch')
+static int opd_reg(Operand o, int scratch) {
+    if (o.kind == OPD_IMM) {
+        load_imm(scratch, o.v);
+        return scratch;
+    }
+    if (iv[o.v].reg >= 0)
+        return iv[o.v].reg;
+    if (scratch == REG_LR)
+        lr_touched = 1;
+    emit("    ldr %s, [fp, #%d]\n", reg_name(scratch), slot_off(vslot[o.v]));
+    return scratch;
+}
+
+// Registrador onde calcular o vreg v (ip se ele mora no quadro) ...
+static int def_reg(int v) {
+    return iv[v].reg >= 0 ? iv[v].reg : REG_IP;
+}
+
+// ... e, nesse caso, a escrita de volta
+static void def_done(int v, int r) {
+    if (iv[v].reg < 0)
+        emit("    str %s, [fp, #%d]\n", reg_name(r), slot_off(vslot[v]));
+}
+
+/* "rB, rI, lsl #k": base l mais o índice de um LOAD/STORE com
+ * endereçamento por registrador (isel.c) */
+static const char *index_addr(int l, const IrInst *i) {
+    static char buf[48];
+    int x = opd_reg(i->c, other_scratch(l));
+    if (i->shamt)
+        snprintf(buf, sizeof buf, "%s, %s, %s #%d", reg_name(l), reg_name(x),
+                 shift_name(i->shop), i->shamt);
+    else
+        snprintf(buf, sizeof buf, "%s, %s", reg_name(l), reg_name(x));
+    return buf;
+}
+
+// Leva o operando para o registrador r
+static void move_to(int r, Operand o) {
+    if (o.kind == OPD_IMM)
+        load_imm(r, o.v);
+    else if (iv[o.v].reg < 0)
+        emit("    ldr %s, [fp, #%d]\n", reg_name(r), slot_off(vslot[o.v]));
+    else if (iv[o.v].reg != r)
+        emit("    mov %s, %s\n", reg_name(r), reg_name(iv[o.v].reg));
+}
+
+/* Movimentos simultâneos entre registradores (argumentos, parâmetros):
+ * resolve dependências e quebra ciclos usando ip. */
+static void parallel_move(int *src, int *dst, int n) {
+    while (n > 0) {
+        int progress = 0;
+        for (int i = 0; i < n; i++) {
+            int blocked = 0;
+            for (int j = 0; j < n; j++)
+                if (j != i && src[j] == dst[i])
+                    blocked = 1;
+            if (blocked) continue;
+            emit_mov(dst[i], src[i]);
+            src[i] = src[n - 1];
+            dst[i] = dst[n - 1];
+            n--;
+            progress = 1;
+            break;
+        }
+        if (!progress) {        // só ciclos: tira um valor do caminho
+            emit_mov(REG_IP, src[0]);
+            src[0] = REG_IP;
+        }
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/* Operandos no Thumb                                                  */
+/* ------------------------------------------------------------------ */
+
+/* Thumb (ARMv4T): instruções de 16 bits que quase só enxergam r0–r7,
+ * com dois operandos (salvo add/sub), imediatos curtos e nenhuma
+ * predicação. Os vregs ficam em r0–r5 (r4 e r5 preservados); r6 e r7
+ * fazem o papel de ip e lr como rascunhos, e o prólogo os salva quando
+ * o corpo os usa. Não há fp: os slots são endereçados por sp, que anda
+ * quando os argumentos de uma chamada vão para a pilha (push_depth). */
+#define REG_T1 6
+#define REG_T2 7
+
+static const int thumb_regs[] = { 0, 1, 2, 3, 4, 5 };
+#define NUM_THUMB_REGS (int)(sizeof thumb_regs / sizeof thumb_regs[0])
+
+static int t_other(int r) {
+    return r == REG_T1 ? REG_T2 : REG_T1;
+}
+
+/* Constante em r: movs de 8 bits (1 ciclo); 8 bits negados (mvns),
+ * deslocados (lsls) ou até 510 (adds) em 2; senão literal do pool (3
+ * ciclos, 2 bytes mais 4 de pool) */
+static void t_load_imm(int r, int v) {
+    unsigned u = (unsigned)v;
+    const char *n = reg_name(r);
+    int k = 0;
+    while (u && !((u >> k) & 1))
+        k++;
+    if (u <= 255) {
+        emit("    movs %s, #%u\n", n, u);
+    } else if (~u <= 255) {
+        emit("    movs %s, #%u\n", n, ~u);
+        emit("    mvns %s, %s\n", n, n);
+    } else if (u <= 510) {
+        emit("    movs %s, #255\n", n);
+        emit("    adds %s, #%u\n", n, u - 255);
+    } else if ((u >> k) <= 255) {
+        emit("    movs %s, #%u\n", n, u >> k);
+        emit("    lsls %s, %s, #%d\n", n, n, k);
+    } else {
+        use_literal();
+        emit("    ldr %s, =%d\n", n, v);
+    }
+}
+
+// Deslocamento, em relação a sp, do slot nº k (o 0 no topo do quadro)
+static int t_slot_off(int k) {
+    return 4 * k + push_depth;
+}
+
+/* ldr/str r, [sp, #off]; além de 1020 bytes o endereço é montado em
+ * tmp, que numa carga pode ser o próprio r */
+static void t_stack(const char *op, int r, int off, int tmp) {
+    if (off <= 1020) {
+        emit("    %s %s, [sp, #%d]\n", op, reg_name(r), off);
+        return;
+    }
+    t_load_imm(tmp, off);
+    emit("    add %s, sp\n", reg_name(tmp));
+    emit("    %s %s, [%s, #0]\n", op, reg_name(r), reg_name(tmp));
+}
+
+static int t_opd_reg(Operand o, int scratch) {
+    if (o.kind == OPD_IMM) {
+        t_load_imm(scratch, o.v);
+        return scratch;
+    }
+    if (iv[o.v].reg >= 0)
+        return iv[o.v].reg;
+    t_stack("ldr", scratch, t_slot_off(vslot[o.v]), scratch);
+    return scratch;
+}
+
+static int t_def_reg(int v) {
+    return iv[v].reg >= 0 ? iv[v].reg : REG_T1;
+}
+
+static void t_def_done(int v, int r) {
+    if (iv[v].reg < 0)
+        t_stack("str", r, t_slot_off(vslot[v]), t_other(r));
+}
+
+static void t_move_to(int r, Operand o) {
+    if (o.kind == OPD_IMM)
+        t_load_imm(r, o.v);
+    else if (iv[o.v].reg < 0)
+        t_stack("ldr", r, t_slot_off(vslot[o.v]), r);
+    else
+        emit_mov(r, iv[o.v].reg);
+}
+
+/* d = l + v: imediato de 3 bits, ou de 8 com d == l; senão a constante
+ * vai antes para d (ou, se d é l, para um rascunho) */
+static void t_add_imm(int d, int l, int v) {
+    const char *op = v < 0 ? "subs" : "adds";
+    unsigned k = v < 0 ? -(unsigned)v : (unsigned)v;
+    if (k == 0) {
+        emit_mov(d, l);
+    } else if (k <= 7) {
+        emit("    %s %s, %s, #%u\n", op, reg_name(d), reg_name(l), k);
+    } else if (k <= 255) {
+        emit_mov(d, l);
+        emit("    %s %s, #%u\n", op, reg_name(d), k);
+    } else {
+        int t = d != l ? d : t_other(l);
+        t_load_imm(t, v);
+        emit("    adds %s, %s, %s\n", reg_name(d), reg_name(l), reg_name(t));
+    }
 }
 
-static int add_local(const char *name) {
-    int off = stack_size + 4;
-    stack_size += 4;
-    locals[local_count++] = (Local){ name, -off };
-    return -off;
+// sp += v (em múltiplos de 4; além de 508 bytes, via r6)
+static void t_sp_add(int v) {
+    if (v >= -508 && v <= 508)
+        emit("    %s sp, #%d\n", v < 0 ? "sub" : "add", v < 0 ? -v : v);
+    else {
+        t_load_imm(REG_T1, v);
+        emit("    add sp, %s\n", reg_name(REG_T1));
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/* Instruções                                                          */
+/* ------------------------------------------------------------------ */
+
+/* Chamada: argumentos além do 4º vão na pilha (o 5º no topo), os demais
+ * para r0–r3 num movimento paralelo; derramados e imediatos por último,
+ * quando seus destinos já estão livres. */
+static void emit_args(const Operand *args, int n) {
+    for (int i = n - 1; i >= NUM_ARG_REGS; i--)
+        emit("    push {%s}\n", reg_name(opd_reg(args[i], REG_IP)));
+
+    int src[NUM_ARG_REGS], to[NUM_ARG_REGS], m = 0;
+    for (int i = 0; i < n && i < NUM_ARG_REGS; i++)
+        if (args[i].kind == OPD_VREG && iv[args[i].v].reg >= 0) {
+            src[m] = iv[args[i].v].reg;
+            to[m++] = i;
+        }
+    parallel_move(src, to, m);
+    for (int i = 0; i < n && i < NUM_ARG_REGS; i++)
+        if (args[i].kind != OPD_VREG || iv[args[i].v].reg < 0)
+            move_to(i, args[i]);
+}
+
+static void emit_call(const char *sym, const Operand *args, int n, int dst) {
+    emit_args(args, n);
+    emit("    bl %s\n", call_target(sym));
+    if (n > NUM_ARG_REGS)
+        emit("    add sp, sp, #%d\n", 4 * (n - NUM_ARG_REGS));
+    if (dst >= 0) {
+        if (iv[dst].reg > 0)
+            emit("    mov %s, r0\n", reg_name(iv[dst].reg));
+        def_done(dst, 0);
+    }
+}
+
+static void emit_mul(int d, int a, int b) {
+    // ARMv4: Rd não pode coincidir com Rm (primeiro operando)
+    if (d != a)
+        emit("    mul %s, %s, %s\n", reg_name(d), reg_name(a), reg_name(b));
+    else if (d != b)
+        emit("    mul %s, %s, %s\n", reg_name(d), reg_name(b), reg_name(a));
+    else {
+        emit("    mov ip, %s\n", reg_name(a));
+        emit("    mul %s, ip, %s\n", reg_name(d), reg_name(b));
+    }
 }
 
-static void collect_locals(Node *node) {
-    if (!node) return;
-    switch (node->kind) {
-    case ND_BLOCK:
-        for (int i = 0; i < node->stmt_count; i++)
-            collect_locals(node->stmts[i]);
+/* d = a*b + c. Com c num registrador, um mla (Rd != Rm, como no mul);
+ * senão, ou se a, b e d coincidem, mul seguido de add. */
+static void emit_mla(int d, int a, int b, Operand c) {
+    if (c.kind == OPD_VREG && iv[c.v].reg >= 0 && (d != a || d != b)) {
+        if (d == a) {
+            a = b;
+            b = d;
+        }
+        emit("    mla %s, %s, %s, %s\n", reg_name(d), reg_name(a), reg_name(b),
+             reg_name(iv[c.v].reg));
+        return;
+    }
+    emit_mul(d, a, b);
+    if (c.kind == OPD_IMM) {
+        emit_add_imm(d, d, c.v, 1);
+    } else {
+        int t = opd_reg(c, d == REG_IP ? REG_LR : REG_IP);
+        emit("    add %s, %s, %s\n", reg_name(d), reg_name(d), reg_name(t));
+    }
+}
+
+/* d = metade alta de a*b com smull RdLo, RdHi, Rm, Rs. No ARMv4 RdLo,
+ * RdHi e Rm são distintos; Rs pode repetir um deles, então b (sempre
+ * num rascunho) recebe a metade baixa. Sem registrador livre para ela
+ * (a e d ambos em ip), r0 é guardado na pilha. */
+static void emit_mulh(int d, int a, int b) {
+    if (d != a && d != b) {
+        emit("    smull %s, %s, %s, %s\n", reg_name(b), reg_name(d), reg_name(a), reg_name(b));
+        return;
+    }
+    int lo = a != REG_IP ? REG_LR : 0;
+    if (lo == REG_LR)
+        lr_touched = 1;
+    else
+        emit("    str r0, [sp, #-4]!\n");
+    emit("    smull %s, %s, %s, %s\n", reg_name(lo), reg_name(b), reg_name(a), reg_name(b));
+    if (!lo)
+        emit("    ldr r0, [sp], #4\n");
+    emit("    mov %s, %s\n", reg_name(d), reg_name(b));
+}
+
+/* Os PARAMs do início da função: r0–r3 vão para seus vregs num só
+ * movimento paralelo; do 5º em diante estão logo acima do que o
+ * prólogo empilhou (fp e lr, quando salvos, são os últimos). */
+static IrInst *emit_params(IrInst *i) {
+    int src[NUM_ARG_REGS], to[NUM_ARG_REGS], m = 0;
+    IrInst *p;
+    for (p = i; p && p->op == IR_PARAM; p = p->next) {
+        if (p->imm >= NUM_ARG_REGS || !uses[p->dst])
+            continue;
+        if (iv[p->dst].reg < 0) {
+            if (thumb)
+                t_def_done(p->dst, p->imm);
+            else
+                def_done(p->dst, p->imm);
+        } else {
+            src[m] = p->imm;
+            to[m++] = iv[p->dst].reg;
+        }
+    }
+    parallel_move(src, to, m);
+    for (p = i; p && p->op == IR_PARAM; p = p->next) {
+        if (p->imm < NUM_ARG_REGS || !uses[p->dst])
+            continue;
+        int k = 4 * (p->imm - NUM_ARG_REGS);
+        if (thumb) {                // acima dos slots e do que o prólogo empilhou
+            int r = t_def_reg(p->dst);
+            t_stack("ldr", r, 4 * (nslots + npushed) + k, r);
+            t_def_done(p->dst, r);
+            continue;
+        }
+        int r = def_reg(p->dst);
+        if (frame_fp)
+            emit("    ldr %s, [fp, #%d]\n", reg_name(r), 4 + 4 * frame_lr + k);
+        else
+            emit("    ldr %s, [sp, #%d]\n", reg_name(r), 4 * npushed + k);
+        def_done(p->dst, r);
+    }
+    return p;
+}
+
+static void emit_branch(const char *op, const IrBlock *target) {
+    emit("    %s ", op);
+    emit_label(target);
+    emit("\n");
+}
+
+/* Constante à esquerda de uma comparação troca os lados (e a condição
+ * op, que é devolvida) */
+static const char *cmp_sides(IrOp op, Operand *a, Operand *b) {
+    static const char *cc[]      = { [IR_EQ] = "eq", [IR_NE] = "ne", [IR_LT] = "lt", [IR_LE] = "le" };
+    static const char *swapped[] = { [IR_EQ] = "eq", [IR_NE] = "ne", [IR_LT] = "gt", [IR_LE] = "ge" };
+    if (a->kind != OPD_IMM || b->kind == OPD_IMM)
+        return cc[op];
+    Operand t = *a;
+    *a = *b;
+    *b = t;
+    return swapped[op];
+}
+
+/* cmp a, b com o segundo operando imediato quando possível (cmn para o
+ * negado). Devolve a condição. */
+static const char *emit_cmp(IrOp op, Operand a, Operand b) {
+    const char *c = cmp_sides(op, &a, &b);
+    int l = opd_reg(a, REG_IP);
+    if (b.kind == OPD_IMM && arm_imm((unsigned)b.v))
+        emit("    cmp %s, #%d\n", reg_name(l), b.v);
+    else if (b.kind == OPD_IMM && arm_imm(-(unsigned)b.v))
+        emit("    cmn %s, #%u\n", reg_name(l), -(unsigned)b.v);
+    else
+        emit("    cmp %s, %s\n", reg_name(l), reg_name(opd_reg(b, other_scratch(l))));
+    return c;
+}
+
+static const char *invert_cc(const char *c) {
+    static const char *pairs[][2] = {
+        { "eq", "ne" }, { "lt", "ge" }, { "le", "gt" },
+    };
+    for (int k = 0; k < 3; k++) {
+        if (!strcmp(c, pairs[k][0])) return pairs[k][1];
+        if (!strcmp(c, pairs[k][1])) return pairs[k][0];
+    }
+    return c;
+}
+
+static void emit_branch_cc(const char *c, const IrBlock *target) {
+    emit("    b%s ", c);
+    emit_label(target);
+    emit("\n");
+}
+
+/* Desfaz o quadro do prólogo. Com 'ret', volta ao chamador (ldmfd com
+ * pc ou mov pc, lr; bx lr se ele pode estar em Thumb); sem, só
+ * restaura os registradores, lr inclusive. */
+static void emit_frame_pop(int ret) {
+    if (frame_fp) {
+        if (saved_size)
+            emit("    sub sp, fp, #%d\n", saved_size);
+        else
+            emit("    mov sp, fp\n");
+    }
+    unsigned mask = frame_mask;
+    if (ret && frame_lr && !iw_ret)
+        mask = (mask & ~(1u << REG_LR)) | (1u << 15);
+    if (mask) {
+        emit("    ldmfd sp!, ");
+        emit_reglist(mask);
+        emit("\n");
+    }
+    if (ret && iw_ret)
+        emit("    bx lr\n");
+    else if (ret && !frame_lr)
+        emit("    mov pc, lr\n");
+}
+
+/* Saída da função sob a condição c: sem nada empilhado, volta direto
+ * por lr; senão desvia para o epílogo comum. */
+static void emit_return(const char *c) {
+    if (!npushed)
+        emit(iw_ret ? "    bx%s lr\n" : "    mov%s pc, lr\n", c);
+    else
+        emit("    b%s .Lep_%s\n", c, fn->name);
+}
+
+static void emit_inst(IrInst *i, IrBlock *b) {
+    int d, l, r;
+    switch (i->op) {
+    case IR_PARAM:
         break;
-    case ND_DECL:
-        add_local(node->name);
-        if (node->init)
-            collect_locals(node->init);
+    case IR_MOV:
+        if (iv[i->dst].reg >= 0) {
+            move_to(iv[i->dst].reg, i->a);
+        } else {
+            l = opd_reg(i->a, REG_IP);
+            def_done(i->dst, l);
+        }
         break;
-    case ND_FOR:
-        if (node->init) collect_locals(node->init);
-        if (node->cond) collect_locals(node->cond);
-        if (node->inc)  collect_locals(node->inc);
-        if (node->rhs)  collect_locals(node->rhs);
+    case IR_ADD:
+    case IR_SUB:
+    case IR_RSB:
+        if (i->shamt) {             // operando deslocado (isel.c)
+            l = opd_reg(i->a, REG_IP);
+            r = opd_reg(i->b, other_scratch(l));
+            d = def_reg(i->dst);
+            emit("    %s %s, %s, %s, %s #%d\n",
+                 i->op == IR_ADD ? "add" : i->op == IR_SUB ? "sub" : "rsb",
+                 reg_name(d), reg_name(l), reg_name(r), shift_name(i->shop), i->shamt);
+        } else if (i->b.kind == OPD_IMM) {
+            l = opd_reg(i->a, REG_IP);
+            d = def_reg(i->dst);
+            emit_add_imm(d, l, i->b.v, i->op == IR_ADD);
+        } else if (i->op == IR_SUB && i->a.kind == OPD_IMM && arm_imm((unsigned)i->a.v)) {
+            r = opd_reg(i->b, REG_IP);
+            d = def_reg(i->dst);
+            emit("    rsb %s, %s, #%d\n", reg_name(d), reg_name(r), i->a.v);
+        } else {
+            l = opd_reg(i->a, REG_IP);
+            r = opd_reg(i->b, other_scratch(l));
+            d = def_reg(i->dst);
+            emit("    %s %s, %s, %s\n", i->op == IR_ADD ? "add" : "sub",
+                 reg_name(d), reg_name(l), reg_name(r));
+        }
+        def_done(i->dst, d);
         break;
-    case ND_IF:
-        if (node->lhs) collect_locals(node->lhs);
-        if (node->rhs) collect_locals(node->rhs);
-        if (node->els) collect_locals(node->els);
+    case IR_MUL:
+        l = opd_reg(i->a, REG_IP);
+        r = opd_reg(i->b, other_scratch(l));
+        d = def_reg(i->dst);
+        emit_mul(d, l, r);
+        def_done(i->dst, d);
         break;
-    case ND_WHILE:
-        if (node->lhs) collect_locals(node->lhs);
-        if (node->rhs) collect_locals(node->rhs);
+    case IR_MLA:
+        l = opd_reg(i->a, REG_IP);
+        r = opd_reg(i->b, other_scratch(l));
+        d = def_reg(i->dst);
+        emit_mla(d, l, r, i->c);
+        def_done(i->dst, d);
         break;
-    default:
-        if (node->lhs) collect_locals(node->lhs);
-        if (node->rhs) collect_locals(node->rhs);
+    case IR_SHL:
+    case IR_SAR:
+    case IR_SHR: {
+        const char *sh = shift_name(i->op);
+        l = opd_reg(i->a, REG_IP);
+        d = def_reg(i->dst);
+        if (i->b.kind == OPD_IMM)
+            emit("    mov %s, %s, %s #%d\n", reg_name(d), reg_name(l), sh, i->b.v);
+        else
+            emit("    mov %s, %s, %s %s\n", reg_name(d), reg_name(l), sh,
+                 reg_name(opd_reg(i->b, other_scratch(l))));
+        def_done(i->dst, d);
+        break;
+    }
+    case IR_DIV: {
+        Operand args[2] = { i->a, i->b };
+        emit_call(INTERNED("__aeabi_idiv"), args, 2, i->dst);
+        break;
+    }
+    case IR_MOD: {
+        // __aeabi_idivmod devolve o quociente em r0 e o resto em r1
+        Operand args[2] = { i->a, i->b };
+        emit_call(INTERNED("__aeabi_idivmod"), args, 2, -1);
+        if (iv[i->dst].reg >= 0 && iv[i->dst].reg != 1)
+            emit("    mov %s, r1\n", reg_name(iv[i->dst].reg));
+        def_done(i->dst, 1);
+        break;
+    }
+    case IR_MULH:
+        l = opd_reg(i->a, REG_IP);
+        r = other_scratch(l);
+        move_to(r, i->b);
+        if (r == REG_LR)
+            lr_touched = 1;
+        d = def_reg(i->dst);
+        emit_mulh(d, l, r);
+        def_done(i->dst, d);
+        break;
+    case IR_EQ:
+    case IR_NE:
+    case IR_LT:
+    case IR_LE: {
+        const char *c = emit_cmp(i->op, i->a, i->b);
+        d = def_reg(i->dst);
+        emit("    mov %s, #0\n", reg_name(d));
+        emit("    mov%s %s, #1\n", c, reg_name(d));
+        def_done(i->dst, d);
+        break;
+    }
+    case IR_ADDR_LOCAL:
+        d = def_reg(i->dst);
+        emit_add_imm(d, REG_FP, -slot_off(i->imm), 0);
+        def_done(i->dst, d);
+        break;
+    case IR_ADDR_GLOBAL:
+        d = def_reg(i->dst);
+        use_literal();
+        emit("    ldr %s, =%s\n", reg_name(d), i->sym);
+        def_done(i->dst, d);
+        break;
+    case IR_LOAD:
+        l = opd_reg(i->a, REG_IP);
+        d = def_reg(i->dst);
+        if (i->c.kind != OPD_NONE)
+            emit("    ldr %s, [%s]\n", reg_name(d), index_addr(l, i));
+        else
+            emit("    ldr %s, [%s, #%d]\n", reg_name(d), reg_name(l), i->imm);
+        def_done(i->dst, d);
+        break;
+    case IR_STORE:
+        l = opd_reg(i->a, REG_IP);
+        if (i->c.kind != OPD_NONE) {
+            const char *x = index_addr(l, i);
+            if (i->b.kind == OPD_VREG && iv[i->b.v].reg >= 0) {
+                emit("    str %s, [%s]\n", reg_name(iv[i->b.v].reg), x);
+                break;
+            }
+            /* sem rascunho para o valor: o endereço vai antes para ip */
+            emit("    add ip, %s\n", x);
+            l = REG_IP;
+        }
+        r = opd_reg(i->b, other_scratch(l));
+        emit("    str %s, [%s, #%d]\n", reg_name(r), reg_name(l), i->c.kind != OPD_NONE ? 0 : i->imm);
         break;
+    case IR_LOAD_LOCAL:
+        d = def_reg(i->dst);
+        emit("    ldr %s, [fp, #%d]\n", reg_name(d), slot_off(i->imm));
+        def_done(i->dst, d);
+        break;
+    case IR_STORE_LOCAL:
+        r = opd_reg(i->b, REG_IP);
+        emit("    str %s, [fp, #%d]\n", reg_name(r), slot_off(i->imm));
+        break;
+    case IR_CALL:
+        emit_call(i->sym, i->args, i->nargs, i->dst);
+        break;
+    case IR_JMP:
+        if (i->target != b->next) {
+            emit_branch("b", i->target);
+            after_branch = 1;
+        }
+        break;
+    case IR_BR: {
+        /* desvia pelas flags do cmp; se o alvo verdadeiro é o próximo
+         * bloco, inverte a condição e desvia para o falso */
+        const char *c = emit_cmp(i->cc, i->a, i->b);
+        if (i->target == b->next) {
+            emit_branch_cc(invert_cc(c), i->target2);
+        } else {
+            emit_branch_cc(c, i->target);
+            if (i->target2 != b->next) {
+                emit_branch("b", i->target2);
+                after_branch = 1;
+            }
+        }
+        break;
+    }
+    case IR_TAILCALL:
+        /* argumentos no lugar, quadro desfeito (lr volta a ter o retorno
+         * do nosso chamador) e salto: quem é chamado volta direto para lá */
+        emit_args(i->args, i->nargs);
+        emit_frame_pop(0);
+        emit("    b %s\n", call_target(i->sym));
+        after_branch = 1;
+        break;
+    case IR_RET:
+        if (i->a.kind != OPD_NONE)
+            move_to(0, i->a);
+        if (b->next) {
+            emit_return("");
+            after_branch = 1;
+        }
+        break;
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/* Acessos múltiplos                                                   */
+/* ------------------------------------------------------------------ */
+
+/* Registrador da base, deslocamento e registrador do valor de um acesso
+ * simples à memória com tudo em registradores; 0 se não é um. Slots vão
+ * por sp, que aponta para o slot 0 fora das chamadas (só elas empilham). */
+static int multi_access(const IrInst *i, int *base, int *off, int *r) {
+    Operand v = i->b;
+    switch (i->op) {
+    case IR_LOAD: case IR_STORE:
+        if (i->a.kind != OPD_VREG || iv[i->a.v].reg < 0 || i->c.kind != OPD_NONE)
+            return 0;
+        *base = iv[i->a.v].reg;
+        *off  = i->imm;
+        break;
+    case IR_LOAD_LOCAL: case IR_STORE_LOCAL:
+        *base = REG_SP;
+        *off  = 4 * i->imm;
+        break;
+    default:
+        return 0;
+    }
+    if (i->op == IR_LOAD || i->op == IR_LOAD_LOCAL)
+        v = opd_vreg(i->dst);
+    if (v.kind != OPD_VREG || iv[v.v].reg < 0)
+        return 0;
+    *r = iv[v.v].reg;
+    return 1;
+}
+
+/* Cargas (escritas) seguidas em palavras consecutivas, a partir de i,
+ * viram um ldm (stm). O registrador de menor número fica com o menor
+ * endereço, então eles têm de crescer junto com o endereço. O modo sai
+ * do menor deslocamento (0: ia, 4: ib; ou o maior: 0: da, -4: db); fora
+ * desses o endereço vai antes para ip, o que só compensa a partir de
+ * três acessos. A base só pode estar na lista de um ldm como destino da
+ * última carga (nas anteriores, mudaria o endereço das seguintes).
+ * Devolve a última instrução consumida, ou NULL. */
+static IrInst *emit_multiple(IrInst *i) {
+    int load = i->op == IR_LOAD || i->op == IR_LOAD_LOCAL;
+    int base = 0, first = 0, off = 0, step = 0, r, last_r = -1, n = 0;
+    unsigned mask = 0;
+    IrInst *last = NULL;
+    for (IrInst *x = i; x && x->op == i->op; x = x->next) {
+        int xb, xo;
+        if (!multi_access(x, &xb, &xo, &r) || (mask & (1u << r)))
+            break;
+        if (n == 0) {
+            base  = xb;
+            first = xo;
+        } else {
+            if (xb != base || (xo - off != 4 && xo - off != -4) ||
+                (step && xo - off != step) || (xo > off) != (r > last_r))
+                break;
+            step = xo - off;
+        }
+        mask  |= 1u << r;
+        last_r = r;
+        off    = xo;
+        last   = x;
+        n++;
+        if (load && r == base)
+            break;
+    }
+    if (n < 2)
+        return NULL;
+    int lo = step > 0 ? first : off, hi = lo + 4 * (n - 1);
+    const char *mode = lo == 0 ? "ia" : lo == 4 ? "ib" : hi == 0 ? "da" : hi == -4 ? "db" : NULL;
+    if (!mode) {
+        if (n < 3)
+            return NULL;
+        emit_add_imm(REG_IP, base, lo, 1);
+        base = REG_IP;
+        mode = "ia";
+    }
+    emit("    %s%s %s, ", load ? "ldm" : "stm", mode, reg_name(base));
+    emit_reglist(mask);
+    emit("\n");
+    return last;
+}
+
+/* ------------------------------------------------------------------ */
+/* If-conversion                                                       */
+/* ------------------------------------------------------------------ */
+
+/* Um if/else curto vira instruções predicadas em vez de desvios. No
+ * ARM7TDMI um desvio tomado custa 3 ciclos (2S+1N) e uma instrução
+ * cuja condição falha custa 1: compensa enquanto as instruções dos
+ * braços não passam da média dos dois caminhos com desvios. */
+#define IFCVT_MAX 4                 // instruções por braço
+
+/* Braço predicável: só alcançado pelo desvio e sem nada que altere as
+ * flags (comparações, chamadas, divisão). Devolve o custo ou -1. */
+static int arm_cost(const IrBlock *arm) {
+    int n = 0;
+    if (arm->npred != 1)
+        return -1;
+    for (IrInst *i = arm->first; i; i = i->next) {
+        switch (i->op) {
+        case IR_MOV: case IR_ADD: case IR_SUB: case IR_RSB: case IR_MUL: case IR_MLA:
+        case IR_SHL: case IR_SAR: case IR_SHR:
+        case IR_ADDR_LOCAL: case IR_ADDR_GLOBAL:
+        case IR_LOAD: case IR_STORE: case IR_LOAD_LOCAL: case IR_STORE_LOCAL:
+            n++;
+            break;
+        case IR_RET:
+            n += i->a.kind != OPD_NONE;
+            break;
+        case IR_JMP:
+            break;
+        default:
+            return -1;
+        }
+    }
+    return n <= IFCVT_MAX ? n : -1;
+}
+
+// Corpo do braço sob a condição c; devolve o terminador, ainda não emitido
+static IrInst *emit_arm(IrBlock *arm, const char *c) {
+    IrInst *i;
+    pred = c;
+    for (i = arm->first; !ir_is_terminator(i->op); i = i->next)
+        emit_inst(i, arm);
+    if (i->op == IR_RET && i->a.kind != OPD_NONE)
+        move_to(0, i->a);
+    pred = "";
+    return i;
+}
+
+/* Tenta converter o BR i (fim do bloco b). Formas aceitas, com o braço
+ * 'então' logo depois de b no layout:
+ *   triângulo  b: br c, T, F   T: ...; jmp/ret       F = T->next
+ *   losango    idem, F também predicável e os dois terminando no mesmo
+ *              jmp ou ambos em ret
+ * Devolve o último bloco consumido, ou NULL se não compensa. */
+static IrBlock *if_convert(IrInst *i, IrBlock *b) {
+    IrBlock *t = i->target, *f = i->target2;
+    int swap = 0;
+    if (t != b->next) {
+        if (f != b->next)
+            return NULL;
+        t = i->target2;
+        f = i->target;
+        swap = 1;
+    }
+    if (t->next != f)
+        return NULL;
+    int nt = arm_cost(t), nf = arm_cost(f);
+    if (nt < 0)
+        return NULL;
+    IrInst *tt = t->last, *ft = f->last;
+    int diamond = nf >= 0 && tt->op == ft->op &&
+                  (tt->op == IR_RET || tt->target == ft->target);
+    /* com desvios: caminho do 'então' = bxx não tomado + T (+ b J no
+     * losango); caminho do 'senão' = bxx tomado + F */
+    int taken = 1 + nt + (diamond ? 3 : 0);
+    int fall  = 3 + (diamond ? nf : 0);
+    if (2 * (nt + (diamond ? nf : 0)) > taken + fall)
+        return NULL;
+
+    const char *c = emit_cmp(i->cc, i->a, i->b);
+    if (swap)
+        c = invert_cc(c);
+    emit_arm(t, c);
+    if (!diamond) {
+        // o 'então' sai do triângulo sob a mesma condição
+        if (tt->op == IR_RET)
+            emit_return(c);
+        else if (tt->target != f)
+            emit_branch_cc(c, tt->target);
+        flush_pool(0);
+        return t;
     }
+    emit_arm(f, invert_cc(c));
+    if (ft->op == IR_JMP)           // saída comum, incondicional
+        emit_inst(ft, f);
+    else if (f->next) {
+        emit_return("");
+        after_branch = 1;
+    }
+    flush_pool(0);
+    return f;
 }
 
-static void gen_addr(Node *node);
-static void gen_expr(Node *node);
-static void gen_stmt(Node *node, const char *ret_label);
+/* Prólogo, blocos e epílogo. O quadro só tem o que a função usa:
+ *   stmfd sp!, {r4-r10 usados, fp?, lr?}
+ *   add fp, sp, #saved_size        (fp aponta para o fp salvo)
+ *   sub sp, sp, #4*nslots
+ * e uma folha sem slots nem r4–r10 não empilha nada. */
+static void gen_body(IrFunc *f, unsigned saved) {
+    unsigned mask = saved | (frame_fp ? 1u << REG_FP : 0) | (frame_lr ? 1u << REG_LR : 0);
+    frame_mask = mask;
+    npushed = 0;
+    for (int r = 0; r < 16; r++)
+        if (mask & (1u << r))
+            npushed++;
 
-static void gen_addr(Node *node) {
-    switch (node->kind) {
-    case ND_VAR: {
-        int off = lookup_local(node->name);
-        if (off) {
-            fprintf(out, "    add r0, fp, #%d\n", off);
+    emit(".global %s\n", f->name);
+    emit("%s:\n", f->name);
+    if (mask) {
+        emit("    stmfd sp!, ");
+        emit_reglist(mask);
+        emit("\n");
+    }
+    if (frame_fp) {
+        if (saved_size)
+            emit("    add fp, sp, #%d\n", saved_size);
+        else
+            emit("    mov fp, sp\n");
+        emit_add_imm(REG_SP, REG_SP, 4 * nslots, 0);
+    }
+
+    for (IrBlock *b = f->entry; b; b = b->next) {
+        IrInst *i = b->first;
+        if (b == f->entry) {
+            i = emit_params(i);
         } else {
-            fprintf(out, "    ldr r0, =%s\n", node->name);
+            emit_label(b);
+            emit(":\n");
+        }
+        for (; i; i = i->next) {
+            IrBlock *last;
+            if (i->op == IR_BR && (last = if_convert(i, b))) {
+                b = last;
+                break;
+            }
+            IrInst *m = emit_multiple(i);
+            if (m)
+                i = m;
+            else
+                emit_inst(i, b);
+            flush_pool(0);
         }
+    }
+
+    /* ----- epílogo comum ---------------------------------- */
+    emit(".Lep_%s:\n", f->name);
+    emit_frame_pop(1);
+    flush_pool(1);
+}
+
+/* ------------------------------------------------------------------ */
+/* Instruções no Thumb                                                 */
+/* ------------------------------------------------------------------ */
+
+static void t_emit_args(const Operand *args, int n) {
+    for (int i = n - 1; i >= NUM_ARG_REGS; i--) {
+        emit("    push {%s}\n", reg_name(t_opd_reg(args[i], REG_T1)));
+        push_depth += 4;
+    }
+    int src[NUM_ARG_REGS], to[NUM_ARG_REGS], m = 0;
+    for (int i = 0; i < n && i < NUM_ARG_REGS; i++)
+        if (args[i].kind == OPD_VREG && iv[args[i].v].reg >= 0) {
+            src[m] = iv[args[i].v].reg;
+            to[m++] = i;
+        }
+    parallel_move(src, to, m);
+    for (int i = 0; i < n && i < NUM_ARG_REGS; i++)
+        if (args[i].kind != OPD_VREG || iv[args[i].v].reg < 0)
+            t_move_to(i, args[i]);
+}
+
+static void t_emit_call(const char *sym, const Operand *args, int n, int dst) {
+    t_emit_args(args, n);
+    emit("    bl %s\n", call_target(sym));
+    if (push_depth) {
+        t_sp_add(push_depth);
+        push_depth = 0;
+    }
+    if (dst >= 0) {
+        if (iv[dst].reg > 0)
+            emit_mov(iv[dst].reg, 0);
+        t_def_done(dst, 0);
+    }
+}
+
+/* cmp do Thumb: imediato só de 0 a 255, o resto num registrador.
+ * Devolve a condição. */
+static const char *t_emit_cmp(IrOp op, Operand a, Operand b) {
+    const char *c = cmp_sides(op, &a, &b);
+    int l = t_opd_reg(a, REG_T1);
+    if (b.kind == OPD_IMM && b.v >= 0 && b.v <= 255)
+        emit("    cmp %s, #%d\n", reg_name(l), b.v);
+    else
+        emit("    cmp %s, %s\n", reg_name(l), reg_name(t_opd_reg(b, t_other(l))));
+    return c;
+}
+
+/* Comparação como valor, sem predicação: o 1 vai antes do cmp (movs
+ * muda as flags) para um registrador fora dos operandos, e um desvio
+ * pula o 0. Se os dois rascunhos guardam os operandos e o destino mora
+ * no quadro, os dois valores ficam depois do desvio. */
+static void t_emit_setcc(IrInst *i) {
+    Operand a = i->a, b = i->b;
+    const char *c = cmp_sides(i->op, &a, &b);
+    int l = t_opd_reg(a, REG_T1), r = -1;
+    if (b.kind != OPD_IMM || b.v < 0 || b.v > 255)
+        r = t_opd_reg(b, t_other(l));
+    int d = t_def_reg(i->dst), t = d;
+    if (t == l || t == r)
+        t = l != REG_T1 && r != REG_T1 ? REG_T1 : l != REG_T2 && r != REG_T2 ? REG_T2 : -1;
+    int one = local_id++;
+    if (t >= 0)
+        emit("    movs %s, #1\n", reg_name(t));
+    if (r < 0)
+        emit("    cmp %s, #%d\n", reg_name(l), b.v);
+    else
+        emit("    cmp %s, %s\n", reg_name(l), reg_name(r));
+    emit("    b%s .Lt%d\n", c, one);
+    if (t >= 0) {
+        emit("    movs %s, #0\n", reg_name(t));
+        emit(".Lt%d:\n", one);
+    } else {
+        int done = local_id++;
+        t = d;
+        emit("    movs %s, #0\n", reg_name(t));
+        emit("    b .Lt%d\n", done);
+        emit(".Lt%d:\n", one);
+        emit("    movs %s, #1\n", reg_name(t));
+        emit(".Lt%d:\n", done);
+    }
+    if (iv[i->dst].reg >= 0)
+        emit_mov(d, t);
+    t_def_done(i->dst, t);
+}
+
+/* d = l * r com o muls do Thumb (Rd = Rm * Rd), que no ARMv4T não
+ * aceita Rd == Rm */
+static void t_emit_mul(int d, int l, int r) {
+    if (d == r && d != l) {
+        emit("    muls %s, %s, %s\n", reg_name(d), reg_name(l), reg_name(d));
+    } else if (d == l && d != r) {
+        emit("    muls %s, %s, %s\n", reg_name(d), reg_name(r), reg_name(d));
+    } else if (d != l) {
+        emit_mov(d, r);
+        emit("    muls %s, %s, %s\n", reg_name(d), reg_name(l), reg_name(d));
+    } else {                        // x * x: uma cópia no rascunho
+        int t = t_other(d);
+        emit_mov(t, l);
+        emit("    muls %s, %s, %s\n", reg_name(d), reg_name(t), reg_name(d));
+    }
+}
+
+// Saída do meio da função: bx lr se nada foi empilhado, senão o epílogo
+static void t_emit_return(void) {
+    if (!npushed && !nslots)
+        emit("    bx lr\n");
+    else
+        emit("    b .Lep_%s\n", fn->name);
+}
+
+static void t_emit_inst(IrInst *i, IrBlock *b) {
+    int d, l, r, t;
+    switch (i->op) {
+    case IR_PARAM:
+        break;
+    case IR_MOV:
+        if (iv[i->dst].reg >= 0) {
+            t_move_to(iv[i->dst].reg, i->a);
+        } else {
+            l = t_opd_reg(i->a, REG_T1);
+            t_def_done(i->dst, l);
+        }
+        break;
+    case IR_ADD:
+    case IR_SUB:
+        if (i->b.kind == OPD_IMM) {
+            l = t_opd_reg(i->a, REG_T1);
+            d = t_def_reg(i->dst);
+            t_add_imm(d, l, i->op == IR_ADD ? i->b.v : (int)-(unsigned)i->b.v);
+        } else if (i->op == IR_SUB && i->a.kind == OPD_IMM && i->a.v == 0) {
+            r = t_opd_reg(i->b, REG_T1);
+            d = t_def_reg(i->dst);
+            emit("    rsbs %s, %s, #0\n", reg_name(d), reg_name(r));
+        } else {
+            l = t_opd_reg(i->a, REG_T1);
+            r = t_opd_reg(i->b, t_other(l));
+            d = t_def_reg(i->dst);
+            emit("    %s %s, %s, %s\n", i->op == IR_ADD ? "adds" : "subs",
+                 reg_name(d), reg_name(l), reg_name(r));
+        }
+        t_def_done(i->dst, d);
+        break;
+    case IR_MUL:
+        l = t_opd_reg(i->a, REG_T1);
+        r = t_opd_reg(i->b, t_other(l));
+        d = t_def_reg(i->dst);
+        t_emit_mul(d, l, r);
+        t_def_done(i->dst, d);
+        break;
+    case IR_SHL:
+    case IR_SAR:
+    case IR_SHR: {
+        const char *sh = i->op == IR_SHL ? "lsls" : i->op == IR_SAR ? "asrs" : "lsrs";
+        l = t_opd_reg(i->a, REG_T1);
+        d = t_def_reg(i->dst);
+        if (i->b.kind == OPD_IMM) {
+            if (i->b.v)
+                emit("    %s %s, %s, #%d\n", sh, reg_name(d), reg_name(l), i->b.v);
+            else
+                emit_mov(d, l);
+        } else {
+            /* só a forma de dois operandos: o valor tem de estar em d,
+             * e a quantidade fora dele */
+            r = t_opd_reg(i->b, t_other(l));
+            t = d != r ? d : r != REG_T1 && l != REG_T1 ? REG_T1 : REG_T2;
+            emit_mov(t, l);
+            emit("    %s %s, %s\n", sh, reg_name(t), reg_name(r));
+            emit_mov(d, t);
+        }
+        t_def_done(i->dst, d);
         break;
     }
-    case ND_DEREF:
-        gen_expr(node->lhs);
+    case IR_DIV: {
+        Operand args[2] = { i->a, i->b };
+        t_emit_call(INTERNED("__aeabi_idiv"), args, 2, i->dst);
         break;
-    case ND_ADDR:
-        gen_addr(node->lhs);
+    }
+    case IR_MOD: {
+        Operand args[2] = { i->a, i->b };
+        t_emit_call(INTERNED("__aeabi_idivmod"), args, 2, -1);
+        if (iv[i->dst].reg >= 0)
+            emit_mov(iv[i->dst].reg, 1);
+        t_def_done(i->dst, 1);
         break;
-    default:
+    }
+    case IR_MULH: {
+        // o Thumb não tem smull: a metade alta vem do runtime (divide.s)
+        Operand args[2] = { i->a, i->b };
+        t_emit_call(INTERNED("__smulh"), args, 2, i->dst);
         break;
     }
-}
-
-static void gen_expr(Node *node) {
-    switch (node->kind) {
-    case ND_NUM:
-        fprintf(out, "    mov r0, #%d\n", node->val);
-        break;
-    case ND_VAR:
-        gen_addr(node);
-        fprintf(out, "    ldr r0, [r0]\n");
-        break;
-    case ND_ADDR:
-        gen_addr(node->lhs);
-        break;
-    case ND_DEREF:
-        gen_expr(node->lhs);
-        fprintf(out, "    ldr r0, [r0]\n");
-        break;
-    case ND_ASSIGN:
-        gen_addr(node->lhs);
-        fprintf(out, "    push {r0}\n");
-        gen_expr(node->rhs);
-        fprintf(out, "    pop {r1}\n");
-        fprintf(out, "    str r0, [r1]\n");
-        break;
-    case ND_ADD:
-        gen_expr(node->lhs);
-        fprintf(out, "    push {r0}\n");
-        gen_expr(node->rhs);
-        fprintf(out, "    pop {r1}\n");
-        fprintf(out, "    add r0, r1, r0\n");
-        break;
-    case ND_SUB:
-        gen_expr(node->lhs);
-        fprintf(out, "    push {r0}\n");
-        gen_expr(node->rhs);
-        fprintf(out, "    pop {r1}\n");
-        fprintf(out, "    sub r0, r1, r0\n");
-        break;
-    case ND_MUL:
-        gen_expr(node->lhs);
-        fprintf(out, "    push {r0}\n");
-        gen_expr(node->rhs);
-        fprintf(out, "    pop {r1}\n");
-        fprintf(out, "    mul r0, r1, r0\n");
-        break;
-    case ND_DIV:
-        gen_expr(node->lhs);
-        fprintf(out, "    push {r0}\n");
-        gen_expr(node->rhs);
-        fprintf(out, "    pop {r1}\n");
-        fprintf(out, "    mov r2, r0\n");
-        fprintf(out, "    mov r0, r1\n");
-        fprintf(out, "    mov r1, r2\n");
-        fprintf(out, "    bl __aeabi_idiv\n");
-        break;
-    case ND_EQ:
-    case ND_NE:
-    case ND_LT:
-    case ND_LE: {
-        gen_expr(node->lhs);
-        fprintf(out, "    push {r0}\n");
-        gen_expr(node->rhs);
-        fprintf(out, "    pop {r1}\n");
-        fprintf(out, "    cmp r1, r0\n");
-        const char *cc = (node->kind==ND_EQ)?"eq":(node->kind==ND_NE)?"ne":(node->kind==ND_LT)?"lt":"le";
-        fprintf(out, "    mov r0, #0\n");
-        fprintf(out, "    mov%s r0, #1\n", cc);
-        break;
-    }
-    case ND_CALL:
-        /* NEW – avalia direita→esquerda; r0 já serve para o arg0*/
-        for (int i = node->arg_count - 1; i >= 0 && i < 4; i--) {
-            gen_expr(node->args[i]);              /* resultado em r0*/
-            if (i != 0)                           /* evita mov r0,r0*/
-                fprintf(out, "    mov r%d, r0\n", i);
-        }
-         fprintf(out, "    bl %s\n", node->name);
-         break;
-    case ND_POSTINC:
-        gen_addr(node->lhs);
-        fprintf(out, "    push {r0}\n");
-        fprintf(out, "    ldr r0, [r0]\n");
-        fprintf(out, "    mov r1, r0\n");
-        fprintf(out, "    add r0, r0, #1\n");
-        fprintf(out, "    pop {r2}\n");
-        fprintf(out, "    str r0, [r2]\n");
-        fprintf(out, "    mov r0, r1\n");
-        break;
-    case ND_POSTDEC:
-        gen_addr(node->lhs);
-        fprintf(out, "    push {r0}\n");
-        fprintf(out, "    ldr r0, [r0]\n");
-        fprintf(out, "    mov r1, r0\n");
-        fprintf(out, "    sub r0, r0, #1\n");
-        fprintf(out, "    pop {r2}\n");
-        fprintf(out, "    str r0, [r2]\n");
-        fprintf(out, "    mov r0, r1\n");
+    case IR_EQ:
+    case IR_NE:
+    case IR_LT:
+    case IR_LE:
+        t_emit_setcc(i);
         break;
-    default:
+    case IR_ADDR_LOCAL:
+        d = t_def_reg(i->dst);
+        if (t_slot_off(i->imm) <= 1020) {
+            emit("    add %s, sp, #%d\n", reg_name(d), t_slot_off(i->imm));
+        } else {
+            t_load_imm(d, t_slot_off(i->imm));
+            emit("    add %s, sp\n", reg_name(d));
+        }
+        t_def_done(i->dst, d);
+        break;
+    case IR_ADDR_GLOBAL:
+        d = t_def_reg(i->dst);
+        use_literal();
+        emit("    ldr %s, =%s\n", reg_name(d), i->sym);
+        t_def_done(i->dst, d);
+        break;
+    case IR_LOAD:
+    case IR_STORE: {
+        /* [rB, rI] ou [rB, #k], k de 0 a 124 em múltiplos de 4; outro
+         * deslocamento (do desenrolamento de laços) vai antes para a base */
+        int k = i->imm;
+        l = t_opd_reg(i->a, REG_T1);
+        if (i->c.kind == OPD_NONE && (k < 0 || k > 124 || k % 4)) {
+            t_add_imm(REG_T1, l, k);
+            l = REG_T1;
+            k = 0;
+        }
+        if (i->op == IR_LOAD) {
+            d = t_def_reg(i->dst);
+            if (i->c.kind != OPD_NONE)
+                emit("    ldr %s, [%s, %s]\n", reg_name(d), reg_name(l),
+                     reg_name(t_opd_reg(i->c, t_other(l))));
+            else
+                emit("    ldr %s, [%s, #%d]\n", reg_name(d), reg_name(l), k);
+            t_def_done(i->dst, d);
+            break;
+        }
+        if (i->c.kind != OPD_NONE) {
+            int x = t_opd_reg(i->c, t_other(l));
+            if (i->b.kind == OPD_VREG && iv[i->b.v].reg >= 0) {
+                emit("    str %s, [%s, %s]\n", reg_name(iv[i->b.v].reg), reg_name(l), reg_name(x));
+                break;
+            }
+            // sem rascunho para o valor: o endereço vai antes para r6
+            emit("    adds %s, %s, %s\n", reg_name(REG_T1), reg_name(l), reg_name(x));
+            l = REG_T1;
+        }
+        r = t_opd_reg(i->b, t_other(l));
+        emit("    str %s, [%s, #%d]\n", reg_name(r), reg_name(l), k);
+        break;
+    }
+    case IR_LOAD_LOCAL:
+        d = t_def_reg(i->dst);
+        t_stack("ldr", d, t_slot_off(i->imm), d);
+        t_def_done(i->dst, d);
+        break;
+    case IR_STORE_LOCAL:
+        r = t_opd_reg(i->b, REG_T1);
+        t_stack("str", r, t_slot_off(i->imm), t_other(r));
+        break;
+    case IR_CALL:
+        t_emit_call(i->sym, i->args, i->nargs, i->dst);
+        break;
+    case IR_JMP:
+        if (i->target != b->next) {
+            emit_branch("b", i->target);
+            after_branch = 1;
+        }
+        break;
+    case IR_BR: {
+        const char *c = t_emit_cmp(i->cc, i->a, i->b);
+        if (i->target == b->next) {
+            emit_branch_cc(invert_cc(c), i->target2);
+        } else {
+            emit_branch_cc(c, i->target);
+            if (i->target2 != b->next) {
+                emit_branch("b", i->target2);
+                after_branch = 1;
+            }
+        }
+        break;
+    }
+    case IR_TAILCALL:
+        /* sem o ldmfd que restaura lr, uma chamada comum: o resultado
+         * já está em r0 */
+        t_emit_call(i->sym, i->args, i->nargs, -1);
+        if (b->next) {
+            t_emit_return();
+            after_branch = 1;
+        }
+        break;
+    case IR_RET:
+        if (i->a.kind != OPD_NONE)
+            t_move_to(0, i->a);
+        if (b->next) {
+            t_emit_return();
+            after_branch = 1;
+        }
+        break;
+    default:                        // RSB, MLA: a seleção não os gera no Thumb
         break;
     }
 }
 
-static void gen_stmt(Node *node, const char *ret_label) {
-    switch (node->kind) {
-    case ND_RETURN:
-        if (node->lhs) gen_expr(node->lhs);
-        fprintf(out, "    b %s\n", ret_label);
-        break;
-    case ND_BLOCK:
-        for (int i = 0; i < node->stmt_count; i++)
-            gen_stmt(node->stmts[i], ret_label);
-        break;
-    case ND_IF: {
-        int id = label_id++;
-        char lelse[32];
-        char lend[32];
-        snprintf(lelse, sizeof lelse, ".Lelse%d", id);
-        snprintf(lend, sizeof lend, ".Lend%d", id);
-        gen_expr(node->lhs);
-        fprintf(out, "    cmp r0, #0\n");
-        if (node->els) {
-            fprintf(out, "    beq %s\n", lelse);
-            gen_stmt(node->rhs, ret_label);
-            fprintf(out, "    b %s\n", lend);
-            fprintf(out, "%s:\n", lelse);
-            gen_stmt(node->els, ret_label);
-            fprintf(out, "%s:\n", lend);
+/* Prólogo, blocos e epílogo em Thumb:
+ *   push {r4-r7 usados, lr?}
+ *   sub sp, #4*nslots
+ * A volta é pop {..., pc}; se o chamador pode estar em ARM, o pop não
+ * troca de modo e o endereço de volta passa por r3 para um bx. */
+static void t_gen_body(IrFunc *f, unsigned saved) {
+    unsigned mask = saved | (frame_lr ? 1u << REG_LR : 0);
+    frame_mask = mask;
+    npushed = 0;
+    push_depth = 0;
+    for (int r = 0; r < 16; r++)
+        if (mask & (1u << r))
+            npushed++;
+
+    emit(".global %s\n", f->name);
+    emit(".thumb_func\n");
+    emit("%s:\n", f->name);
+    if (mask) {
+        emit("    push ");
+        emit_reglist(mask);
+        emit("\n");
+    }
+    if (nslots)
+        t_sp_add(-4 * nslots);
+
+    for (IrBlock *b = f->entry; b; b = b->next) {
+        IrInst *i = b->first;
+        if (b == f->entry) {
+            i = emit_params(i);
         } else {
-            fprintf(out, "    beq %s\n", lend);
-            gen_stmt(node->rhs, ret_label);
-            fprintf(out, "%s:\n", lend);
-        }
-        break;
-    }
-    case ND_WHILE: {
-        int id = label_id++;
-        char lbegin[32];
-        char lend[32];
-        snprintf(lbegin, sizeof lbegin, ".Lbegin%d", id);
-        snprintf(lend, sizeof lend, ".Lendw%d", id);
-        fprintf(out, "%s:\n", lbegin);
-        gen_expr(node->lhs);
-        fprintf(out, "    cmp r0, #0\n");
-        fprintf(out, "    beq %s\n", lend);
-        gen_stmt(node->rhs, ret_label);
-        fprintf(out, "    b %s\n", lbegin);
-        fprintf(out, "%s:\n", lend);
-        break;
-    }
-    case ND_FOR: {
-        int id = label_id++;
-        char lbegin[32];
-        char lend[32];
-        snprintf(lbegin, sizeof lbegin, ".Lfor%d", id);
-        snprintf(lend, sizeof lend, ".Lendf%d", id);
-        if (node->init) gen_stmt(node->init, ret_label);
-        fprintf(out, "%s:\n", lbegin);
-        if (node->cond) {
-            gen_expr(node->cond);
-            fprintf(out, "    cmp r0, #0\n");
-            fprintf(out, "    beq %s\n", lend);
-        }
-        gen_stmt(node->rhs, ret_label);
-        if (node->inc) gen_expr(node->inc);
-        fprintf(out, "    b %s\n", lbegin);
-        fprintf(out, "%s:\n", lend);
-        break;
-    }
-    case ND_DECL: {
-        int off = lookup_local(node->name);
-        if (node->init) {
-            gen_expr(node->init);
-            fprintf(out, "    str r0, [fp, #%d]\n", off);
+            emit_label(b);
+            emit(":\n");
+        }
+        for (; i; i = i->next) {
+            t_emit_inst(i, b);
+            flush_pool(0);
         }
-        break;
     }
-    default:
-        gen_expr(node);
-        break;
-    }
-}
-
-static void gen_function(Node *fn) {
-    local_count = 0;
-    stack_size  = 0;
-    for (int i = 0; i < fn->arg_count; i++)
-        add_local(fn->args[i]->name);
-    for (int i = 0; i < fn->stmt_count; i++)
-        collect_locals(fn->stmts[i]);
-    if (stack_size % 4)
-        stack_size = (stack_size + 3) & ~3;
-
-    fprintf(out, ".global %s\n", fn->name);
-    fprintf(out, "%s:\n", fn->name);
-    fprintf(out, "    push {fp, lr}\n");
-    fprintf(out, "    mov fp, sp\n");
-    if (stack_size)
-        fprintf(out, "    sub sp, sp, #%d\n", stack_size);
-    for (int i = 0; i < fn->arg_count && i < 4; i++) {
-        int off = lookup_local(fn->args[i]->name);
-        fprintf(out, "    str r%d, [fp, #%d]\n", i, off);
-    }
-
-    char epilogue[32], fallthrough[32];
-    snprintf(epilogue,   sizeof epilogue,   ".Lep_%s",   fn->name);
-    snprintf(fallthrough,sizeof fallthrough,".Lftr_%s",  fn->name);
-    /* percorre corpo – passa ambos os rótulos               */
-    for (int i = 0; i < fn->stmt_count; i++)
-        gen_stmt(fn->stmts[i], epilogue);
-    /* ----- queda no fim: r0 := 0 -------------------------- */
-    fprintf(out, "%s:\n", fallthrough);
-    fprintf(out, "    mov r0, #0\n");
-    fprintf(out, "    b %s\n", epilogue);
 
-    /* ----- epílogo comum ---------------------------------- */
-    fprintf(out, "%s:\n", epilogue);
-    fprintf(out, "    mov sp, fp\n");
-    fprintf(out, "    pop {fp, pc}\n");
+    emit(".Lep_%s:\n", f->name);
+    if (nslots)
+        t_sp_add(4 * nslots);
+    unsigned regs = mask & ~(1u << REG_LR);
+    if (frame_lr && !iw_ret) {
+        emit("    pop ");
+        emit_reglist(regs | 1u << 15);
+        emit("\n");
+    } else {
+        if (regs) {
+            emit("    pop ");
+            emit_reglist(regs);
+            emit("\n");
+        }
+        if (frame_lr) {
+            emit("    pop {r3}\n");
+            emit("    bx r3\n");
+        } else {
+            emit("    bx lr\n");
+        }
+    }
+    flush_pool(1);
+}
+
+/* ------------------------------------------------------------------ */
+/* Tamanho e alcance dos desvios                                       */
+/* ------------------------------------------------------------------ */
+
+// Literal do pool pedido por m ("ldr rX, =..."), ou NULL
+static const char *literal(const MInst *m) {
+    return m->kind == MI_INSN && !strncmp(m->op, "ldr", 3) ? strchr(m->args, '=') : NULL;
+}
+
+/* Endereço de cada linha da lista (a partir de 0) em at; devolve o
+ * tamanho. Instruções têm 4 bytes no ARM e 2 no Thumb (bl, 4); cada
+ * .ltorg tem os literais pedidos desde o anterior, alinhados a 4 bytes
+ * (constantes repetidas uma vez só; símbolos, o llvm-mc não junta). */
+static int layout(MInst **v, int n, int in_thumb, int *at) {
+    int pc = 0, first = 0;
+    for (int k = 0; k < n; k++) {
+        at[k] = pc;
+        if (v[k]->kind == MI_INSN) {
+            pc += !in_thumb || !strcmp(v[k]->op, "bl") ? 4 : 2;
+        } else if (!strcmp(v[k]->args, ".ltorg")) {
+            pc = (pc + 3) & ~3;
+            for (int j = first; j < k; j++) {
+                const char *lit = literal(v[j]);
+                int dup = 0;
+                for (int e = first; lit && isdigit((unsigned char)lit[lit[1] == '-' ? 2 : 1]) &&
+                                    e < j && !dup; e++)
+                    dup = literal(v[e]) && !strcmp(literal(v[e]), lit);
+                if (lit && !dup)
+                    pc += 4;
+            }
+            first = k + 1;
+        }
+    }
+    return pc;
+}
+
+// A lista num vetor (com espaço para os endereços); devolve o nº de linhas
+static int list_array(MList *l, MInst ***v, int **at) {
+    int n = 0;
+    for (MInst *m = l->first; m; m = m->next)
+        n++;
+    *v  = malloc(sizeof **v * (n ? n : 1));
+    *at = malloc(sizeof **at * (n ? n : 1));
+    if (!*v || !*at) {
+        perror("malloc");
+        exit(1);
+    }
+    n = 0;
+    for (MInst *m = l->first; m; m = m->next)
+        (*v)[n++] = m;
+    return n;
 }
 
+static int code_bytes(MList *l) {
+    MInst **v;
+    int *at;
+    int n = list_array(l, &v, &at);
+    int bytes = layout(v, n, thumb, at);
+    free(v);
+    free(at);
+    return bytes;
+}
+
+/* No Thumb o desvio condicional alcança de -256 a +254 bytes e o 'b',
+ * ±2 KB. Um condicional longe demais vira o inverso pulando um 'b'; um
+ * 'b' longe demais vira bl, que alcança ±4 MB (numa função desse
+ * tamanho lr está salvo: ver gen_function). Cada troca aumenta o
+ * código, então repete até tudo caber. */
+static void relax_branches(MList *l) {
+    for (int changed = 1; changed; ) {
+        MInst **v;
+        int *at;
+        int n = list_array(l, &v, &at);
+        layout(v, n, 1, at);
+        changed = 0;
+        for (int k = 0; k < n && !changed; k++) {
+            MInst *m = v[k];
+            int cond = strlen(m->op) == 3 && m->op[0] == 'b' &&
+                       strcmp(invert_cc(m->op + 1), m->op + 1);
+            if (m->kind != MI_INSN || (!cond && strcmp(m->op, "b")))
+                continue;
+            int j;
+            for (j = 0; j < n; j++)
+                if (v[j]->kind == MI_LABEL && strlen(v[j]->args) == strlen(m->args) + 1 &&
+                    !strncmp(v[j]->args, m->args, strlen(m->args)))
+                    break;
+            if (j == n)
+                continue;
+            int disp = at[j] - (at[k] + 4);
+            if (!cond && (disp < -2040 || disp > 2040)) {        // margem para .align e pools
+                m->op = "bl";
+                changed = 1;
+            } else if (cond && (disp < -250 || disp > 250)) {
+                char op[8], buf[64];
+                int skip = local_id++;
+                snprintf(op, sizeof op, "b%s", invert_cc(m->op + 1));
+                snprintf(buf, sizeof buf, ".Lt%d:", skip);
+                mlist_insert(l, m, buf, strlen(buf));
+                snprintf(buf, sizeof buf, "    b %s", m->args);
+                mlist_insert(l, m, buf, strlen(buf));
+                snprintf(buf, sizeof buf, ".Lt%d", skip);
+                m->op   = arena_strndup(&compile_arena, op, strlen(op));
+                m->args = arena_strndup(&compile_arena, buf, strlen(buf));
+                changed = 1;
+            }
+        }
+        free(v);
+        free(at);
+    }
+}
+
+// Registradores r6 e r7 (rascunhos do Thumb) citados no código da função
+static unsigned scratch_used(const MList *l) {
+    unsigned mask = 0;
+    for (MInst *m = l->first; m; m = m->next) {
+        if (m->kind != MI_INSN)
+            continue;
+        for (const char *s = m->args; *s; s++)
+            if (s[0] == 'r' && (s[1] == '6' || s[1] == '7') &&
+                !isalnum((unsigned char)s[2]) && s[2] != '_' &&
+                (s == m->args || !(isalnum((unsigned char)s[-1]) || strchr("_.$=", s[-1]))))
+                mask |= 1u << (s[1] - '0');
+    }
+    return mask;
+}
+
+static void gen_function(IrFunc *f) {
+    fn = f;
+    thumb  = func_info(f->name)->thumb;
+    iw_ret = (func_info(f->name)->ret_to & ~mode_of(thumb)) != 0;
+    isel(f, thumb);
+    ir_liveness(f);
+
+    int nv = f->nvregs ? f->nvregs : 1;
+    iv    = malloc(sizeof *iv * nv);
+    vslot = malloc(sizeof *vslot * nv);
+    uses  = malloc(sizeof *uses * nv);
+    LiveInterval **ivs = malloc(sizeof *ivs * nv);
+    if (!iv || !vslot || !uses || !ivs) {
+        perror("malloc");
+        exit(1);
+    }
+    build_intervals();
 
-static void gen_global(Node *g) {
-    if (g->init && g->init->kind == ND_NUM) {
-        fprintf(out, "%s:\n    .word %d\n", g->name, g->init->val);
+    int n = 0;
+    for (int v = 0; v < f->nvregs; v++)
+        if (iv[v].end >= 0)
+            ivs[n++] = &iv[v];
+    unsigned used = thumb ? linear_scan(ivs, n, thumb_regs, NUM_THUMB_REGS)
+                          : linear_scan(ivs, n, alloc_regs, NUM_ALLOC_REGS);
+    free(ivs);
+
+    /* vregs sem registrador ganham slots depois dos das locais com '&' */
+    nslots = f->nslots;
+    for (int v = 0; v < f->nvregs; v++)
+        vslot[v] = (iv[v].end >= 0 && iv[v].reg < 0) ? nslots++ : -1;
+
+    unsigned saved = used & CALLEE_SAVED;
+    saved_size = 0;
+    for (int r = 0; r < 16; r++)
+        if (saved & (1u << r))
+            saved_size += 4;
+
+    /* fp só quando há slots; lr só quando há chamadas ou quando serviu
+     * de rascunho. Isso só se sabe depois de gerar o corpo: se uma folha
+     * precisou de lr, o corpo é gerado de novo com lr salvo. */
+    frame_fp = !thumb && nslots > 0;
+    frame_lr = ncalls > 0;
+    int emitted0 = emitted, pool_first0 = pool_first, pool_id0 = pool_id;
+    lr_touched = 0;
+    if (!thumb) {
+        gen_body(f, saved);
+        if (lr_touched && !frame_lr) {
+            code.first = code.last = NULL;
+            emitted    = emitted0;
+            pool_first = pool_first0;
+            pool_id    = pool_id0;
+            frame_lr   = 1;
+            gen_body(f, saved);
+        }
     } else {
-        fprintf(out, "%s:\n    .word 0\n", g->name);
+        /* No Thumb, r6 e r7 (rascunhos) são salvos se o corpo os usou, e
+         * lr também numa função grande, onde um 'b' longe pode virar bl
+         * (relax_branches) */
+        for (;;) {
+            t_gen_body(f, saved);
+            unsigned more = scratch_used(&code) & ~saved;
+            int far = !frame_lr && code_bytes(&code) > THUMB_NEAR_BYTES;
+            if (!more && !far)
+                break;
+            code.first = code.last = NULL;
+            emitted    = emitted0;
+            pool_first = pool_first0;
+            pool_id    = pool_id0;
+            saved     |= more;
+            frame_lr  |= far;
+        }
     }
+
+    free(iv);
+    free(vslot);
+    free(uses);
 }
 
-void codegen_to_file(Node *root, const char *out_path) {
+void codegen_to_file(IrProgram *prog, const char *out_path, CodegenStats *stats) {
+    CodegenStats st = { 0, 0, 0 };
     out = fopen(out_path, "w");
     if (!out) {
         perror(out_path);
         return;
     }
-    /* ---------- _start: chama main e finaliza via semihosting ----- */
-    fprintf(out,
+    plan_modes(prog);
+    /* ---------- _start: zera a .bss, chama main e finaliza via semihosting */
+    int nbss = 0, ndata = 0;
+    for (IrGlobal *g = prog->globals; g; g = g->next) {
+        if (g->has_init && g->init) ndata++;
+        else                        nbss++;
+    }
+    // mnemônicos Thumb (movs, adds, lsls, muls de três operandos...) só
+    // existem na sintaxe unificada; o GNU as assume a dividida
+    emit(
+        ".syntax unified\n"
         ".text\n"
         ".global _start\n"
         "_start:\n"
-        "    ldr sp, =_stack_top   @ pilha = topo reservado no linker\n"
-        "    bl  main          @ chama main()\n"
+        "    ldr sp, =_stack_top   @ pilha = topo reservado no linker\n");
+    if (nbss > BSS_INLINE) {
+        emit(
+        "    ldr r0, =_bss_start\n"
+        "    mov r1, #0\n"
+        "    ldr r2, =_bss_end\n"
+        "    sub r2, r2, r0\n"
+        "    bl  memset        @ runtime/memory.s\n");
+    } else if (nbss) {
+        emit(
+        "    ldr r0, =_bss_start\n"
+        "    mov r1, #0\n");
+        for (int k = 0; k < nbss; k++)
+            emit("    str r1, [r0, #%d]\n", 4 * k);
+    }
+    if (func_info(INTERNED("main"))->thumb)
+        emit(
+        "    ldr ip, =main\n"
+        "    mov lr, pc\n"
+        "    bx  ip            @ chama main(), em Thumb\n");
+    else
+        emit(
+        "    bl  main          @ chama main()\n");
+    emit(
         "    mov r7, #0x18     @ SYS_EXIT\n"
-        "    svc 0x123456 \n\n");
+        "    svc 0x123456 \n"
+        ".ltorg\n\n");
         // "    swi 0xbb \n\n");
+    emitted    = 0;
+    pool_first = -1;
+    pool_id    = 0;
 
-    /* globals */
-    int has_glob = 0;
-    for (int i = 0; i < root->stmt_count; i++)
-        if (root->stmts[i]->kind == ND_DECL)
-            has_glob = 1;
-    if (has_glob) {
-        fprintf(out, ".data\n");
-        for (int i = 0; i < root->stmt_count; i++)
-            if (root->stmts[i]->kind == ND_DECL)
-                gen_global(root->stmts[i]);
+    /* globais com valor inicial vão para .data; as zeradas, para .bss */
+    if (ndata) {
+        emit(".data\n");
+        for (IrGlobal *g = prog->globals; g; g = g->next)
+            if (g->has_init && g->init)
+                emit("%s:\n    .word %d\n", g->name, g->init);
+    }
+    if (nbss) {
+        emit(".bss\n");
+        for (IrGlobal *g = prog->globals; g; g = g->next)
+            if (!g->has_init || !g->init)
+                emit("%s:\n    .space 4\n", g->name);
     }
 
-    fprintf(out, ".text\n");
-    for (int i = 0; i < root->stmt_count; i++)
-        if (root->stmts[i]->kind == ND_FUNC)
-            gen_function(root->stmts[i]);
+    emit(".text\n");
+    mlist_write(&code, out);
+    int in_thumb = 0;
+    for (IrFunc *f = prog->funcs; f; f = f->next) {
+        gen_function(f);
+        st.removed += peephole(&code, thumb);
+        if (thumb)
+            relax_branches(&code);
+        st.bytes += code_bytes(&code);
+        if (thumb != in_thumb)
+            fprintf(out, thumb ? ".thumb\n" : ".arm\n.align 2\n");
+        in_thumb = thumb;
+        st.insns += mlist_write(&code, out);
+    }
+    if (in_thumb)
+        fprintf(out, ".arm\n");
+    thumb = 0;
+    st.bytes += emit_stubs();
+    st.insns += mlist_write(&code, out);
 
     fclose(out);
+    if (stats)
+        *stats = st;
 }
@@ -1,5 +1,17 @@
 #ifndef CODE_GENERATOR_H
 #define CODE_GENERATOR_H
-#include "../parser/parser.h"
-void codegen_to_file(Node *root, const char *out_path);
-#endif
\ No newline at end of file
+#include "../ir/ir.h"
+
+typedef struct {
+    int insns;      // instruções escritas no .s (sem o _start)
+    int removed;    // instruções eliminadas pelo peephole
+    int bytes;      // tamanho do código, literais e stubs inclusive (sem o _start)
+} CodegenStats;
+
+/* Conjunto de instruções das funções: -marm (padrão), -mthumb ou
+ * -mthumb=auto (Thumb, menos as funções com laço, que ficam em ARM) */
+typedef enum { ISA_ARM, ISA_THUMB, ISA_AUTO } Isa;
+extern Isa codegen_isa;
+
+void codegen_to_file(IrProgram *prog, const char *out_path, CodegenStats *stats);
+#endif
@@ -0,0 +1,683 @@
+#include "isel.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Seleção de instruções por casamento de padrões em árvores, com custos
+ * (no estilo BURS).
+ *
+ * A IR não é uma árvore, mas um valor definido uma única vez e lido uma
+ * única vez, mais adiante no mesmo bloco e sem que seus operandos mudem
+ * no caminho, pode ser calculado dentro de quem o lê: essas definições
+ * são os nós internos das árvores; as demais instruções são raízes.
+ *
+ * A rotulação vai das folhas para a raiz e guarda, para cada não
+ * terminal, a regra mais barata que o produz:
+ *   REG    valor num registrador (regra comum: a instrução sozinha)
+ *   OPND   registrador ou imediato
+ *   SHIFT  registrador deslocado por constante: operando 'rN, lsl #k'
+ *   MULT   produto ainda por somar: vira mla com a soma que o lê
+ *   ADDR   base + índice (deslocado): endereçamento '[rB, rI, lsl #k]'
+ *   DISP   base + constante: endereçamento '[rB, #k]'
+ * A redução reescreve a raiz na forma escolhida e remove os nós que ela
+ * absorveu; os filhos que ficaram como REG são raízes de suas árvores.
+ *
+ * O custo é 4 * ciclos + instruções: ciclos primeiro, tamanho desempata.
+ * Os ciclos vêm da tabela do núcleo (-mcpu=).
+ *
+ * No Thumb só sobram as formas de endereçamento que ele tem: '[rB, rI]'
+ * sem deslocamento e '[rB, #k]' com k múltiplo de 4 até 124. */
+
+static const CpuCost cpus[] = {
+    /*  nome        alu mul mla uso ldr */
+    { "arm7tdmi",    1,  1,  1,  0,  3 },   // ldr 1S+1N+1I; mul sem bolha
+    { "arm9tdmi",    1,  1,  1,  1,  2 },   // ldr 1 ciclo + 1 de bolha; mul com bolha
+};
+const CpuCost *isel_cpu = &cpus[0];
+
+int isel_set_cpu(const char *name) {
+    for (size_t k = 0; k < sizeof cpus / sizeof cpus[0]; k++)
+        if (!strcmp(cpus[k].name, name)) {
+            isel_cpu = &cpus[k];
+            return 1;
+        }
+    return 0;
+}
+
+/* Imediatos ARM: 8 bits rotacionados à direita por um número par */
+int arm_imm(unsigned v) {
+    for (int r = 0; r < 32; r += 2)
+        if (((v << r) | (v >> ((32 - r) & 31))) <= 0xFF)
+            return 1;
+    return 0;
+}
+
+// Divide v em dois imediatos disjuntos (a | b == v)
+int two_chunks(unsigned v, unsigned *a, unsigned *b) {
+    for (int p = 0; p < 32; p += 2) {
+        unsigned m = (0xFFu << p) | (p > 24 ? 0xFFu >> (32 - p) : 0);
+        if ((v & m) && (v & ~m) && arm_imm(v & ~m)) {
+            *a = v & m;
+            *b = v & ~m;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* ------------------------------------------------------------------ */
+/* Custos                                                              */
+/* ------------------------------------------------------------------ */
+
+#define COST(cyc, n) (4 * (cyc) + (n))
+#define INF (INT_MAX / 4)
+
+// Constante num registrador, como o gerador a materializa (load_imm)
+static int imm_cost(int v) {
+    unsigned a, b;
+    if (arm_imm((unsigned)v) || arm_imm(~(unsigned)v))
+        return COST(isel_cpu->alu, 1);
+    if (two_chunks((unsigned)v, &a, &b) || two_chunks(~(unsigned)v, &a, &b))
+        return COST(2 * isel_cpu->alu, 2);
+    return COST(isel_cpu->ldr, 1);
+}
+
+// m do mul: bytes do multiplicador além dos que são só extensão de sinal
+static int mul_m(Operand rs) {
+    if (rs.kind != OPD_IMM)
+        return 4;
+    int m = 1;
+    for (int s = 8; s < 32; s += 8)
+        if ((rs.v >> s) != 0 && (rs.v >> s) != -1)
+            m++;
+    return m;
+}
+
+/* ------------------------------------------------------------------ */
+/* Multiplicação por constante                                         */
+/* ------------------------------------------------------------------ */
+
+/* x * c como até MULC_MAX somas com operando deslocado. t é o valor
+ * parcial (começa em x); cada passo, com k > 0:
+ *   MC_SHL  t = t << k            MC_ADD_X  t = x + (t << k)
+ *   MC_ADD  t = t + (t << k)      MC_RSB_X  t = (t << k) - x
+ *   MC_RSB  t = (t << k) - t      MC_SUB_X  t = x - (t << k) */
+#define MULC_MAX 3
+
+typedef enum { MC_SHL, MC_ADD, MC_RSB, MC_ADD_X, MC_RSB_X, MC_SUB_X } MulcKind;
+
+typedef struct {
+    MulcKind kind;
+    int      k;
+} MulcStep;
+
+static int ctz(unsigned v) {
+    int n = 0;
+    while (!(v & 1)) {
+        v >>= 1;
+        n++;
+    }
+    return n;
+}
+
+/* Passos (em ordem de execução) que levam x a c*x, no máximo d; -1 se
+ * não há. c' é o fator que sobra para os passos anteriores. */
+static int mulc_find(unsigned c, int d, MulcStep *out) {
+    if (c == 1)
+        return 0;
+    if (d == 0 || c == 0)
+        return -1;
+    int n;
+#define TRY(cc, kind_, k_)                                      \
+    if ((n = mulc_find((cc), d - 1, out)) >= 0) {               \
+        out[n] = (MulcStep){ (kind_), (k_) };                   \
+        return n + 1;                                           \
+    }
+    if (!(c & 1)) {
+        TRY(c >> ctz(c), MC_SHL, ctz(c));
+        return -1;          // par: o último passo é sempre o deslocamento
+    }
+    for (int k = 1; k < 32; k++) {
+        unsigned m = (1u << k) + 1;
+        if (c % m == 0)
+            TRY(c / m, MC_ADD, k);
+        if (k >= 2 && c % (m - 2) == 0)
+            TRY(c / (m - 2), MC_RSB, k);
+    }
+    TRY((c - 1) >> ctz(c - 1), MC_ADD_X, ctz(c - 1));
+    if (c + 1)
+        TRY((c + 1) >> ctz(c + 1), MC_RSB_X, ctz(c + 1));
+    TRY((1 - c) >> ctz(1 - c), MC_SUB_X, ctz(1 - c));
+#undef TRY
+    return -1;
+}
+
+// Menor sequência para c (aprofundamento iterativo); a última fica guardada
+static int mulc_plan(int c, MulcStep *out) {
+    static int      last_c, last_n = -2;
+    static MulcStep last[MULC_MAX];
+    if (last_n == -2 || c != last_c) {
+        last_c = c;
+        last_n = -1;
+        for (int d = 1; d <= MULC_MAX && last_n < 0; d++)
+            last_n = mulc_find((unsigned)c, d, last);
+    }
+    if (last_n > 0)
+        memcpy(out, last, sizeof(MulcStep) * last_n);
+    return last_n;
+}
+
+/* ------------------------------------------------------------------ */
+/* Regras                                                              */
+/* ------------------------------------------------------------------ */
+
+typedef enum { NT_NONE, NT_IMM, NT_REG, NT_OPND, NT_SHIFT, NT_MULT, NT_ADDR, NT_DISP, NT_COUNT } Nonterm;
+
+typedef enum {
+    F_SHIFT,        // SHIFT <- shl/sar/shr(REG, IMM)
+    F_ALU_SH,       // REG   <- add/sub(REG, SHIFT)        add d, a, b, lsl #k
+    F_RSB_SH,       // REG   <- sub(SHIFT, REG)            rsb d, b, a, lsl #k
+    F_MULT,         // MULT  <- mul(REG, REG)
+    F_MLA,          // REG   <- add(MULT, REG)             mla d, x, y, b
+    F_ADDR,         // ADDR  <- add(REG, SHIFT | REG)
+    F_MEM,          // REG   <- load/store(ADDR, ...)      ldr d, [b, i, lsl #k]
+    F_DISP,         // DISP  <- add/sub(REG, IMM)
+    F_MEM_DISP,     // REG   <- load/store(DISP, ...)      ldr d, [b, #k]
+    F_MULC,         // REG   <- mul(REG, IMM)              somas deslocadas
+} Form;
+
+typedef struct {
+    IrOp    op;
+    Nonterm lhs;
+    Nonterm kid[2];     // para a e b (trocados, se 'swap')
+    int     swap;
+    Form    form;
+} Rule;
+
+static const Rule rules[] = {
+    { IR_SHL,   NT_SHIFT, { NT_REG,   NT_IMM   }, 0, F_SHIFT  },
+    { IR_SAR,   NT_SHIFT, { NT_REG,   NT_IMM   }, 0, F_SHIFT  },
+    { IR_SHR,   NT_SHIFT, { NT_REG,   NT_IMM   }, 0, F_SHIFT  },
+    { IR_ADD,   NT_REG,   { NT_REG,   NT_SHIFT }, 0, F_ALU_SH },
+    { IR_ADD,   NT_REG,   { NT_REG,   NT_SHIFT }, 1, F_ALU_SH },
+    { IR_SUB,   NT_REG,   { NT_REG,   NT_SHIFT }, 0, F_ALU_SH },
+    { IR_SUB,   NT_REG,   { NT_SHIFT, NT_REG   }, 0, F_RSB_SH },
+    { IR_MUL,   NT_MULT,  { NT_REG,   NT_REG   }, 0, F_MULT   },
+    { IR_ADD,   NT_REG,   { NT_MULT,  NT_REG   }, 0, F_MLA    },
+    { IR_ADD,   NT_REG,   { NT_MULT,  NT_REG   }, 1, F_MLA    },
+    { IR_ADD,   NT_ADDR,  { NT_REG,   NT_SHIFT }, 0, F_ADDR   },
+    { IR_ADD,   NT_ADDR,  { NT_REG,   NT_SHIFT }, 1, F_ADDR   },
+    { IR_ADD,   NT_ADDR,  { NT_REG,   NT_REG   }, 0, F_ADDR   },
+    { IR_LOAD,  NT_REG,   { NT_ADDR,  NT_NONE  }, 0, F_MEM    },
+    { IR_STORE, NT_REG,   { NT_ADDR,  NT_REG   }, 0, F_MEM    },
+    { IR_ADD,   NT_DISP,  { NT_REG,   NT_IMM   }, 0, F_DISP   },
+    { IR_ADD,   NT_DISP,  { NT_REG,   NT_IMM   }, 1, F_DISP   },
+    { IR_SUB,   NT_DISP,  { NT_REG,   NT_IMM   }, 0, F_DISP   },
+    { IR_LOAD,  NT_REG,   { NT_DISP,  NT_NONE  }, 0, F_MEM_DISP },
+    { IR_STORE, NT_REG,   { NT_DISP,  NT_REG   }, 0, F_MEM_DISP },
+    { IR_MUL,   NT_REG,   { NT_REG,   NT_IMM   }, 0, F_MULC   },
+    { IR_MUL,   NT_REG,   { NT_REG,   NT_IMM   }, 1, F_MULC   },
+};
+#define NRULES (int)(sizeof rules / sizeof rules[0])
+
+typedef struct {
+    int         cost[NT_COUNT];
+    const Rule *rule[NT_COUNT];     // NULL em REG: a instrução sozinha
+} Label;
+
+static IrFunc   *fn;
+static IrBlock  *blk;           // bloco da raiz
+static IrInst  **def;           // definição única de cada vreg (NULL: nenhuma ou várias)
+static IrBlock **def_blk;
+static int      *nuse;
+static int       nv0;           // vregs de antes da seleção
+static Label    *memo;          // rótulo de cada nó interno, válido enquanto
+static int      *memo_at;       //   memo_at[v] == stamp (uma raiz por vez)
+static int       stamp;
+static int       thumb;         // função gerada em Thumb
+
+// A regra r existe no Thumb (para a instrução i)?
+static int thumb_form(const Rule *r, const IrInst *i) {
+    Operand b = r->swap ? i->a : i->b;
+    switch (r->form) {
+    case F_ADDR:
+        return r->kid[1] == NT_REG;
+    case F_MEM:
+    case F_MEM_DISP:
+        return 1;
+    case F_DISP: {
+        int k = b.kind != OPD_IMM ? -1 : i->op == IR_SUB ? -b.v : b.v;
+        return k >= 0 && k <= 124 && k % 4 == 0;
+    }
+    default:
+        return 0;
+    }
+}
+
+// Custo próprio da regra em i (sem os filhos); -1 se não se aplica
+static int rule_cost(const Rule *r, const IrInst *i) {
+    const CpuCost *c = isel_cpu;
+    Operand b = r->swap ? i->a : i->b;
+    MulcStep steps[MULC_MAX];
+    int n;
+    if (thumb && !thumb_form(r, i))
+        return -1;
+    switch (r->form) {
+    case F_SHIFT:
+        return b.kind == OPD_IMM && b.v >= 1 && b.v <= 31 ? 0 : -1;
+    case F_ALU_SH:
+    case F_RSB_SH:
+        return COST(c->alu, 1);
+    case F_MULT:
+        return COST(c->mul + mul_m(i->b), 0);
+    case F_MLA:
+        return COST(c->mla, 1);
+    case F_ADDR:
+        return 0;
+    case F_MEM:
+    case F_MEM_DISP:
+        return i->imm == 0 ? COST(c->ldr, 1) : -1;
+    case F_DISP:
+        return b.kind == OPD_IMM && b.v > -4096 && b.v < 4096 ? 0 : -1;   // 12 bits
+    case F_MULC:
+        if (b.kind != OPD_IMM)
+            return -1;
+        n = mulc_plan(b.v, steps);
+        return n > 0 ? COST(n * c->alu, n) : -1;
+    }
+    return -1;
+}
+
+// A instrução sozinha, com os operandos já em registradores
+static int plain_cost(const IrInst *i) {
+    const CpuCost *c = isel_cpu;
+    switch (i->op) {
+    case IR_MUL: {
+        int k = i->a.kind == OPD_IMM ? imm_cost(i->a.v) : i->b.kind == OPD_IMM ? imm_cost(i->b.v) : 0;
+        return COST(c->mul + mul_m(i->b) + c->mul_use, 1) + k;
+    }
+    case IR_LOAD:
+    case IR_STORE:
+        return COST(c->ldr, 1);
+    default:
+        return COST(c->alu, 1);
+    }
+}
+
+/* Definição de o que pode ser nó interno da árvore de 'root': única,
+ * lida só ali, antes no mesmo bloco e com os operandos intactos até lá */
+static IrInst *interior(Operand o, IrInst *root) {
+    if (o.kind != OPD_VREG || o.v >= nv0)
+        return NULL;
+    IrInst *d = def[o.v];
+    if (!d || nuse[o.v] != 1 || def_blk[o.v] != blk)
+        return NULL;
+    if (d->op != IR_SHL && d->op != IR_SAR && d->op != IR_SHR &&
+        d->op != IR_MUL && d->op != IR_ADD && d->op != IR_SUB)
+        return NULL;
+    for (IrInst *x = d->next; x; x = x->next) {
+        if (x == root)
+            return d;
+        if (x->dst >= 0 && ((d->a.kind == OPD_VREG && d->a.v == x->dst) ||
+                            (d->b.kind == OPD_VREG && d->b.v == x->dst)))
+            return NULL;
+    }
+    return NULL;
+}
+
+static void label(IrInst *n, IrInst *root, Label *l);
+
+static int kid_cost(Operand o, Nonterm nt, IrInst *root) {
+    if (nt == NT_NONE)
+        return o.kind == OPD_NONE ? 0 : INF;
+    if (o.kind == OPD_IMM)
+        return nt == NT_IMM || nt == NT_OPND ? 0 : nt == NT_REG ? imm_cost(o.v) : INF;
+    if (o.kind != OPD_VREG)
+        return INF;
+    IrInst *d = interior(o, root);
+    if (!d)
+        return nt == NT_REG || nt == NT_OPND ? 0 : INF;
+    Label l;
+    label(d, root, &l);
+    return l.cost[nt];
+}
+
+static void label(IrInst *n, IrInst *root, Label *l) {
+    if (n != root && memo_at[n->dst] == stamp) {
+        *l = memo[n->dst];
+        return;
+    }
+    for (int k = 0; k < NT_COUNT; k++) {
+        l->cost[k] = INF;
+        l->rule[k] = NULL;
+    }
+    /* regra comum: a instrução sozinha; LOAD/STORE querem o endereço
+     * e o valor em registradores, as demais aceitam imediatos */
+    Nonterm nt = n->op == IR_LOAD || n->op == IR_STORE ? NT_REG : NT_OPND;
+    int c = plain_cost(n);
+    if (n->a.kind != OPD_NONE) c += kid_cost(n->a, nt, root);
+    if (n->b.kind != OPD_NONE) c += kid_cost(n->b, nt, root);
+    l->cost[NT_REG] = c;
+
+    for (int k = 0; k < NRULES; k++) {
+        const Rule *r = &rules[k];
+        if (r->op != n->op || (c = rule_cost(r, n)) < 0)
+            continue;
+        c += kid_cost(r->swap ? n->b : n->a, r->kid[0], root);
+        if (c >= INF) continue;
+        c += kid_cost(r->swap ? n->a : n->b, r->kid[1], root);
+        if (c < l->cost[r->lhs]) {
+            l->cost[r->lhs] = c;
+            l->rule[r->lhs] = r;
+        }
+    }
+    if (l->cost[NT_REG] < l->cost[NT_OPND]) {
+        l->cost[NT_OPND] = l->cost[NT_REG];
+        l->rule[NT_OPND] = l->rule[NT_REG];
+    }
+    if (n != root) {
+        memo[n->dst]    = *l;
+        memo_at[n->dst] = stamp;
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/* Redução                                                             */
+/* ------------------------------------------------------------------ */
+
+// Regra escolhida para o nó n como nt
+static const Rule *chosen(IrInst *n, Nonterm nt, IrInst *root) {
+    Label l;
+    label(n, root, &l);
+    return l.rule[nt];
+}
+
+// O operando deslocado vem do nó SHIFT s (que sai do bloco)
+static void take_shift(IrInst *i, IrInst *s) {
+    i->shop  = s->op;
+    i->shamt = s->b.v;
+    ir_remove(blk, s);
+}
+
+// Expande x * c em somas deslocadas antes de i; o último passo é o próprio i
+static IrInst *expand_mulc(IrInst *i, int swap) {
+    static const IrOp ops[] = {
+        [MC_SHL] = IR_SHL, [MC_ADD] = IR_ADD, [MC_RSB] = IR_RSB,
+        [MC_ADD_X] = IR_ADD, [MC_RSB_X] = IR_RSB, [MC_SUB_X] = IR_SUB,
+    };
+    MulcStep steps[MULC_MAX];
+    Operand x = swap ? i->b : i->a;
+    int n = mulc_plan(swap ? i->a.v : i->b.v, steps);
+    Operand t = x;
+    IrInst *first = i;
+    for (int k = 0; k < n; k++) {
+        IrInst *s = i;
+        if (k < n - 1) {
+            s = ir_insert_before(i, blk, ops[steps[k].kind]);
+            s->dst = ir_new_vreg(fn);
+            if (k == 0)
+                first = s;
+        }
+        s->op = ops[steps[k].kind];
+        if (steps[k].kind == MC_SHL) {
+            s->a = t;
+            s->b = opd_imm(steps[k].k);
+        } else {
+            s->a     = steps[k].kind == MC_ADD || steps[k].kind == MC_RSB ? t : x;
+            s->b     = t;
+            s->shop  = IR_SHL;
+            s->shamt = steps[k].k;
+        }
+        t = opd_vreg(s->dst);
+    }
+    return first;
+}
+
+// Reescreve a raiz i segundo a regra r; devolve a primeira instrução do resultado
+static IrInst *reduce(IrInst *i, const Rule *r) {
+    Operand ka = r->swap ? i->b : i->a, kb = r->swap ? i->a : i->b;
+    IrInst *s, *m, *a;
+    switch (r->form) {
+    case F_ALU_SH:
+        s = interior(kb, i);
+        i->a = ka;
+        i->b = s->a;
+        take_shift(i, s);
+        break;
+    case F_RSB_SH:
+        s = interior(ka, i);
+        i->op = IR_RSB;
+        i->a  = kb;
+        i->b  = s->a;
+        take_shift(i, s);
+        break;
+    case F_MLA:
+        m = interior(ka, i);
+        i->op = IR_MLA;
+        i->a  = m->a;
+        i->b  = m->b;
+        i->c  = kb;
+        ir_remove(blk, m);
+        break;
+    case F_MEM: {
+        a = interior(i->a, i);
+        const Rule *ra = chosen(a, NT_ADDR, i);
+        Operand base = ra->swap ? a->b : a->a, idx = ra->swap ? a->a : a->b;
+        i->a = base;
+        i->c = idx;
+        if (ra->kid[1] == NT_SHIFT) {
+            s = interior(idx, i);
+            i->c = s->a;
+            take_shift(i, s);
+        }
+        ir_remove(blk, a);
+        break;
+    }
+    case F_MEM_DISP: {
+        a = interior(i->a, i);
+        const Rule *ra = chosen(a, NT_DISP, i);
+        i->a   = ra->swap ? a->b : a->a;
+        i->imm = a->op == IR_SUB ? -a->b.v : ra->swap ? a->a.v : a->b.v;
+        ir_remove(blk, a);
+        break;
+    }
+    case F_MULC:
+        return expand_mulc(i, r->swap);
+    default:
+        break;
+    }
+    return i;
+}
+
+/* ------------------------------------------------------------------ */
+/* Acessos vizinhos                                                    */
+/* ------------------------------------------------------------------ */
+
+/* Cargas da mesma base em endereços consecutivos sobem para junto da
+ * primeira, e escritas assim descem para junto da última, para o
+ * gerador juntá-las num ldm/stm (2 ciclos mais 1 por palavra, no lugar
+ * de 3 por ldr). Nada que escreva na memória fica entre as cargas que
+ * trocam de lugar, nem acesso algum entre as escritas. */
+#define MEM_GROUP 4
+
+// Base (-1: fp) e deslocamento de um acesso simples à memória; 0 se não é um
+static int mem_access(const IrInst *i, int *base, int *off) {
+    switch (i->op) {
+    case IR_LOAD: case IR_STORE:
+        if (i->a.kind != OPD_VREG || i->c.kind != OPD_NONE)
+            return 0;
+        *base = i->a.v;
+        *off  = i->imm;
+        return 1;
+    case IR_LOAD_LOCAL: case IR_STORE_LOCAL:
+        *base = -1;
+        *off  = 4 * i->imm;         // o slot k fica 4 bytes acima do k - 1
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static int is_load(const IrInst *i) {
+    return i->op == IR_LOAD || i->op == IR_LOAD_LOCAL;
+}
+
+static int reads(const IrInst *i, int v) {
+    if ((i->a.kind == OPD_VREG && i->a.v == v) || (i->b.kind == OPD_VREG && i->b.v == v) ||
+        (i->c.kind == OPD_VREG && i->c.v == v))
+        return 1;
+    for (int k = 0; k < i->nargs; k++)
+        if (i->args[k].kind == OPD_VREG && i->args[k].v == v)
+            return 1;
+    return 0;
+}
+
+// Tira i do lugar e o põe logo depois de pos (mesmo bloco)
+static void move_after(IrInst *i, IrInst *pos) {
+    ir_remove(blk, i);
+    i->prev = pos;
+    i->next = pos->next;
+    if (pos->next) pos->next->prev = i;
+    else           blk->last       = i;
+    pos->next = i;
+}
+
+/* Próximo acesso do mesmo tipo que i, na base dela e em off + step (step
+ * 0: +4 ou -4), antes de alguma barreira; NULL se não há */
+static IrInst *next_access(IrInst *i, IrInst *from, int base, int off, int *step) {
+    for (IrInst *x = from; x; x = x->next) {
+        int xb, xo;
+        if (is_load(x) == is_load(i) && mem_access(x, &xb, &xo) && xb == base &&
+            (*step ? xo == off + *step : xo == off + 4 || xo == off - 4) &&
+            (!is_load(x) || x->dst != base)) {
+            *step = xo - off;
+            return x;
+        }
+        if (ir_has_side_effect(x) || (!is_load(i) && is_load(x)) ||
+            (base >= 0 && x->dst == base))
+            return NULL;
+    }
+    return NULL;
+}
+
+// A carga x pode subir para logo depois de 'last'?
+static int can_hoist(IrInst *last, IrInst *x) {
+    for (IrInst *y = last->next; y != x; y = y->next)
+        if (y->dst == x->dst || reads(y, x->dst))
+            return 0;
+    return 1;
+}
+
+// As escritas first..last podem descer para logo antes de x?
+static int can_sink(IrInst *first, IrInst *last, IrInst *x) {
+    for (IrInst *y = last->next; y != x; y = y->next)
+        for (IrInst *s = first; y->dst >= 0; s = s->next) {
+            if (reads(s, y->dst))
+                return 0;
+            if (s == last)
+                break;
+        }
+    return 1;
+}
+
+static void group_accesses(void) {
+    for (IrInst *i = blk->first; i; i = i->next) {
+        int base, off, step = 0;
+        if (!mem_access(i, &base, &off) || (is_load(i) && i->dst == base))
+            continue;
+        IrInst *first = i, *last = i, *x;
+        for (int n = 1; n < MEM_GROUP; n++) {
+            if (!(x = next_access(i, last->next, base, off, &step)))
+                break;
+            if (is_load(x)) {
+                if (!can_hoist(last, x))
+                    break;
+                if (x != last->next)
+                    move_after(x, last);
+            } else {
+                if (!can_sink(first, last, x))
+                    break;
+                IrInst *at = x->prev;
+                for (IrInst *s = last, *p; at != last; s = p) {
+                    p = s->prev;
+                    move_after(s, at);
+                    if (s == first)
+                        break;
+                }
+            }
+            last = x;
+            off += step;
+        }
+        i = last;
+    }
+}
+
+static int selectable(const IrInst *i) {
+    switch (i->op) {
+    case IR_ADD: case IR_SUB: case IR_MUL: case IR_LOAD: case IR_STORE:
+        return !i->shamt && i->c.kind == OPD_NONE;
+    default:
+        return 0;
+    }
+}
+
+void isel(IrFunc *f, int in_thumb) {
+    fn  = f;
+    thumb = in_thumb;
+    nv0 = f->nvregs;
+    int nv = nv0 ? nv0 : 1;
+    def     = calloc(nv, sizeof *def);
+    def_blk = calloc(nv, sizeof *def_blk);
+    nuse    = calloc(nv, sizeof *nuse);
+    int *ndef = calloc(nv, sizeof *ndef);
+    memo    = malloc(sizeof *memo * nv);
+    memo_at = calloc(nv, sizeof *memo_at);
+    if (!def || !def_blk || !nuse || !ndef || !memo || !memo_at) {
+        perror("calloc");
+        exit(1);
+    }
+    for (IrBlock *b = f->entry; b; b = b->next)
+        for (IrInst *i = b->first; i; i = i->next) {
+            Operand *ops[] = { &i->a, &i->b, &i->c };
+            for (int k = 0; k < 3; k++)
+                if (ops[k]->kind == OPD_VREG)
+                    nuse[ops[k]->v]++;
+            for (int k = 0; k < i->nargs; k++)
+                if (i->args[k].kind == OPD_VREG)
+                    nuse[i->args[k].v]++;
+            if (i->dst >= 0) {
+                ndef[i->dst]++;
+                def[i->dst]     = i;
+                def_blk[i->dst] = b;
+            }
+        }
+    for (int v = 0; v < nv0; v++)
+        if (ndef[v] != 1)
+            def[v] = NULL;
+
+    /* de trás para frente: a raiz é escolhida antes dos nós que ela
+     * pode absorver, e o que sobra deles vira raiz depois */
+    for (IrBlock *b = f->entry; b; b = b->next) {
+        blk = b;
+        IrInst *prev;
+        for (IrInst *i = b->last; i; i = prev) {
+            prev = i->prev;
+            if (!selectable(i))
+                continue;
+            Label l;
+            stamp++;
+            label(i, i, &l);
+            if (l.rule[NT_REG])
+                prev = reduce(i, l.rule[NT_REG])->prev;
+        }
+        if (!thumb)                 // sem ldm/stm com modos no Thumb
+            group_accesses();
+    }
+    free(def);
+    free(def_blk);
+    free(nuse);
+    free(ndef);
+    free(memo);
+    free(memo_at);
+}
@@ -0,0 +1,32 @@
+#ifndef ISEL_H
+#define ISEL_H
+#include "../ir/ir.h"
+
+/* Custos de um núcleo, em ciclos (manuais técnicos do ARM7TDMI e do
+ * ARM9TDMI). O mul custa mul + m, com m = bytes significativos do
+ * multiplicador (1 a 4, término antecipado do multiplicador de 8 bits). */
+typedef struct {
+    const char *name;
+    int alu;        // mov/add/sub/rsb, inclusive com operando deslocado por imediato
+    int mul;        // parte fixa do mul
+    int mla;        // o que o mla custa a mais que o mul
+    int mul_use;    // bolha quando o produto é lido pela instrução seguinte
+    int ldr;        // ldr/str, com a bolha de uso do valor carregado
+} CpuCost;
+
+extern const CpuCost *isel_cpu;         // -mcpu=; ARM7TDMI por padrão
+int  isel_set_cpu(const char *name);    // 0 se o núcleo é desconhecido
+
+/* Imediatos ARM (8 bits rotacionados), usados também pelo gerador */
+int arm_imm(unsigned v);
+int two_chunks(unsigned v, unsigned *a, unsigned *b);
+
+/* Reescreve a IR da função nas formas de instrução escolhidas: operando
+ * deslocado, rsb, mla, endereço base + índice (ou + constante) e
+ * multiplicação por constante em somas deslocadas; depois aproxima
+ * acessos à memória em endereços vizinhos, para ldm/stm. Antes da
+ * alocação de registradores. Com 'thumb', só os endereçamentos que o
+ * Thumb tem. */
+void isel(IrFunc *f, int thumb);
+
+#endif
@@ -0,0 +1,409 @@
+#include "peephole.h"
+#include "arena.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ------------------------------------------------------------------ */
+/* Lista de instruções                                                 */
+/* ------------------------------------------------------------------ */
+
+void mlist_line(MList *l, const char *line, size_t n) {
+    MInst *m = arena_calloc(&compile_arena, sizeof *m);
+    if (n > 0 && line[0] == ' ') {          // "    op args" (args pode faltar: nop)
+        size_t k = 0, e;
+        while (k < n && line[k] == ' ') k++;
+        for (e = k; e < n && line[e] != ' '; e++) ;
+        m->kind = MI_INSN;
+        m->op   = arena_strndup(&compile_arena, line + k, e - k);
+        while (e < n && line[e] == ' ') e++;
+        m->args = arena_strndup(&compile_arena, line + e, n - e);
+    } else {
+        m->kind = n > 0 && line[n - 1] == ':' ? MI_LABEL : MI_DIRECTIVE;
+        m->op   = "";
+        m->args = arena_strndup(&compile_arena, line, n);
+    }
+    m->prev = l->last;
+    if (l->last) l->last->next = m;
+    else         l->first = m;
+    l->last = m;
+}
+
+void mlist_insert(MList *l, MInst *pos, const char *line, size_t n) {
+    MList one = { NULL, NULL };
+    mlist_line(&one, line, n);
+    MInst *m = one.first;
+    m->prev = pos;
+    m->next = pos->next;
+    if (pos->next) pos->next->prev = m;
+    else           l->last = m;
+    pos->next = m;
+}
+
+int mlist_write(MList *l, FILE *out) {
+    int n = 0;
+    for (MInst *m = l->first; m; m = m->next) {
+        if (m->kind == MI_INSN) {
+            fprintf(out, "    %s %s\n", m->op, m->args);
+            n++;
+        } else {
+            fprintf(out, "%s\n", m->args);
+        }
+    }
+    l->first = l->last = NULL;
+    return n;
+}
+
+static void mlist_remove(MList *l, MInst *m) {
+    if (m->prev) m->prev->next = m->next;
+    else         l->first = m->next;
+    if (m->next) m->next->prev = m->prev;
+    else         l->last = m->prev;
+}
+
+/* ------------------------------------------------------------------ */
+/* Reconhecimento de operandos                                         */
+/* ------------------------------------------------------------------ */
+
+// op é 'base' seguido de uma condição opcional; devolve a condição ou NULL
+static const char *cond_of(const char *op, const char *base) {
+    static const char *conds[] = { "", "eq", "ne", "lt", "le", "gt", "ge" };
+    size_t n = strlen(base);
+    if (strncmp(op, base, n))
+        return NULL;
+    for (size_t k = 0; k < sizeof conds / sizeof conds[0]; k++)
+        if (!strcmp(op + n, conds[k]))
+            return op + n;
+    return NULL;
+}
+
+/* "rA, resto": copia rA para reg e devolve o resto (NULL se não tem vírgula) */
+static const char *first_reg(const char *args, char *reg, size_t cap) {
+    const char *c = strchr(args, ',');
+    if (!c || (size_t)(c - args) >= cap)
+        return NULL;
+    memcpy(reg, args, c - args);
+    reg[c - args] = '\0';
+    return c + 1 + strspn(c + 1, " ");
+}
+
+// "{rA}": um registrador só
+static int single_reg(const char *args, char *reg, size_t cap) {
+    size_t n = strlen(args);
+    if (n < 3 || args[0] != '{' || args[n - 1] != '}' || n - 2 >= cap ||
+        memchr(args, ',', n) || memchr(args, '-', n))
+        return 0;
+    memcpy(reg, args + 1, n - 2);
+    reg[n - 2] = '\0';
+    return 1;
+}
+
+static MInst *next_insn(MInst *m) {
+    m = m->next;
+    return m && m->kind == MI_INSN ? m : NULL;
+}
+
+// Número do registrador s[0..n) (r0–r15, fp, ip, sp, lr, pc); -1 se não é um
+static int reg_num(const char *s, size_t n) {
+    static const char *alias[] = { "fp", "ip", "sp", "lr", "pc" };
+    for (int k = 0; k < 5; k++)
+        if (n == 2 && !strncmp(s, alias[k], 2))
+            return 11 + k;
+    if (n < 2 || n > 3 || s[0] != 'r' || !isdigit((unsigned char)s[1]) ||
+        (n == 3 && (s[1] != '1' || !isdigit((unsigned char)s[2]))))
+        return -1;
+    int r = atoi(s + 1);
+    return r < 16 ? r : -1;
+}
+
+/* Registradores citados em s, inclusive faixas de listas ({r4-r6});
+ * nomes depois de '=' são símbolos do pool, não registradores */
+static unsigned regs_in(const char *s) {
+    unsigned mask = 0;
+    int last = -1, range = 0;
+    while (*s) {
+        size_t n = strspn(s, "abcdefghijklmnopqrstuvwxyz0123456789_.");
+        if (!n) {
+            if (*s == '=')
+                s += strcspn(s, ",]}");
+            else {
+                range = *s == '-' && last >= 0;
+                s++;
+            }
+            continue;
+        }
+        int r = reg_num(s, n);
+        if (r >= 0) {
+            for (int k = range ? last : r; k <= r; k++)
+                mask |= 1u << k;
+            last = r;
+        }
+        range = 0;
+        s += n;
+    }
+    return mask;
+}
+
+static int popcount(unsigned v) {
+    int n = 0;
+    for (; v; v &= v - 1)
+        n++;
+    return n;
+}
+
+/* Registradores lidos e escritos por m; 0 se é uma instrução que as
+ * regras não sabem atravessar (desvios, pilha, escrita de volta, pc) */
+static int effects(const MInst *m, unsigned *rd, unsigned *wr) {
+    static const char *compare[] = { "cmp", "cmn", "tst", "teq" };
+    static const char *write[]   = { "mov", "mvn", "add", "sub", "rsb", "and", "orr",
+                                     "eor", "bic", "mul", "mla", "ldr" };
+    char a[8];
+    const char *rest;
+    for (size_t k = 0; k < sizeof compare / sizeof compare[0]; k++)
+        if (cond_of(m->op, compare[k])) {
+            *rd = regs_in(m->args);
+            *wr = 0;
+            return 1;
+        }
+    if (!(rest = first_reg(m->args, a, sizeof a)) || strchr(rest, '!') ||
+        (rest[0] == '[' && rest[strlen(rest) - 1] != ']'))
+        return 0;
+    if (cond_of(m->op, "str")) {
+        *rd = regs_in(m->args);
+        *wr = 0;
+        return 1;
+    }
+    int r = reg_num(a, strlen(a));
+    for (size_t k = 0; k < sizeof write / sizeof write[0]; k++)
+        if (cond_of(m->op, write[k]) && r >= 0 && r != 15) {
+            *rd = regs_in(rest);
+            *wr = 1u << r;
+            return 1;
+        }
+    return 0;
+}
+
+// "[rB, #0]": copia rB para reg
+static int zero_offset(const char *s, char *reg, size_t cap) {
+    size_t n = strlen(s), k = strcspn(s, ",");
+    if (n < 7 || s[0] != '[' || k + 5 != n || k - 1 >= cap || strcmp(s + k, ", #0]"))
+        return 0;
+    memcpy(reg, s + 1, k - 1);
+    reg[k - 1] = '\0';
+    return 1;
+}
+
+/* "add rB, rB, #k" ou "sub rB, rB, #k", incondicional: devolve k com
+ * sinal (0 se não é da forma) */
+static int base_step(const MInst *m, char *reg, size_t cap) {
+    const char *rest, *c;
+    int k;
+    if ((strcmp(m->op, "add") && strcmp(m->op, "sub")) ||
+        !(rest = first_reg(m->args, reg, cap)) || strncmp(rest, reg, strlen(reg)) ||
+        strncmp(c = rest + strlen(reg), ", #", 3) || (k = atoi(c + 3)) <= 0)
+        return 0;
+    return m->op[0] == 'a' ? k : -k;
+}
+
+/* ldm/stm com modo, sem escrita de volta: "rB, {lista}". Devolve 1 se
+ * o modo é ia/ib (cresce), -1 se da/db, 0 se não é da forma. */
+static int multiple(const MInst *m, int *load, char *reg, size_t cap, const char **list) {
+    if ((strncmp(m->op, "ldm", 3) && strncmp(m->op, "stm", 3)) || strlen(m->op) != 5 ||
+        !strchr("id", m->op[3]) || !strchr("ab", m->op[4]) ||
+        !(*list = first_reg(m->args, reg, cap)) || strchr(reg, '!'))
+        return 0;
+    *load = m->op[0] == 'l';
+    return m->op[3] == 'i' ? 1 : -1;
+}
+
+
+/* ------------------------------------------------------------------ */
+/* Regras                                                              */
+/* ------------------------------------------------------------------ */
+
+/* Cada regra olha a janela que começa em m; se reescrever, devolve
+ * quantas instruções saíram (0 se só trocou uma por outra). Sem
+ * casamento, devolve -1 e não mexe em nada. */
+typedef int (*PeepRule)(MList *l, MInst *m);
+
+static int thumb;           // a lista é de uma função em Thumb
+
+// mov rA, rA
+static int self_move(MList *l, MInst *m) {
+    char a[8];
+    const char *rest;
+    if (!cond_of(m->op, "mov") || !(rest = first_reg(m->args, a, sizeof a)) ||
+        strcmp(rest, a))
+        return -1;
+    mlist_remove(l, m);
+    return 1;
+}
+
+/* str rA, [X] ; ldr rB, [X]  ->  str rA, [X] ; mov rB, rA
+ * (nada se rB == rA): o valor acabou de ser escrito ali. No Thumb o
+ * mov entre registradores baixos é o movs. */
+static int store_load(MList *l, MInst *m) {
+    char a[8], b[8];
+    const char *cs, *cl, *xs, *xl;
+    MInst *n = next_insn(m);
+    if (!n || !(cs = cond_of(m->op, "str")) || !(cl = cond_of(n->op, "ldr")) ||
+        strcmp(cs, cl) || !(xs = first_reg(m->args, a, sizeof a)) ||
+        !(xl = first_reg(n->args, b, sizeof b)) || xs[0] != '[' ||
+        xs[strlen(xs) - 1] != ']' || strcmp(xs, xl))
+        return -1;
+    if (!strcmp(a, b)) {
+        mlist_remove(l, n);
+        return 1;
+    }
+    char op[8], buf[32];
+    snprintf(op, sizeof op, "mov%s", thumb ? "s" : cl);
+    snprintf(buf, sizeof buf, "%s, %s", b, a);
+    n->op   = arena_strndup(&compile_arena, op, strlen(op));
+    n->args = arena_strndup(&compile_arena, buf, strlen(buf));
+    return 0;
+}
+
+// push {rA} ; pop {rB}  ->  mov rB, rA (nada se rB == rA)
+static int push_pop(MList *l, MInst *m) {
+    char a[8], b[8], buf[32];
+    MInst *n = next_insn(m);
+    if (!n || strcmp(m->op, "push") || strcmp(n->op, "pop") ||
+        !single_reg(m->args, a, sizeof a) || !single_reg(n->args, b, sizeof b))
+        return -1;
+    mlist_remove(l, m);
+    if (!strcmp(a, b)) {
+        mlist_remove(l, n);
+        return 2;
+    }
+    snprintf(buf, sizeof buf, "%s, %s", b, a);
+    n->op   = thumb ? "movs" : "mov";
+    n->args = arena_strndup(&compile_arena, buf, strlen(buf));
+    return 1;
+}
+
+// b L (ou bCC L) com L entre os rótulos logo a seguir
+static int jump_next(MList *l, MInst *m) {
+    if (!cond_of(m->op, "b"))
+        return -1;
+    for (MInst *n = m->next; n && n->kind == MI_LABEL; n = n->next) {
+        size_t k = strlen(n->args) - 1;     // sem o ':'
+        if (strlen(m->args) == k && !strncmp(n->args, m->args, k)) {
+            mlist_remove(l, m);
+            return 1;
+        }
+    }
+    return -1;
+}
+
+/* Endereçamento com escrita de volta. As regras abaixo juntam uma
+ * atualização 'add/sub rB, rB, #k' a um acesso por rB que está até
+ * PEEP_REACH instruções dela, se nada no meio lê ou escreve rB. O ARM
+ * não define o resultado se o registrador do valor (ou um da lista de
+ * um ldm/stm) é a própria base. */
+#define PEEP_REACH 8
+
+// Primeira instrução depois de m que toca em r ou que não se sabe atravessar
+static MInst *next_touch(MInst *m, int r) {
+    int k = 0;
+    for (MInst *n = next_insn(m); n && k < PEEP_REACH; n = next_insn(n), k++) {
+        unsigned rd, wr;
+        if (!effects(n, &rd, &wr) || ((rd | wr) & (1u << r)))
+            return n;
+    }
+    return NULL;
+}
+
+static void set_args(MInst *m, const char *args) {
+    m->args = arena_strndup(&compile_arena, args, strlen(args));
+}
+
+/* ldr/str rA, [rB, #0] ; ... ; add rB, rB, #k  ->  ldr/str rA, [rB], #k
+ * ldmia/ldmib rB, {...} ; ... ; add rB, rB, #4n  ->  ldmia/ldmib rB!, {...}
+ * (e stm; da/db com sub) */
+static int post_index(MList *l, MInst *m) {
+    char a[8], b[8], c[8], buf[64];
+    const char *rest, *list;
+    int load, dir, r, k;
+    MInst *n;
+    if (!strcmp(m->op, "ldr") || !strcmp(m->op, "str")) {
+        if (!(rest = first_reg(m->args, a, sizeof a)) || !zero_offset(rest, b, sizeof b) ||
+            !strcmp(a, b) || (r = reg_num(b, strlen(b))) < 0 || !(n = next_touch(m, r)) ||
+            !(k = base_step(n, c, sizeof c)) || strcmp(b, c) || k > 4095 || k < -4095)
+            return -1;
+        snprintf(buf, sizeof buf, "%s, [%s], #%d", a, b, k);
+    } else if ((dir = multiple(m, &load, b, sizeof b, &list))) {
+        unsigned regs = regs_in(list);
+        if ((r = reg_num(b, strlen(b))) < 0 || (regs & (1u << r)) || !(n = next_touch(m, r)) ||
+            base_step(n, c, sizeof c) != dir * 4 * popcount(regs) || strcmp(b, c))
+            return -1;
+        snprintf(buf, sizeof buf, "%s!, %s", b, list);
+    } else {
+        return -1;
+    }
+    set_args(m, buf);
+    mlist_remove(l, n);
+    return 1;
+}
+
+/* add rB, rB, #k ; ... ; ldr/str rA, [rB, #0]  ->  ldr/str rA, [rB, #k]!
+ * sub rB, rB, #4n ; ... ; ldmia/stmia rB, {...}  ->  ldmdb/stmdb rB!, {...} */
+static int pre_index(MList *l, MInst *m) {
+    char a[8], b[8], c[8], buf[64];
+    const char *rest, *list;
+    int load, r, k = base_step(m, b, sizeof b);
+    MInst *n;
+    if (!k || (r = reg_num(b, strlen(b))) < 0 || !(n = next_touch(m, r)))
+        return -1;
+    if (!strcmp(n->op, "ldr") || !strcmp(n->op, "str")) {
+        if (!(rest = first_reg(n->args, a, sizeof a)) || !zero_offset(rest, c, sizeof c) ||
+            strcmp(b, c) || !strcmp(a, b) || k > 4095 || k < -4095)
+            return -1;
+        snprintf(buf, sizeof buf, "%s, [%s, #%d]!", a, b, k);
+    } else if (multiple(n, &load, c, sizeof c, &list) == 1 && n->op[4] == 'a' &&
+               !strcmp(b, c) && !(regs_in(list) & (1u << r)) &&
+               k == -4 * popcount(regs_in(list))) {
+        n->op = load ? "ldmdb" : "stmdb";
+        snprintf(buf, sizeof buf, "%s!, %s", b, list);
+    } else {
+        return -1;
+    }
+    set_args(n, buf);
+    mlist_remove(l, m);
+    return 1;
+}
+
+static const struct {
+    const char *name;
+    PeepRule    apply;
+    int         thumb;      // vale também no Thumb
+} rules[] = {
+    { "mov rA, rA",             self_move,  1 },
+    { "str/ldr mesmo endereço", store_load, 1 },
+    { "push/pop",               push_pop,   1 },
+    { "b para o próximo rótulo", jump_next, 1 },
+    { "pós-indexado",           post_index, 0 },
+    { "pré-indexado",           pre_index,  0 },
+};
+
+int peephole(MList *l, int in_thumb) {
+    int removed = 0;
+    thumb = in_thumb;
+    for (MInst *m = l->first, *next; m; m = next) {
+        next = m->next;
+        if (m->kind != MI_INSN)
+            continue;
+        MInst *prev = m->prev;              // as regras só removem de m em diante
+        for (size_t r = 0; r < sizeof rules / sizeof rules[0]; r++) {
+            if (thumb && !rules[r].thumb)
+                continue;
+            int k = rules[r].apply(l, m);
+            if (k >= 0) {
+                removed += k;
+                next = prev ? prev : l->first;  // reexamina a janela anterior
+                break;
+            }
+        }
+    }
+    return removed;
+}
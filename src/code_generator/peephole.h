@@ -0,0 +1,32 @@
+#ifndef PEEPHOLE_H
+#define PEEPHOLE_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/* Código ARM (ou Thumb) já gerado, uma linha do .s por nó: o gerador
+ * acumula a função inteira aqui e o peephole reescreve a lista antes de
+ * ela ir para o arquivo. Textos ficam na arena da compilação. */
+typedef enum { MI_INSN, MI_LABEL, MI_DIRECTIVE } MInstKind;
+
+typedef struct MInst {
+    MInstKind     kind;
+    const char   *op;       // MI_INSN: mnemônico com condição ("ldr", "movgt")
+    const char   *args;     // MI_INSN: operandos; nos demais, a linha inteira
+    struct MInst *prev, *next;
+} MInst;
+
+typedef struct {
+    MInst *first, *last;
+} MList;
+
+void mlist_line(MList *l, const char *line, size_t n); // acrescenta uma linha (sem '\n')
+void mlist_insert(MList *l, MInst *pos, const char *line, size_t n); // idem, logo depois de pos
+int  mlist_write(MList *l, FILE *out);                 // escreve e esvazia; devolve nº de instruções
+
+/* Janela deslizante com as regras da tabela em peephole.c, até não
+ * haver mais mudança. Com 'thumb', só as que servem ao Thumb. Devolve
+ * o nº de instruções removidas. */
+int peephole(MList *l, int thumb);
+
+#endif
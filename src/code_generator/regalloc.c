@@ -0,0 +1,75 @@
+#include "regalloc.h"
+#include <stdlib.h>
+
+#define MAX_REGS 16
+
+static int by_start(const void *a, const void *b) {
+    const LiveInterval *x = *(LiveInterval * const *)a;
+    const LiveInterval *y = *(LiveInterval * const *)b;
+    if (x->start != y->start) return x->start < y->start ? -1 : 1;
+    if (x->end   != y->end)   return x->end   < y->end   ? -1 : 1;
+    return 0;
+}
+
+static int allowed(const LiveInterval *iv, int reg) {
+    return !iv->allow || (iv->allow & (1u << reg));
+}
+
+unsigned linear_scan(LiveInterval **ivs, int n, const int *regs, int nregs) {
+    LiveInterval *active[MAX_REGS];     // ordenados por 'end' crescente
+    int      nactive = 0;
+    unsigned free    = (nregs >= MAX_REGS) ? ~0u : (1u << nregs) - 1; // índices em regs[]
+    unsigned used    = 0;
+
+    qsort(ivs, n, sizeof *ivs, by_start);
+    for (int i = 0; i < n; i++) {
+        LiveInterval *cur = ivs[i];
+
+        // expira intervalos que terminaram antes do início do atual
+        int k = 0;
+        while (k < nactive && active[k]->end < cur->start) {
+            for (int r = 0; r < nregs; r++)
+                if (regs[r] == active[k]->reg)
+                    free |= 1u << r;
+            k++;
+        }
+        for (int j = k; j < nactive; j++)
+            active[j - k] = active[j];
+        nactive -= k;
+
+        int r = 0;
+        while (r < nregs && !((free & (1u << r)) && allowed(cur, regs[r])))
+            r++;
+        if (r < nregs) {
+            free    &= ~(1u << r);
+            cur->reg = regs[r];
+        } else {
+            // derrama quem vive mais: o último ativo cujo registrador serve
+            // ao atual, ou o próprio intervalo
+            int v = nactive - 1;
+            while (v >= 0 && !allowed(cur, active[v]->reg))
+                v--;
+            if (v >= 0 && active[v]->end > cur->end) {
+                LiveInterval *victim = active[v];
+                cur->reg    = victim->reg;
+                victim->reg = -1;
+                for (int j = v + 1; j < nactive; j++)
+                    active[j - 1] = active[j];
+                nactive--;
+            } else {
+                cur->reg = -1;
+                continue;
+            }
+        }
+        used |= 1u << cur->reg;
+
+        // insere mantendo a ordem por 'end'
+        int p = nactive++;
+        while (p > 0 && active[p - 1]->end > cur->end) {
+            active[p] = active[p - 1];
+            p--;
+        }
+        active[p] = cur;
+    }
+    return used;
+}
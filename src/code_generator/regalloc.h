@@ -0,0 +1,19 @@
+#ifndef REGALLOC_H
+#define REGALLOC_H
+
+/* Intervalo de vida de um valor na numeração linear do código:
+ * vivo da posição 'start' até 'end' (inclusive). */
+typedef struct LiveInterval {
+    int start, end;
+    int reg;            // registrador físico escolhido; -1 = fica na memória
+    unsigned allow;     // máscara (1 << reg) dos aceitos; 0 = qualquer um de regs[]
+} LiveInterval;
+
+/* Alocação por varredura linear (Poletto & Sarkar): percorre os intervalos
+ * em ordem de início (reordenando 'ivs' no lugar) e devolve ao conjunto
+ * livre os que já terminaram. Sem registrador livre entre os que 'allow'
+ * aceita, derrama o intervalo que termina mais tarde. Devolve a máscara
+ * (1 << reg) dos registradores usados. */
+unsigned linear_scan(LiveInterval **ivs, int n, const int *regs, int nregs);
+
+#endif
@@ -0,0 +1,63 @@
+#include "intern.h"
+#include "arena.h"
+#include <stdint.h>
+#include <string.h>
+
+// Tabela hash com endereçamento aberto (sondagem linear)
+typedef struct {
+    const char *str;    // NULL = posição livre
+    size_t      len;
+    uint32_t    hash;
+} InternSlot;
+
+static InternSlot *slots;
+static size_t      cap;     // sempre potência de 2
+static size_t      count;
+
+// FNV-1a de 32 bits
+static uint32_t hash_bytes(const char *s, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void rehash(size_t new_cap) {
+    InternSlot *old = slots;
+    size_t old_cap  = cap;
+    slots = arena_calloc(&compile_arena, new_cap * sizeof(InternSlot));
+    cap   = new_cap;
+    for (size_t i = 0; i < old_cap; i++) {
+        if (!old[i].str) continue;
+        size_t j = old[i].hash & (cap - 1);
+        while (slots[j].str)
+            j = (j + 1) & (cap - 1);
+        slots[j] = old[i];
+    }
+}
+
+const char *intern(const char *s, size_t len) {
+    if (4 * (count + 1) > 3 * cap)
+        rehash(cap ? cap * 2 : 256);
+    uint32_t h = hash_bytes(s, len);
+    size_t   i = h & (cap - 1);
+    while (slots[i].str) {
+        if (slots[i].hash == h && slots[i].len == len &&
+            memcmp(slots[i].str, s, len) == 0)
+            return slots[i].str;
+        i = (i + 1) & (cap - 1);
+    }
+    slots[i].str  = arena_strndup(&compile_arena, s, len);
+    slots[i].len  = len;
+    slots[i].hash = h;
+    count++;
+    return slots[i].str;
+}
+
+void intern_reset(void) {
+    slots = NULL;
+    cap   = 0;
+    count = 0;
+}
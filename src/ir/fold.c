@@ -0,0 +1,413 @@
+#include "ir.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Dobramento de constantes e simplificação algébrica sobre a IR.
+ *
+ * Propagação: um vreg com uma única definição 'mov #k' vale k em toda a
+ * função (temporários e locais inicializadas uma vez); os demais só são
+ * conhecidos dentro do bloco, da definição até a próxima redefinição.
+ * Cópias ('mov d, s' entre vregs) também valem só no bloco, enquanto
+ * nem d nem s forem redefinidos: mesmo com uma única definição, s pode
+ * mudar a cada volta de um laço depois da cópia.
+ * Depois de substituir operandos, cada instrução é dobrada ou reescrita
+ * (identidades, x*2^k em shl, x/2^k em shifts, x/k por multiplicação
+ * pelo número mágico, x%k em x - (x/k)*k), desvios com condição
+ * constante viram saltos e definições sem uso somem. Repete até o ponto
+ * fixo. */
+
+#define MAX_ROUNDS 16
+
+static IrFunc *fn;
+static int     nv;              // vregs existentes no início da rodada
+static int    *ndefs, *nuses;
+static char   *gknown;          // constante na função inteira
+static int    *gval;
+static int    *lstamp, *lval;   // constante no bloco (lstamp == bloco atual)
+static int    *cstamp, *csrc;   // cópia de csrc no bloco (cstamp == bloco atual)...
+static int    *cver, *dver;     // ...enquanto a versão de csrc (dver) for cver
+static int     stamp, version;
+
+static int is_imm(Operand o, int v) {
+    return o.kind == OPD_IMM && o.v == v;
+}
+
+static int same_vreg(Operand a, Operand b) {
+    return a.kind == OPD_VREG && b.kind == OPD_VREG && a.v == b.v;
+}
+
+// k se v == 2^k (k >= 1), senão -1
+static int log2_exact(int v) {
+    if (v < 2 || (v & (v - 1)))
+        return -1;
+    int k = 0;
+    while ((1 << k) != v)
+        k++;
+    return k;
+}
+
+static Operand subst(Operand o) {
+    if (o.kind != OPD_VREG || o.v >= nv)
+        return o;
+    if (gknown[o.v])
+        return opd_imm(gval[o.v]);
+    if (lstamp[o.v] == stamp)
+        return opd_imm(lval[o.v]);
+    if (cstamp[o.v] == stamp && dver[csrc[o.v]] == cver[o.v])
+        return opd_vreg(csrc[o.v]);
+    return o;
+}
+
+static void become_mov(IrInst *i, Operand v) {
+    i->op = IR_MOV;
+    i->a  = v;
+    i->b  = opd_none();
+}
+
+// Aritmética em 32 bits com complemento de dois (sem UB do host)
+static int eval(IrOp op, int a, int b, int *out) {
+    unsigned ua = (unsigned)a, ub = (unsigned)b;
+    switch (op) {
+    case IR_ADD: *out = (int)(ua + ub); return 1;
+    case IR_SUB: *out = (int)(ua - ub); return 1;
+    case IR_MUL: *out = (int)(ua * ub); return 1;
+    case IR_DIV:
+        if (b == 0 || (a == INT_MIN && b == -1))
+            return 0;
+        *out = a / b;
+        return 1;
+    case IR_MOD:
+        if (b == 0 || (a == INT_MIN && b == -1))
+            return 0;
+        *out = a % b;
+        return 1;
+    case IR_MULH: *out = (int)(((long long)a * b) >> 32); return 1;
+    case IR_SHL: *out = (int)(ua << (ub & 31)); return 1;
+    case IR_SHR: *out = (int)(ua >> (ub & 31)); return 1;
+    case IR_SAR: *out = a < 0 ? (int)~(~ua >> (ub & 31)) : (int)(ua >> (ub & 31)); return 1;
+    case IR_EQ:  *out = a == b; return 1;
+    case IR_NE:  *out = a != b; return 1;
+    case IR_LT:  *out = a <  b; return 1;
+    case IR_LE:  *out = a <= b; return 1;
+    default:     return 0;
+    }
+}
+
+static int new_before(IrInst *pos, IrBlock *b, IrOp op, Operand x, Operand y) {
+    IrInst *t = ir_insert_before(pos, b, op);
+    t->dst = ir_new_vreg(fn);
+    t->a   = x;
+    t->b   = y;
+    return t->dst;
+}
+
+/* x / ±2^k com truncamento para zero: soma 2^k - 1 aos negativos antes do
+ * deslocamento aritmético.   t = (x >> 31) >>> (32-k);  q = (x + t) >> k */
+static void div_pow2(IrInst *i, IrBlock *b, int k, int neg) {
+    Operand x = i->a;
+    int sign = k == 1 ? -1 : new_before(i, b, IR_SAR, x, opd_imm(31));
+    int bias = new_before(i, b, IR_SHR, sign < 0 ? x : opd_vreg(sign), opd_imm(32 - k));
+    int sum  = new_before(i, b, IR_ADD, x, opd_vreg(bias));
+    if (neg) {
+        int q = new_before(i, b, IR_SAR, opd_vreg(sum), opd_imm(k));
+        i->op = IR_SUB;
+        i->a  = opd_imm(0);
+        i->b  = opd_vreg(q);
+    } else {
+        i->op = IR_SAR;
+        i->a  = opd_vreg(sum);
+        i->b  = opd_imm(k);
+    }
+}
+
+/* x / d para d constante (|d| >= 2, sem ser potência de 2), pelo número
+ * mágico M de Hacker's Delight (10-1): q = mulh(x, M), corrigido por ±x
+ * quando o sinal de M difere do de d, deslocado de s e somado de 1 se
+ * negativo (trunca para zero). */
+static void div_magic(IrInst *i, IrBlock *b, int d) {
+    const unsigned two31 = 0x80000000u;
+    unsigned ad  = d < 0 ? -(unsigned)d : (unsigned)d;
+    unsigned t   = two31 + ((unsigned)d >> 31);
+    unsigned anc = t - 1 - t % ad;
+    unsigned q1 = two31 / anc, r1 = two31 - q1 * anc;
+    unsigned q2 = two31 / ad,  r2 = two31 - q2 * ad, delta;
+    int p = 31;
+    do {
+        p++;
+        q1 *= 2; r1 *= 2;
+        if (r1 >= anc) { q1++; r1 -= anc; }
+        q2 *= 2; r2 *= 2;
+        if (r2 >= ad)  { q2++; r2 -= ad; }
+        delta = ad - r2;
+    } while (q1 < delta || (q1 == delta && r1 == 0));
+    int m = (int)(q2 + 1), s = p - 32;
+    if (d < 0)
+        m = (int)-(unsigned)m;
+
+    Operand x = i->a;
+    int q = new_before(i, b, IR_MULH, x, opd_imm(m));
+    if (d > 0 && m < 0) q = new_before(i, b, IR_ADD, opd_vreg(q), x);
+    if (d < 0 && m > 0) q = new_before(i, b, IR_SUB, opd_vreg(q), x);
+    if (s > 0)          q = new_before(i, b, IR_SAR, opd_vreg(q), opd_imm(s));
+    int sign = new_before(i, b, IR_SHR, opd_vreg(q), opd_imm(31));
+    i->op = IR_ADD;
+    i->a  = opd_vreg(q);
+    i->b  = opd_vreg(sign);
+}
+
+// Simplifica uma instrução cujos operandos já foram substituídos
+static int simplify(IrInst *i, IrBlock *b) {
+    Operand a = i->a, c = i->b;
+    int v, k;
+    switch (i->op) {
+    case IR_ADD: case IR_SUB: case IR_MUL: case IR_DIV: case IR_MOD: case IR_MULH:
+    case IR_SHL: case IR_SAR: case IR_SHR:
+    case IR_EQ:  case IR_NE:  case IR_LT:  case IR_LE:
+        if (a.kind == OPD_IMM && c.kind == OPD_IMM && eval(i->op, a.v, c.v, &v)) {
+            become_mov(i, opd_imm(v));
+            return 1;
+        }
+        break;
+    default:
+        return 0;
+    }
+
+    // operações comutativas: a constante vai para a direita
+    if ((i->op == IR_ADD || i->op == IR_MUL || i->op == IR_EQ || i->op == IR_NE) &&
+        a.kind == OPD_IMM && c.kind != OPD_IMM) {
+        i->a = c;
+        i->b = a;
+        a = i->a;
+        c = i->b;
+    }
+
+    switch (i->op) {
+    case IR_ADD:
+        if (is_imm(c, 0)) { become_mov(i, a); return 1; }
+        break;
+    case IR_SUB:
+        if (is_imm(c, 0))      { become_mov(i, a); return 1; }
+        if (same_vreg(a, c))   { become_mov(i, opd_imm(0)); return 1; }
+        break;
+    case IR_MUL:
+        if (is_imm(c, 0)) { become_mov(i, opd_imm(0)); return 1; }
+        if (is_imm(c, 1)) { become_mov(i, a); return 1; }
+        if (is_imm(c, -1)) {
+            i->op = IR_SUB;
+            i->a  = opd_imm(0);
+            i->b  = a;
+            return 1;
+        }
+        if (c.kind == OPD_IMM && (k = log2_exact(c.v)) > 0) {
+            i->op = IR_SHL;
+            i->b  = opd_imm(k);
+            return 1;
+        }
+        break;
+    case IR_DIV:
+        if (is_imm(c, 1)) { become_mov(i, a); return 1; }
+        if (is_imm(c, -1)) {
+            i->op = IR_SUB;
+            i->a  = opd_imm(0);
+            i->b  = a;
+            return 1;
+        }
+        if (a.kind == OPD_VREG && c.kind == OPD_IMM) {
+            if ((k = log2_exact(c.v)) > 0) {
+                div_pow2(i, b, k, 0);
+                return 1;
+            }
+            if (c.v != INT_MIN && (k = log2_exact(-c.v)) > 0) {
+                div_pow2(i, b, k, 1);
+                return 1;
+            }
+            if (c.v != 0) {
+                div_magic(i, b, c.v);
+                return 1;
+            }
+        }
+        break;
+    case IR_MOD:
+        if (is_imm(c, 1) || is_imm(c, -1)) { become_mov(i, opd_imm(0)); return 1; }
+        if (a.kind == OPD_VREG && c.kind == OPD_IMM && c.v != 0) {
+            // x - (x/k)*k: a divisão e o produto são reescritos na próxima rodada
+            int q = new_before(i, b, IR_DIV, a, c);
+            int m = new_before(i, b, IR_MUL, opd_vreg(q), c);
+            i->op = IR_SUB;
+            i->b  = opd_vreg(m);
+            return 1;
+        }
+        break;
+    case IR_SHL: case IR_SAR: case IR_SHR:
+        if (is_imm(c, 0)) { become_mov(i, a); return 1; }
+        break;
+    case IR_EQ: case IR_LE:
+        if (same_vreg(a, c)) { become_mov(i, opd_imm(1)); return 1; }
+        break;
+    case IR_NE: case IR_LT:
+        if (same_vreg(a, c)) { become_mov(i, opd_imm(0)); return 1; }
+        break;
+    default:
+        break;
+    }
+    return 0;
+}
+
+static void count(void) {
+    memset(ndefs, 0, sizeof(int) * nv);
+    memset(nuses, 0, sizeof(int) * nv);
+    for (IrBlock *b = fn->entry; b; b = b->next)
+        for (IrInst *i = b->first; i; i = i->next) {
+            if (i->dst >= 0) ndefs[i->dst]++;
+            if (i->a.kind == OPD_VREG) nuses[i->a.v]++;
+            if (i->b.kind == OPD_VREG) nuses[i->b.v]++;
+            for (int k = 0; k < i->nargs; k++)
+                if (i->args[k].kind == OPD_VREG)
+                    nuses[i->args[k].v]++;
+        }
+}
+
+// Desvio de resultado conhecido: duas constantes ou o mesmo vreg dos dois lados
+static int branch_known(const IrInst *i, int *v) {
+    if (i->a.kind == OPD_IMM && i->b.kind == OPD_IMM)
+        return eval(i->cc, i->a.v, i->b.v, v);
+    if (same_vreg(i->a, i->b)) {
+        *v = i->cc == IR_EQ || i->cc == IR_LE;
+        return 1;
+    }
+    return 0;
+}
+
+// Uma rodada de propagação + simplificação; devolve se algo mudou
+static int propagate(int *branches) {
+    int changed = 0, v;
+    memset(gknown, 0, nv);
+    for (IrBlock *b = fn->entry; b; b = b->next)
+        for (IrInst *i = b->first; i; i = i->next)
+            if (i->op == IR_MOV && i->a.kind == OPD_IMM && ndefs[i->dst] == 1) {
+                gknown[i->dst] = 1;
+                gval[i->dst]   = i->a.v;
+            }
+    for (IrBlock *b = fn->entry; b; b = b->next) {
+        stamp++;
+        for (IrInst *i = b->first; i; i = i->next) {
+            Operand a = subst(i->a), c = subst(i->b);
+            if (a.kind != i->a.kind || a.v != i->a.v || c.kind != i->b.kind || c.v != i->b.v)
+                changed = 1;
+            i->a = a;
+            i->b = c;
+            for (int k = 0; k < i->nargs; k++) {
+                Operand x = subst(i->args[k]);
+                changed |= x.kind != i->args[k].kind || x.v != i->args[k].v;
+                i->args[k] = x;
+            }
+            changed |= simplify(i, b);
+
+            if (i->op == IR_BR && branch_known(i, &v)) {
+                if (!v)
+                    i->target = i->target2;
+                i->op = IR_JMP;
+                i->a  = opd_none();
+                i->b  = opd_none();
+                *branches = changed = 1;
+            }
+            if (i->dst >= 0 && i->dst < nv) {
+                dver[i->dst] = ++version;
+                lstamp[i->dst] = cstamp[i->dst] = 0;
+                if (i->op == IR_MOV && i->a.kind == OPD_IMM) {
+                    lstamp[i->dst] = stamp;
+                    lval[i->dst]   = i->a.v;
+                } else if (i->op == IR_MOV && i->a.kind == OPD_VREG &&
+                           i->a.v != i->dst && i->a.v < nv) {
+                    cstamp[i->dst] = stamp;
+                    csrc[i->dst]   = i->a.v;
+                    cver[i->dst]   = dver[i->a.v];
+                }
+            }
+        }
+    }
+    return changed;
+}
+
+// Remove definições puras sem uso (inclusive cópias de um vreg nele mesmo)
+static int dead_code(void) {
+    int changed = 0, again = 1;
+    if (fn->nvregs > nv) {      // a redução de força criou vregs
+        nv    = fn->nvregs;
+        ndefs = realloc(ndefs, sizeof(int) * nv);
+        nuses = realloc(nuses, sizeof(int) * nv);
+        if (!ndefs || !nuses) {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    while (again) {
+        again = 0;
+        count();
+        for (IrBlock *b = fn->entry; b; b = b->next)
+            for (IrInst *i = b->first, *nx; i; i = nx) {
+                nx = i->next;
+                int self = i->op == IR_MOV && i->a.kind == OPD_VREG && i->a.v == i->dst;
+                if (i->dst < 0 || (!self && nuses[i->dst]))
+                    continue;
+                if (i->op == IR_CALL) {         // a chamada fica, o valor não
+                    if (!nuses[i->dst])
+                        i->dst = -1;
+                    continue;
+                }
+                if (ir_has_side_effect(i))
+                    continue;
+                ir_remove(b, i);
+                again = changed = 1;
+            }
+    }
+    return changed;
+}
+
+void ir_fold(IrFunc *f) {
+    fn = f;
+    for (int round = 0; round < MAX_ROUNDS; round++) {
+        nv     = f->nvregs;
+        int n  = nv ? nv : 1;
+        ndefs  = calloc(n, sizeof(int));
+        nuses  = calloc(n, sizeof(int));
+        gknown = calloc(n, 1);
+        gval   = calloc(n, sizeof(int));
+        lstamp = calloc(n, sizeof(int));
+        lval   = calloc(n, sizeof(int));
+        cstamp = calloc(n, sizeof(int));
+        csrc   = calloc(n, sizeof(int));
+        cver   = calloc(n, sizeof(int));
+        dver   = calloc(n, sizeof(int));
+        if (!ndefs || !nuses || !gknown || !gval || !lstamp || !lval ||
+            !cstamp || !csrc || !cver || !dver) {
+            perror("calloc");
+            exit(1);
+        }
+        stamp   = 0;
+        version = 0;
+        count();
+        int branches = 0;
+        int changed  = propagate(&branches);
+        changed |= dead_code();
+        free(ndefs); free(nuses); free(gknown);
+        free(gval);  free(lstamp); free(lval);
+        free(cstamp); free(csrc); free(cver); free(dver);
+        if (branches)           // blocos podem ter ficado inalcançáveis
+            ir_cleanup(f);
+        if (!changed)
+            break;
+    }
+}
+
+void ir_optimize(IrProgram *p) {
+    for (IrFunc *f = p->funcs; f; f = f->next)
+        ir_fold(f);
+    ir_inline(p);               // mede os callees já dobrados
+    for (IrFunc *f = p->funcs; f; f = f->next) {
+        ir_tailcall(f);
+        ir_fold(f);
+        ir_loop(f);             // depois da cauda: os laços que ela criou também contam
+    }
+}
@@ -0,0 +1,227 @@
+#include "ir.h"
+#include "arena.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Inlining de funções pequenas sobre a IR.
+ *
+ * O grafo de chamadas é dividido em componentes fortemente conexas
+ * (Tarjan); uma função que está num ciclo (fatorial chamando a si
+ * mesma, ou f -> g -> f) é recursiva e nunca é expandida. As demais
+ * são expandidas nos pontos de chamada quando o corpo tem no máximo
+ * ir_inline_limit instruções. As componentes saem do Tarjan das folhas
+ * para a raiz, então cada função recebe as chamadas já expandidas dos
+ * seus callees antes de ser medida e copiada. */
+
+int ir_inline_limit = 20;
+
+static IrFunc **funcs;          // funções por índice
+static int      nfuncs;
+static char    *recursive;      // recursive[k]: k está num ciclo
+static int     *order;          // índices em ordem de callees antes de callers
+static int      norder;
+
+// Nomes internados: a busca compara ponteiros
+static int func_index(const char *name) {
+    for (int k = 0; k < nfuncs; k++)
+        if (funcs[k]->name == name)
+            return k;
+    return -1;                  // externa (__aeabi_idiv, biblioteca)
+}
+
+/* ------------------------------------------------------------------ */
+/* Componentes fortemente conexas (Tarjan)                             */
+/* ------------------------------------------------------------------ */
+
+static int *tindex, *low, *stack, *on_stack;
+static int  next_index, sp;
+
+static void strongconnect(int v) {
+    tindex[v] = low[v] = next_index++;
+    stack[sp++] = v;
+    on_stack[v] = 1;
+    for (IrBlock *b = funcs[v]->entry; b; b = b->next)
+        for (IrInst *i = b->first; i; i = i->next) {
+            if (i->op != IR_CALL) continue;
+            int w = func_index(i->sym);
+            if (w < 0) continue;
+            if (w == v)
+                recursive[v] = 1;
+            if (tindex[w] < 0) {
+                strongconnect(w);
+                if (low[w] < low[v]) low[v] = low[w];
+            } else if (on_stack[w] && tindex[w] < low[v]) {
+                low[v] = tindex[w];
+            }
+        }
+    if (low[v] != tindex[v])
+        return;
+    int first = sp;             // desempilha a componente de v
+    do {
+        first--;
+        on_stack[stack[first]] = 0;
+    } while (stack[first] != v);
+    for (int k = first; k < sp; k++) {
+        if (sp - first > 1)
+            recursive[stack[k]] = 1;
+        order[norder++] = stack[k];
+    }
+    sp = first;
+}
+
+/* ------------------------------------------------------------------ */
+/* Expansão                                                            */
+/* ------------------------------------------------------------------ */
+
+static int func_size(const IrFunc *f) {
+    int n = 0;
+    for (IrBlock *b = f->entry; b; b = b->next)
+        for (IrInst *i = b->first; i; i = i->next)
+            if (i->op != IR_PARAM)
+                n++;
+    return n;
+}
+
+static Operand remap(Operand o, int vbase) {
+    return o.kind == OPD_VREG ? opd_vreg(o.v + vbase) : o;
+}
+
+/* Troca 'call' (no bloco b de f) por uma cópia do corpo de g:
+ *   b: ...; jmp g.entry'      g': PARAM k -> mov de args[k]
+ *                                 ret x   -> mov dst, x; jmp cont
+ *   cont: o resto de b
+ * vregs e slots de g são renumerados depois dos de f. */
+static void expand(IrFunc *f, IrBlock *b, IrInst *call, IrFunc *g) {
+    int vbase = f->nvregs, sbase = f->nslots;
+    f->nvregs += g->nvregs;
+    f->nslots += g->nslots;
+
+    IrBlock *cont = ir_new_block(f);
+    if (call->next) {
+        cont->first = call->next;
+        cont->last  = b->last;
+        cont->first->prev = NULL;
+        b->last = call;
+        call->next = NULL;
+    }
+    ir_remove(b, call);
+
+    IrBlock **map = calloc(g->nblocks, sizeof *map);
+    if (!map) {
+        perror("calloc");
+        exit(1);
+    }
+    IrBlock *pos = b;
+    for (IrBlock *gb = g->entry; gb; gb = gb->next) {
+        map[gb->id] = ir_new_block(f);
+        ir_place_after(f, pos, map[gb->id]);
+        pos = map[gb->id];
+    }
+    ir_place_after(f, pos, cont);
+    ir_append(b, IR_JMP)->target = map[g->entry->id];
+
+    for (IrBlock *gb = g->entry; gb; gb = gb->next) {
+        IrBlock *nb = map[gb->id];
+        for (IrInst *gi = gb->first; gi; gi = gi->next) {
+            IrInst *i;
+            switch (gi->op) {
+            case IR_PARAM:
+                i = ir_append(nb, IR_MOV);
+                i->dst = gi->dst + vbase;
+                i->a   = gi->imm < call->nargs ? call->args[gi->imm] : opd_imm(0);
+                break;
+            case IR_RET:
+                if (call->dst >= 0) {
+                    i = ir_append(nb, IR_MOV);
+                    i->dst = call->dst;
+                    i->a   = gi->a.kind != OPD_NONE ? remap(gi->a, vbase) : opd_imm(0);
+                }
+                ir_append(nb, IR_JMP)->target = cont;
+                break;
+            default: {
+                i = ir_append(nb, gi->op);
+                IrInst *prev = i->prev;
+                *i = *gi;
+                i->prev = prev;
+                i->next = NULL;
+                if (i->dst >= 0)
+                    i->dst += vbase;
+                i->a = remap(i->a, vbase);
+                i->b = remap(i->b, vbase);
+                if (i->nargs) {
+                    i->args = arena_alloc(&compile_arena, sizeof(Operand) * i->nargs);
+                    for (int k = 0; k < i->nargs; k++)
+                        i->args[k] = remap(gi->args[k], vbase);
+                }
+                if (i->op == IR_ADDR_LOCAL || i->op == IR_LOAD_LOCAL || i->op == IR_STORE_LOCAL)
+                    i->imm += sbase;
+                if (i->target)  i->target  = map[i->target->id];
+                if (i->target2) i->target2 = map[i->target2->id];
+            }
+            }
+        }
+    }
+    free(map);
+}
+
+// Expande em f todas as chamadas elegíveis; devolve se algo mudou
+static int inline_into(IrFunc *f) {
+    int changed = 0;
+    for (IrBlock *b = f->entry; b; b = b->next)
+        for (IrInst *i = b->first; i; i = i->next) {
+            if (i->op != IR_CALL) continue;
+            int k = func_index(i->sym);
+            if (k < 0 || recursive[k] || funcs[k] == f ||
+                func_size(funcs[k]) > ir_inline_limit)
+                continue;
+            expand(f, b, i, funcs[k]);
+            changed = 1;
+            break;              // o resto de b agora está no bloco de continuação
+        }
+    return changed;
+}
+
+void ir_inline(IrProgram *p) {
+    nfuncs = 0;
+    for (IrFunc *f = p->funcs; f; f = f->next)
+        nfuncs++;
+    if (!nfuncs || ir_inline_limit <= 0)
+        return;
+    funcs     = malloc(sizeof *funcs * nfuncs);
+    recursive = calloc(nfuncs, 1);
+    order     = malloc(sizeof *order * nfuncs);
+    tindex    = malloc(sizeof *tindex * nfuncs);
+    low       = malloc(sizeof *low * nfuncs);
+    stack     = malloc(sizeof *stack * nfuncs);
+    on_stack  = calloc(nfuncs, sizeof *on_stack);
+    if (!funcs || !recursive || !order || !tindex || !low || !stack || !on_stack) {
+        perror("malloc");
+        exit(1);
+    }
+    int k = 0;
+    for (IrFunc *f = p->funcs; f; f = f->next) {
+        funcs[k]  = f;
+        tindex[k++] = -1;
+    }
+    norder = next_index = sp = 0;
+    for (k = 0; k < nfuncs; k++)
+        if (tindex[k] < 0)
+            strongconnect(k);
+
+    for (k = 0; k < norder; k++) {
+        IrFunc *f = funcs[order[k]];
+        if (inline_into(f)) {
+            ir_cleanup(f);
+            ir_fold(f);
+        }
+    }
+
+    free(funcs);
+    free(recursive);
+    free(order);
+    free(tindex);
+    free(low);
+    free(stack);
+    free(on_stack);
+}
@@ -0,0 +1,395 @@
+#include "ir.h"
+#include "arena.h"
+#include <string.h>
+
+/* ------------------------------------------------------------------ */
+/* Construção                                                          */
+/* ------------------------------------------------------------------ */
+
+IrFunc *ir_new_func(const char *name, int nparams) {
+    IrFunc *f  = arena_calloc(&compile_arena, sizeof(IrFunc));
+    f->name    = name;
+    f->nparams = nparams;
+    return f;
+}
+
+IrBlock *ir_new_block(IrFunc *f) {
+    IrBlock *b = arena_calloc(&compile_arena, sizeof(IrBlock));
+    b->id = f->nblocks++;
+    return b;
+}
+
+void ir_place_block(IrFunc *f, IrBlock *b) {
+    if (f->last) f->last->next = b;
+    else         f->entry      = b;
+    f->last = b;
+}
+
+void ir_place_after(IrFunc *f, IrBlock *pos, IrBlock *b) {
+    b->next   = pos->next;
+    pos->next = b;
+    if (f->last == pos)
+        f->last = b;
+}
+
+int ir_new_vreg(IrFunc *f) {
+    return f->nvregs++;
+}
+
+static IrInst *new_inst(IrOp op) {
+    IrInst *i = arena_calloc(&compile_arena, sizeof(IrInst));
+    i->op  = op;
+    i->dst = -1;
+    return i;
+}
+
+IrInst *ir_append(IrBlock *b, IrOp op) {
+    IrInst *i = new_inst(op);
+    i->prev = b->last;
+    if (b->last) b->last->next = i;
+    else         b->first      = i;
+    b->last = i;
+    return i;
+}
+
+IrInst *ir_insert_before(IrInst *pos, IrBlock *b, IrOp op) {
+    if (!pos)
+        return ir_append(b, op);
+    IrInst *i = new_inst(op);
+    i->next = pos;
+    i->prev = pos->prev;
+    if (pos->prev) pos->prev->next = i;
+    else           b->first        = i;
+    pos->prev = i;
+    return i;
+}
+
+void ir_remove(IrBlock *b, IrInst *i) {
+    if (i->prev) i->prev->next = i->next;
+    else         b->first      = i->next;
+    if (i->next) i->next->prev = i->prev;
+    else         b->last       = i->prev;
+}
+
+int ir_is_terminator(IrOp op) {
+    return op == IR_JMP || op == IR_BR || op == IR_RET || op == IR_TAILCALL;
+}
+
+int ir_has_side_effect(const IrInst *i) {
+    switch (i->op) {
+    case IR_STORE: case IR_STORE_LOCAL: case IR_CALL:
+    case IR_JMP: case IR_BR: case IR_RET: case IR_TAILCALL:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/* Grafo de fluxo                                                      */
+/* ------------------------------------------------------------------ */
+
+void ir_build_cfg(IrFunc *f) {
+    for (IrBlock *b = f->entry; b; b = b->next) {
+        b->nsucc = 0;
+        b->npred = 0;
+    }
+    for (IrBlock *b = f->entry; b; b = b->next) {
+        IrInst *t = b->last;
+        if (t && (t->op == IR_JMP || t->op == IR_BR))
+            b->succ[b->nsucc++] = t->target;
+        if (t && t->op == IR_BR && t->target2 != t->target)
+            b->succ[b->nsucc++] = t->target2;
+        for (int k = 0; k < b->nsucc; k++)
+            b->succ[k]->npred++;
+    }
+    for (IrBlock *b = f->entry; b; b = b->next) {
+        b->pred  = b->npred ? arena_alloc(&compile_arena, sizeof(IrBlock*) * b->npred) : NULL;
+        b->npred = 0;
+    }
+    for (IrBlock *b = f->entry; b; b = b->next)
+        for (int k = 0; k < b->nsucc; k++)
+            b->succ[k]->pred[b->succ[k]->npred++] = b;
+}
+
+/* Blocos alcançáveis a partir de entry, com uma pilha explícita (cada
+ * bloco entra uma vez): funções geradas longas não estouram a pilha */
+static void mark_reachable(IrFunc *f, char *seen) {
+    IrBlock **work = arena_alloc(&compile_arena, sizeof(IrBlock*) * f->nblocks);
+    int n = 0;
+    seen[f->entry->id] = 1;
+    work[n++] = f->entry;
+    while (n > 0) {
+        IrBlock *b = work[--n];
+        for (int k = 0; k < b->nsucc; k++)
+            if (!seen[b->succ[k]->id]) {
+                seen[b->succ[k]->id] = 1;
+                work[n++] = b->succ[k];
+            }
+    }
+}
+
+/* Destino final de uma cadeia de blocos que só contêm 'goto'. 'visit'
+ * marca com 'walk' os blocos já vistos nesta cadeia: num ciclo só de
+ * saltos (laço vazio infinito) a busca para no bloco que repetiu. */
+static IrBlock *skip_empty(IrBlock *b, int *visit, int walk) {
+    while (b->first && b->first == b->last && b->first->op == IR_JMP &&
+           visit[b->id] != walk) {
+        visit[b->id] = walk;
+        b = b->first->target;
+    }
+    return b;
+}
+
+void ir_cleanup(IrFunc *f) {
+    // saltos para blocos vazios vão direto ao destino final
+    int *visit = arena_calloc(&compile_arena, sizeof(int) * f->nblocks);
+    int  walk  = 0;
+    for (IrBlock *b = f->entry; b; b = b->next) {
+        IrInst *t = b->last;
+        if (!t) continue;
+        if (t->op == IR_JMP || t->op == IR_BR)
+            t->target = skip_empty(t->target, visit, ++walk);
+        if (t->op == IR_BR)
+            t->target2 = skip_empty(t->target2, visit, ++walk);
+        if (t->op == IR_BR && t->target == t->target2) {
+            t->op = IR_JMP;     // os dois lados iguais: desvio incondicional
+            t->a  = opd_none();
+            t->b  = opd_none();
+        }
+    }
+    ir_build_cfg(f);
+
+    // remove blocos inalcançáveis a partir da entrada
+    char *seen = arena_calloc(&compile_arena, f->nblocks);
+    mark_reachable(f, seen);
+    for (IrBlock *b = f->entry; b && b->next; ) {
+        if (!seen[b->next->id]) b->next = b->next->next;
+        else                    b = b->next;
+    }
+
+    // funde bloco com seu único sucessor quando este só tem um predecessor
+    ir_build_cfg(f);
+    for (IrBlock *b = f->entry; b; b = b->next) {
+        for (;;) {
+            IrInst *t = b->last;
+            if (!t || t->op != IR_JMP) break;
+            IrBlock *s = t->target;
+            if (s == b || s == f->entry || s->npred != 1) break;
+            ir_remove(b, t);
+            for (IrInst *i = s->first, *nx; i; i = nx) {
+                nx = i->next;
+                i->prev = b->last;
+                i->next = NULL;
+                if (b->last) b->last->next = i;
+                else         b->first      = i;
+                b->last = i;
+            }
+            s->first = s->last = NULL;
+            b->nsucc = s->nsucc;
+            for (int k = 0; k < s->nsucc; k++) {
+                b->succ[k] = s->succ[k];
+                for (int p = 0; p < s->succ[k]->npred; p++)
+                    if (s->succ[k]->pred[p] == s)
+                        s->succ[k]->pred[p] = b;
+            }
+            // retira s do layout
+            for (IrBlock *p = f->entry; p; p = p->next)
+                if (p->next == s) {
+                    p->next = s->next;
+                    break;
+                }
+        }
+    }
+    for (f->last = f->entry; f->last->next; f->last = f->last->next)
+        ;
+    ir_build_cfg(f);
+}
+
+/* ------------------------------------------------------------------ */
+/* Vivacidade                                                          */
+/* ------------------------------------------------------------------ */
+
+// Vregs lidos por uma instrução; devolve quantos foram escritos em 'out'
+static int inst_uses(const IrInst *i, int *out, int max) {
+    int n = 0;
+    if (i->a.kind == OPD_VREG && n < max) out[n++] = i->a.v;
+    if (i->b.kind == OPD_VREG && n < max) out[n++] = i->b.v;
+    if (i->c.kind == OPD_VREG && n < max) out[n++] = i->c.v;
+    for (int k = 0; k < i->nargs; k++)
+        if (i->args[k].kind == OPD_VREG && n < max)
+            out[n++] = i->args[k].v;
+    return n;
+}
+
+void ir_liveness(IrFunc *f) {
+    int w = bs_words(f->nvregs);
+    int nb = 0;
+    for (IrBlock *b = f->entry; b; b = b->next)
+        nb++;
+    IrBlock **order = arena_alloc(&compile_arena, sizeof(IrBlock*) * (nb ? nb : 1));
+    unsigned *gen   = arena_calloc(&compile_arena, sizeof(unsigned) * w * (nb ? nb : 1));
+    unsigned *kill  = arena_calloc(&compile_arena, sizeof(unsigned) * w * (nb ? nb : 1));
+    int *uses = NULL, ucap = 0;
+
+    int k = 0;
+    for (IrBlock *b = f->entry; b; b = b->next, k++) {
+        order[k]    = b;
+        b->live_in  = arena_calloc(&compile_arena, sizeof(unsigned) * (w ? w : 1));
+        b->live_out = arena_calloc(&compile_arena, sizeof(unsigned) * (w ? w : 1));
+        unsigned *g = gen + k * w, *d = kill + k * w;
+        for (IrInst *i = b->first; i; i = i->next) {
+            int need = 3 + i->nargs;
+            if (need > ucap) {
+                ucap = need * 2;
+                uses = arena_alloc(&compile_arena, sizeof(int) * ucap);
+            }
+            int n = inst_uses(i, uses, ucap);
+            for (int u = 0; u < n; u++)
+                if (!bs_has(d, uses[u]))
+                    bs_add(g, uses[u]);
+            if (i->dst >= 0)
+                bs_add(d, i->dst);
+        }
+    }
+
+    // ponto fixo, de trás para frente
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int j = nb - 1; j >= 0; j--) {
+            IrBlock *b = order[j];
+            for (int s = 0; s < b->nsucc; s++)
+                for (int x = 0; x < w; x++)
+                    b->live_out[x] |= b->succ[s]->live_in[x];
+            for (int x = 0; x < w; x++) {
+                unsigned in = gen[j * w + x] | (b->live_out[x] & ~kill[j * w + x]);
+                if (in != b->live_in[x]) {
+                    b->live_in[x] = in;
+                    changed = 1;
+                }
+            }
+        }
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/* Impressão                                                           */
+/* ------------------------------------------------------------------ */
+
+static const char *op_name[] = {
+    [IR_MOV] = "mov", [IR_PARAM] = "param", [IR_ADD] = "add", [IR_SUB] = "sub",
+    [IR_MUL] = "mul", [IR_DIV] = "div", [IR_MOD] = "mod", [IR_MULH] = "mulh",
+    [IR_SHL] = "shl", [IR_SAR] = "sar", [IR_SHR] = "shr", [IR_EQ] = "eq", [IR_NE] = "ne",
+    [IR_LT] = "lt", [IR_LE] = "le", [IR_ADDR_LOCAL] = "addr", [IR_ADDR_GLOBAL] = "addr",
+    [IR_LOAD] = "load", [IR_STORE] = "store",
+    [IR_LOAD_LOCAL] = "load", [IR_STORE_LOCAL] = "store", [IR_CALL] = "call",
+    [IR_JMP] = "jmp", [IR_BR] = "br", [IR_RET] = "ret", [IR_TAILCALL] = "tailcall",
+    [IR_RSB] = "rsb", [IR_MLA] = "mla",
+};
+
+static void dump_opd(FILE *out, Operand o) {
+    if (o.kind == OPD_VREG) fprintf(out, "%%%d", o.v);
+    else if (o.kind == OPD_IMM) fprintf(out, "%d", o.v);
+}
+
+// Índice de LOAD/STORE depois da seleção de instruções: " + %c shl k"
+static void dump_index(FILE *out, const IrInst *i) {
+    if (i->c.kind == OPD_NONE)
+        return;
+    fprintf(out, " + ");
+    dump_opd(out, i->c);
+    if (i->shamt)
+        fprintf(out, " %s %d", op_name[i->shop], i->shamt);
+}
+
+static void dump_inst(FILE *out, const IrInst *i) {
+    fprintf(out, "    ");
+    if (i->dst >= 0)
+        fprintf(out, "%%%d = ", i->dst);
+    fprintf(out, "%s", op_name[i->op]);
+    switch (i->op) {
+    case IR_PARAM:
+        fprintf(out, " %d", i->imm);
+        break;
+    case IR_ADDR_LOCAL:
+    case IR_LOAD_LOCAL:
+        fprintf(out, " slot%d", i->imm);
+        break;
+    case IR_STORE_LOCAL:
+        fprintf(out, " slot%d, ", i->imm);
+        dump_opd(out, i->b);
+        break;
+    case IR_ADDR_GLOBAL:
+        fprintf(out, " @%s", i->sym);
+        break;
+    case IR_LOAD:
+        fprintf(out, " [");
+        dump_opd(out, i->a);
+        dump_index(out, i);
+        fprintf(out, " + %d]", i->imm);
+        break;
+    case IR_STORE:
+        fprintf(out, " [");
+        dump_opd(out, i->a);
+        dump_index(out, i);
+        fprintf(out, " + %d], ", i->imm);
+        dump_opd(out, i->b);
+        break;
+    case IR_CALL:
+    case IR_TAILCALL:
+        fprintf(out, " @%s(", i->sym);
+        for (int k = 0; k < i->nargs; k++) {
+            if (k) fprintf(out, ", ");
+            dump_opd(out, i->args[k]);
+        }
+        fprintf(out, ")");
+        break;
+    case IR_JMP:
+        fprintf(out, " b%d", i->target->id);
+        break;
+    case IR_BR:
+        fprintf(out, " %s ", op_name[i->cc]);
+        dump_opd(out, i->a);
+        fprintf(out, ", ");
+        dump_opd(out, i->b);
+        fprintf(out, ", b%d, b%d", i->target->id, i->target2->id);
+        break;
+    default:
+        if (i->a.kind != OPD_NONE) {
+            fprintf(out, " ");
+            dump_opd(out, i->a);
+        }
+        if (i->b.kind != OPD_NONE) {
+            fprintf(out, ", ");
+            dump_opd(out, i->b);
+            if (i->shamt)
+                fprintf(out, " %s %d", op_name[i->shop], i->shamt);
+        }
+        if (i->c.kind != OPD_NONE) {
+            fprintf(out, ", ");
+            dump_opd(out, i->c);
+        }
+        break;
+    }
+    fprintf(out, "\n");
+}
+
+void ir_dump(IrProgram *p, FILE *out) {
+    for (IrGlobal *g = p->globals; g; g = g->next)
+        fprintf(out, "global @%s = %d\n", g->name, g->has_init ? g->init : 0);
+    for (IrFunc *f = p->funcs; f; f = f->next) {
+        fprintf(out, "\nfunc @%s(%d params, %d slots)\n", f->name, f->nparams, f->nslots);
+        for (IrBlock *b = f->entry; b; b = b->next) {
+            fprintf(out, "  b%d:", b->id);
+            if (b->npred) {
+                fprintf(out, "    ; preds:");
+                for (int k = 0; k < b->npred; k++)
+                    fprintf(out, " b%d", b->pred[k]->id);
+            }
+            fprintf(out, "\n");
+            for (IrInst *i = b->first; i; i = i->next)
+                dump_inst(out, i);
+        }
+    }
+}
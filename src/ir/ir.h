@@ -0,0 +1,161 @@
+#ifndef IR_H
+#define IR_H
+
+#include <stdio.h>
+#include "../parser/parser.h"
+
+/* IR de três endereços entre a semântica e o gerador de código.
+ *
+ * Cada função é um grafo de blocos básicos; cada bloco é uma lista de
+ * instruções terminada por IR_JMP, IR_BR ou IR_RET. Valores vivem em
+ * registradores virtuais (vregs) ilimitados: temporários das expressões
+ * e também as locais escalares sem '&', que podem receber várias
+ * definições (a IR não é SSA). Locais com endereço tomado moram em slots
+ * de 4 bytes do quadro (IR_LOAD_LOCAL/IR_STORE_LOCAL); o resto da memória
+ * é acessado por endereço com IR_LOAD/IR_STORE. */
+
+typedef enum {
+    IR_MOV,         // dst = a
+    IR_PARAM,       // dst = parâmetro nº imm (início do bloco de entrada)
+    IR_ADD,         // dst = a + b
+    IR_SUB,         // dst = a - b
+    IR_MUL,         // dst = a * b
+    IR_DIV,         // dst = a / b (com sinal, trunca para zero)
+    IR_MOD,         // dst = a % b (sinal do dividendo)
+    IR_MULH,        // dst = (a * b) >> 32: metade alta do produto de 64 bits com sinal
+    IR_SHL,         // dst = a << b
+    IR_SAR,         // dst = a >> b (aritmético)
+    IR_SHR,         // dst = a >> b (lógico)
+    IR_EQ,          // dst = (a == b)      comparações produzem 0 ou 1
+    IR_NE,          // dst = (a != b)
+    IR_LT,          // dst = (a <  b)
+    IR_LE,          // dst = (a <= b)
+    IR_ADDR_LOCAL,  // dst = endereço do slot nº imm
+    IR_ADDR_GLOBAL, // dst = endereço de sym
+    IR_LOAD,        // dst = [a + imm]
+    IR_STORE,       // [a + imm] = b
+    IR_LOAD_LOCAL,  // dst = slot nº imm
+    IR_STORE_LOCAL, // slot nº imm = b
+    IR_CALL,        // dst = sym(args...)   dst = -1 se o valor é descartado
+    IR_JMP,         // goto target
+    IR_BR,          // if (a cc b) goto target else goto target2
+    IR_RET,         // return a (a.kind == OPD_NONE: sem valor)
+    IR_TAILCALL,    // return sym(args...): chamada em posição de cauda (tailcall.c)
+    /* só depois da seleção de instruções (code_generator/isel.c) */
+    IR_RSB,         // dst = b - a
+    IR_MLA,         // dst = a * b + c
+} IrOp;
+
+typedef enum { OPD_NONE, OPD_VREG, OPD_IMM } OperandKind;
+
+typedef struct {
+    OperandKind kind;
+    int         v;          // nº do vreg ou valor imediato
+} Operand;
+
+struct IrBlock;
+
+typedef struct IrInst {
+    IrOp            op;
+    int             dst;        // vreg definido; -1 se nenhum
+    Operand         a, b;
+    Operand         c;          // MLA: parcela somada; LOAD/STORE: índice (isel.c)
+    IrOp            shop;       // b (c em LOAD/STORE) deslocado: IR_SHL, IR_SAR ou IR_SHR
+    int             shamt;      //   por shamt bits; 0 se não há deslocamento
+    int             imm;        // PARAM, LOAD/STORE, slots (ver acima)
+    const char     *sym;        // CALL, ADDR_GLOBAL (nomes internados)
+    Operand        *args;       // CALL
+    int             nargs;
+    IrOp            cc;         // BR: condição (IR_EQ, IR_NE, IR_LT ou IR_LE)
+    struct IrBlock *target;     // JMP, BR (verdadeiro)
+    struct IrBlock *target2;    // BR (falso)
+    struct IrInst  *prev, *next;
+} IrInst;
+
+typedef struct IrBlock {
+    int              id;
+    IrInst          *first, *last;
+    struct IrBlock  *succ[2];
+    int              nsucc;
+    struct IrBlock **pred;
+    int              npred;
+    struct IrBlock  *next;       // ordem de layout (a de emissão)
+    unsigned        *live_in;    // conjuntos de vregs (ir_liveness)
+    unsigned        *live_out;
+} IrBlock;
+
+typedef struct IrFunc {
+    const char    *name;
+    int            nparams;
+    int            nvregs;
+    int            nslots;      // slots de 4 bytes para locais com '&'
+    IrBlock       *entry;       // primeiro bloco do layout
+    IrBlock       *last;        // último bloco do layout
+    int            nblocks;
+    struct IrFunc *next;
+} IrFunc;
+
+typedef struct IrGlobal {
+    const char      *name;
+    int              init;
+    int              has_init;
+    struct IrGlobal *next;
+} IrGlobal;
+
+typedef struct {
+    IrFunc   *funcs;
+    IrGlobal *globals;
+} IrProgram;
+
+/* Operandos */
+static inline Operand opd_none(void)      { return (Operand){ OPD_NONE, 0 }; }
+static inline Operand opd_vreg(int v)     { return (Operand){ OPD_VREG, v }; }
+static inline Operand opd_imm(int v)      { return (Operand){ OPD_IMM,  v }; }
+
+/* Construção (ir.c) */
+IrFunc  *ir_new_func(const char *name, int nparams);
+IrBlock *ir_new_block(IrFunc *f);           // ainda fora do layout
+void     ir_place_block(IrFunc *f, IrBlock *b); // acrescenta ao fim do layout
+void     ir_place_after(IrFunc *f, IrBlock *pos, IrBlock *b); // logo depois de pos
+int      ir_new_vreg(IrFunc *f);
+IrInst  *ir_append(IrBlock *b, IrOp op);    // nova instrução no fim do bloco
+IrInst  *ir_insert_before(IrInst *pos, IrBlock *b, IrOp op);
+void     ir_remove(IrBlock *b, IrInst *i);
+int      ir_is_terminator(IrOp op);
+int      ir_has_side_effect(const IrInst *i);
+
+/* Análises (ir.c) */
+void ir_build_cfg(IrFunc *f);     // succ/pred a partir dos terminadores
+void ir_cleanup(IrFunc *f);       // remove blocos inalcançáveis e saltos triviais
+void ir_liveness(IrFunc *f);      // live_in/live_out de cada bloco
+
+/* Otimizações (fold.c) */
+void ir_fold(IrFunc *f);          // constantes, identidades, redução de força, DCE
+void ir_optimize(IrProgram *p);   // todas as passadas, função a função
+
+/* Chamadas de cauda (tailcall.c) */
+void ir_tailcall(IrFunc *f);      // recursão de cauda em laço; demais em IR_TAILCALL
+
+/* Inlining (inline.c) */
+extern int ir_inline_limit;       // tamanho máximo (instruções) de quem é expandido; 0 desliga
+void ir_inline(IrProgram *p);     // expande chamadas a funções pequenas não recursivas
+
+/* Laços (loop.c) */
+extern int ir_loop_opt;           // 0 desliga (opção -fno-loop-opt)
+void ir_loop(IrFunc *f);          // LICM, redução de força de induções, desenrolamento
+
+/* Conjuntos de vregs (bitsets na arena) */
+static inline int bs_words(int n)               { return (n + 31) / 32; }
+static inline int bs_has(const unsigned *s, int v)  { return (s[v >> 5] >> (v & 31)) & 1; }
+static inline void bs_add(unsigned *s, int v)   { s[v >> 5] |= 1u << (v & 31); }
+static inline void bs_del(unsigned *s, int v)   { s[v >> 5] &= ~(1u << (v & 31)); }
+
+/* Construção a partir da AST anotada pela semântica (lower.c); NULL,
+ * com os erros já em stderr, se uma global tem inicializador que não é
+ * constante */
+IrProgram *ir_build(NodeId root);
+
+/* Impressão legível (opção -ir) */
+void ir_dump(IrProgram *p, FILE *out);
+
+#endif
@@ -0,0 +1,690 @@
+#include "ir.h"
+#include "arena.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Otimizações de laço sobre a IR.
+ *
+ * Laços naturais saem das arestas de retorno b -> h em que h domina b;
+ * cada cabeçalho ganha um pré-cabeçalho (bloco único por onde se entra
+ * no laço). Em cada laço, do mais interno para o mais externo:
+ *   - LICM: instruções puras cujos operandos não mudam no laço vão para
+ *     o pré-cabeçalho (endereços de globais, contas com invariantes e,
+ *     se o laço não escreve na memória, loads de endereço conhecido);
+ *   - redução de força: uma variável de indução i (única definição no
+ *     laço: i = i + c) e um temporário t = k*i + b calculado a partir
+ *     dela com mul/shl/add/sub viram um novo vreg q, iniciado no
+ *     pré-cabeçalho e somado de k*c logo depois de i: 'v + i*4' vira um
+ *     ponteiro que anda 4 bytes por volta;
+ *   - desenrolamento: um laço de um só bloco com contagem constante
+ *     divisível por 4 (ou 2) repete o corpo e testa a condição só uma
+ *     vez a cada 4 (ou 2) voltas. */
+
+int ir_loop_opt = 1;
+
+#define UNROLL_MAX 16           // instruções do corpo para desenrolar
+
+static IrFunc   *fn;
+static IrBlock **blocks;        // blocos em ordem de layout
+static int       nb;
+static int      *bidx;          // id -> índice em blocks
+static int       w;             // palavras de um bitset de blocos
+static unsigned *dom;           // dom[k*w ..]: quem domina o bloco k
+static int      *ndef;          // definições de cada vreg na função
+static IrInst  **def;           // a definição, se única
+static IrBlock **defb;          // e o bloco dela
+
+static void *xcalloc(size_t n, size_t sz) {
+    void *p = calloc(n ? n : 1, sz);
+    if (!p) {
+        perror("calloc");
+        exit(1);
+    }
+    return p;
+}
+
+/* ------------------------------------------------------------------ */
+/* Dominadores e laços naturais                                        */
+/* ------------------------------------------------------------------ */
+
+static void number_blocks(void) {
+    nb = 0;
+    for (IrBlock *b = fn->entry; b; b = b->next)
+        nb++;
+    free(blocks);
+    free(bidx);
+    blocks = xcalloc(nb, sizeof *blocks);
+    bidx   = xcalloc(fn->nblocks, sizeof *bidx);
+    int k = 0;
+    for (IrBlock *b = fn->entry; b; b = b->next, k++) {
+        blocks[k] = b;
+        bidx[b->id] = k;
+    }
+    w = bs_words(nb);
+}
+
+static void dominators(void) {
+    free(dom);
+    dom = xcalloc((size_t)nb * w, sizeof *dom);
+    unsigned *tmp = xcalloc(w, sizeof *tmp);
+    for (int k = 0; k < nb; k++)
+        for (int j = 0; j < nb; j++)
+            if (k == 0 ? j == 0 : 1)
+                bs_add(dom + k * w, j);
+    for (int changed = 1; changed; ) {
+        changed = 0;
+        for (int k = 1; k < nb; k++) {
+            IrBlock *b = blocks[k];
+            for (int j = 0; j < w; j++)
+                tmp[j] = b->npred ? ~0u : 0;
+            for (int p = 0; p < b->npred; p++)
+                for (int j = 0; j < w; j++)
+                    tmp[j] &= dom[bidx[b->pred[p]->id] * w + j];
+            bs_add(tmp, k);
+            if (memcmp(tmp, dom + k * w, sizeof *tmp * w)) {
+                memcpy(dom + k * w, tmp, sizeof *tmp * w);
+                changed = 1;
+            }
+        }
+    }
+    free(tmp);
+}
+
+static int dominates(IrBlock *a, IrBlock *b) {
+    return bs_has(dom + bidx[b->id] * w, bidx[a->id]);
+}
+
+typedef struct {
+    IrBlock  *head;
+    unsigned *body;             // bitset de blocos (índices)
+    int       size;
+} Loop;
+
+// Blocos que chegam a b sem passar por h (h já está em body)
+static void collect(unsigned *body, IrBlock *b) {
+    if (bs_has(body, bidx[b->id]))
+        return;
+    bs_add(body, bidx[b->id]);
+    for (int p = 0; p < b->npred; p++)
+        collect(body, b->pred[p]);
+}
+
+static int find_loops(Loop **out) {
+    Loop *loops = xcalloc(nb, sizeof *loops);
+    int n = 0;
+    for (int k = 0; k < nb; k++) {
+        IrBlock *h = blocks[k];
+        unsigned *body = NULL;
+        for (int p = 0; p < h->npred; p++) {
+            IrBlock *b = h->pred[p];
+            if (!dominates(h, b))
+                continue;
+            if (!body) {
+                body = arena_calloc(&compile_arena, sizeof(unsigned) * w);
+                bs_add(body, k);
+            }
+            collect(body, b);
+        }
+        if (!body)
+            continue;
+        loops[n].head = h;
+        loops[n].body = body;
+        for (int j = 0; j < nb; j++)
+            loops[n].size += bs_has(body, j);
+        n++;
+    }
+    // mais internos (menores) primeiro
+    for (int i = 1; i < n; i++)
+        for (int j = i; j > 0 && loops[j].size < loops[j - 1].size; j--) {
+            Loop t = loops[j];
+            loops[j] = loops[j - 1];
+            loops[j - 1] = t;
+        }
+    *out = loops;
+    return n;
+}
+
+static int in_loop(const Loop *l, IrBlock *b) {
+    return bs_has(l->body, bidx[b->id]);
+}
+
+/* Garante um pré-cabeçalho: o único predecessor de fora do laço, com h
+ * como único sucessor. Devolve se precisou criar algum bloco. */
+static int make_preheader(Loop *l) {
+    IrBlock *h = l->head, *outside = NULL;
+    int nout = 0;
+    for (int p = 0; p < h->npred; p++)
+        if (!in_loop(l, h->pred[p])) {
+            outside = h->pred[p];
+            nout++;
+        }
+    if (!nout || h == fn->entry || (nout == 1 && outside->nsucc == 1))
+        return 0;
+    IrBlock *ph = ir_new_block(fn);
+    ir_append(ph, IR_JMP)->target = h;
+    for (int p = 0; p < h->npred; p++) {
+        IrInst *t = h->pred[p]->last;
+        if (in_loop(l, h->pred[p]))
+            continue;
+        if (t->target == h)  t->target  = ph;
+        if (t->op == IR_BR && t->target2 == h) t->target2 = ph;
+    }
+    IrBlock *prev = fn->entry;
+    while (prev->next != h)
+        prev = prev->next;
+    ir_place_after(fn, prev, ph);
+    return 1;
+}
+
+static IrBlock *preheader(const Loop *l) {
+    for (int p = 0; p < l->head->npred; p++)
+        if (!in_loop(l, l->head->pred[p]))
+            return l->head->pred[p];
+    return NULL;
+}
+
+/* ------------------------------------------------------------------ */
+/* Definições                                                          */
+/* ------------------------------------------------------------------ */
+
+static void count_defs(void) {
+    free(ndef);
+    free(def);
+    free(defb);
+    ndef = xcalloc(fn->nvregs, sizeof *ndef);
+    def  = xcalloc(fn->nvregs, sizeof *def);
+    defb = xcalloc(fn->nvregs, sizeof *defb);
+    for (IrBlock *b = fn->entry; b; b = b->next)
+        for (IrInst *i = b->first; i; i = i->next)
+            if (i->dst >= 0) {
+                ndef[i->dst]++;
+                def[i->dst]  = i;
+                defb[i->dst] = b;
+            }
+}
+
+// Nº de definições de v dentro do laço
+static int defs_in(const Loop *l, int v) {
+    int n = 0;
+    for (int k = 0; k < nb; k++)
+        if (bs_has(l->body, k))
+            for (IrInst *i = blocks[k]->first; i; i = i->next)
+                n += i->dst == v;
+    return n;
+}
+
+static int invariant(const Loop *l, Operand o) {
+    return o.kind != OPD_VREG || !defs_in(l, o.v);
+}
+
+/* ------------------------------------------------------------------ */
+/* LICM                                                                */
+/* ------------------------------------------------------------------ */
+
+static int writes_memory(const Loop *l) {
+    for (int k = 0; k < nb; k++)
+        if (bs_has(l->body, k))
+            for (IrInst *i = blocks[k]->first; i; i = i->next)
+                if (i->op == IR_STORE || i->op == IR_STORE_LOCAL || i->op == IR_CALL)
+                    return 1;
+    return 0;
+}
+
+static int hoistable(const Loop *l, IrInst *i, int memok) {
+    switch (i->op) {
+    case IR_MOV: case IR_ADD: case IR_SUB: case IR_MUL:
+    case IR_SHL: case IR_SAR: case IR_SHR:
+    case IR_EQ: case IR_NE: case IR_LT: case IR_LE:
+    case IR_ADDR_LOCAL: case IR_ADDR_GLOBAL:
+        break;
+    case IR_LOAD_LOCAL:
+        if (!memok) return 0;
+        break;
+    case IR_LOAD: {
+        /* só de endereço que sempre é válido: sair do laço antes da
+         * primeira volta não pode fazer o load falhar */
+        IrInst *d = i->a.kind == OPD_VREG && ndef[i->a.v] == 1 ? def[i->a.v] : NULL;
+        if (!memok || !d || (d->op != IR_ADDR_GLOBAL && d->op != IR_ADDR_LOCAL))
+            return 0;
+        break;
+    }
+    default:
+        return 0;
+    }
+    return ndef[i->dst] == 1 && invariant(l, i->a) && invariant(l, i->b);
+}
+
+static int licm(const Loop *l, IrBlock *ph) {
+    int memok = !writes_memory(l), moved = 0;
+    for (int again = 1; again; ) {
+        again = 0;
+        for (int k = 0; k < nb; k++) {
+            if (!bs_has(l->body, k)) continue;
+            IrBlock *b = blocks[k];
+            for (IrInst *i = b->first, *nx; i; i = nx) {
+                nx = i->next;
+                if (!hoistable(l, i, memok))
+                    continue;
+                ir_remove(b, i);
+                i->prev = ph->last->prev;
+                i->next = ph->last;
+                if (ph->last->prev) ph->last->prev->next = i;
+                else                ph->first            = i;
+                ph->last->prev = i;
+                defb[i->dst] = ph;
+                moved = again = 1;
+            }
+        }
+    }
+    return moved;
+}
+
+/* ------------------------------------------------------------------ */
+/* Variáveis de indução                                                */
+/* ------------------------------------------------------------------ */
+
+typedef struct {
+    int     iv;                 // vreg da variável de indução básica
+    int     step;               // i = i + step a cada volta
+    IrInst *update;
+    IrBlock *ublock;
+} BasicIv;
+
+// v é variável de indução básica do laço? Preenche *iv
+static int basic_iv(const Loop *l, int v, BasicIv *iv) {
+    IrInst *u = NULL;
+    IrBlock *ub = NULL;
+    for (int k = 0; k < nb; k++)
+        if (bs_has(l->body, k))
+            for (IrInst *i = blocks[k]->first; i; i = i->next)
+                if (i->dst == v) {
+                    if (u) return 0;
+                    u  = i;
+                    ub = blocks[k];
+                }
+    if (!u || (u->op != IR_ADD && u->op != IR_SUB))
+        return 0;
+    int self_a = u->a.kind == OPD_VREG && u->a.v == v;
+    if (!(self_a && u->b.kind == OPD_IMM) &&
+        !(u->op == IR_ADD && u->b.kind == OPD_VREG && u->b.v == v && u->a.kind == OPD_IMM))
+        return 0;
+    int c = self_a ? u->b.v : u->a.v;
+    // a atualização tem de acontecer em toda volta
+    for (int p = 0; p < l->head->npred; p++)
+        if (in_loop(l, l->head->pred[p]) && !dominates(ub, l->head->pred[p]))
+            return 0;
+    iv->iv     = v;
+    iv->step   = u->op == IR_SUB ? -c : c;
+    iv->update = u;
+    iv->ublock = ub;
+    return 1;
+}
+
+/* Forma afim de um operando lido pela instrução 'at' do bloco b:
+ * valor = scale * iv + off, com off invariante. Os temporários da
+ * cadeia precisam estar em b, antes de 'at' e sem atualização de iv no
+ * meio (senão a cadeia mistura o iv de antes e o de depois). Com ph, as
+ * contas de off são emitidas lá; sem, só verifica. */
+typedef struct {
+    int     iv;                 // -1: invariante
+    int     scale;
+    Operand off;
+    int     strong;             // há mul/shl na cadeia
+} Affine;
+
+static BasicIv *ivs;
+static int      nivs;
+
+static BasicIv *find_iv(int v) {
+    for (int k = 0; k < nivs; k++)
+        if (ivs[k].iv == v)
+            return &ivs[k];
+    return NULL;
+}
+
+static Operand ph_op(IrBlock *ph, IrOp op, Operand a, Operand b) {
+    if (!ph)
+        return opd_imm(0);
+    IrInst *i = ir_insert_before(ph->last, ph, op);
+    i->dst = ir_new_vreg(fn);
+    i->a   = a;
+    i->b   = b;
+    return opd_vreg(i->dst);
+}
+
+static int affine(const Loop *l, Operand o, IrInst *at, IrBlock *b, IrBlock *ph, Affine *r, int depth) {
+    if (invariant(l, o)) {
+        *r = (Affine){ -1, 0, o, 0 };
+        return 1;
+    }
+    if (find_iv(o.v)) {
+        *r = (Affine){ o.v, 1, opd_imm(0), 0 };
+        return 1;
+    }
+    IrInst *d = ndef[o.v] == 1 ? def[o.v] : NULL;
+    if (!d || defb[o.v] != b || depth > 8)
+        return 0;
+    int seen = 0;               // d vem antes de 'at', sem atualização de iv entre eles
+    for (IrInst *i = d->next; i && i != at; i = i->next)
+        if (i->dst >= 0 && find_iv(i->dst))
+            return 0;
+    for (IrInst *i = b->first; i && i != at; i = i->next)
+        seen |= i == d;
+    if (!seen)
+        return 0;
+
+    Affine x, y;
+    switch (d->op) {
+    case IR_MUL:
+    case IR_SHL: {
+        Operand var = d->a, k = d->b;
+        if (d->op == IR_MUL && d->a.kind == OPD_IMM) {
+            var = d->b;
+            k   = d->a;
+        }
+        if (k.kind != OPD_IMM || (d->op == IR_SHL && (k.v < 0 || k.v > 30)))
+            return 0;
+        int m = d->op == IR_MUL ? k.v : 1 << k.v;
+        if (!affine(l, var, d, b, ph, &x, depth + 1) || x.iv < 0)
+            return 0;
+        r->iv     = x.iv;
+        r->scale  = x.scale * m;
+        r->off    = x.off.kind == OPD_IMM ? opd_imm(x.off.v * m)
+                                          : ph_op(ph, IR_MUL, x.off, opd_imm(m));
+        r->strong = 1;
+        return 1;
+    }
+    case IR_ADD:
+    case IR_SUB: {
+        if (!affine(l, d->a, d, b, ph, &x, depth + 1) ||
+            !affine(l, d->b, d, b, ph, &y, depth + 1))
+            return 0;
+        if (d->op == IR_SUB && y.iv >= 0)
+            return 0;           // inv - i: escala negativa, raro
+        if (x.iv >= 0 && y.iv >= 0)
+            return 0;
+        Affine *v = x.iv >= 0 ? &x : &y, *inv = x.iv >= 0 ? &y : &x;
+        r->iv     = v->iv;
+        r->scale  = v->scale;
+        r->strong = v->strong;
+        if (d->op == IR_SUB)
+            r->off = v->off.kind == OPD_IMM && inv->off.kind == OPD_IMM
+                   ? opd_imm(v->off.v - inv->off.v) : ph_op(ph, IR_SUB, v->off, inv->off);
+        else
+            r->off = v->off.kind == OPD_IMM && inv->off.kind == OPD_IMM
+                   ? opd_imm(v->off.v + inv->off.v) : ph_op(ph, IR_ADD, v->off, inv->off);
+        return 1;
+    }
+    default:
+        return 0;
+    }
+}
+
+/* t = k*i + b vira 'mov q', com q iniciado no pré-cabeçalho e somado de
+ * k*c logo depois de i += c. Só para t lido fora da própria cadeia
+ * afim (as partes internas morrem sozinhas) e com mul/shl na cadeia. */
+static int strength_reduce(const Loop *l, IrBlock *ph) {
+    nivs = 0;
+    free(ivs);
+    ivs = xcalloc(fn->nvregs, sizeof *ivs);
+    for (int v = 0; v < fn->nvregs; v++)
+        if (ndef[v] > 1 && basic_iv(l, v, &ivs[nivs]))
+            nivs++;
+    if (!nivs)
+        return 0;
+
+    // leituras de cada vreg por instruções que não são candidatas
+    int nv = fn->nvregs;        // vregs criados aqui não são candidatos
+    int *plain = xcalloc(fn->nvregs, sizeof *plain);
+    char *cand = xcalloc(fn->nvregs, 1);
+    Affine a;
+    for (int k = 0; k < nb; k++) {
+        if (!bs_has(l->body, k)) continue;
+        for (IrInst *i = blocks[k]->first; i; i = i->next)
+            if (i->dst >= 0 && ndef[i->dst] == 1 &&
+                (i->op == IR_MUL || i->op == IR_SHL || i->op == IR_ADD || i->op == IR_SUB) &&
+                affine(l, opd_vreg(i->dst), i->next, blocks[k], NULL, &a, 0) && a.iv >= 0)
+                cand[i->dst] = 1;
+    }
+    for (IrBlock *b = fn->entry; b; b = b->next)
+        for (IrInst *i = b->first; i; i = i->next) {
+            int c = i->dst >= 0 && cand[i->dst];
+            if (i->a.kind == OPD_VREG && !c) plain[i->a.v]++;
+            if (i->b.kind == OPD_VREG && !c) plain[i->b.v]++;
+            for (int k = 0; k < i->nargs; k++)
+                if (i->args[k].kind == OPD_VREG)
+                    plain[i->args[k].v]++;
+        }
+
+    int changed = 0;
+    for (int k = 0; k < nb; k++) {
+        if (!bs_has(l->body, k)) continue;
+        IrBlock *b = blocks[k];
+        for (IrInst *i = b->first; i; i = i->next) {
+            int t = i->dst;
+            if (t < 0 || t >= nv || !cand[t] || !plain[t])
+                continue;
+            if (!affine(l, opd_vreg(t), i->next, b, NULL, &a, 0) || !a.strong)
+                continue;
+            affine(l, opd_vreg(t), i->next, b, ph, &a, 0);
+            BasicIv *iv = find_iv(a.iv);
+            // q = scale*i + off no pré-cabeçalho
+            Operand s = ph_op(ph, IR_MUL, opd_vreg(a.iv), opd_imm(a.scale));
+            int q = ph_op(ph, IR_ADD, s, a.off).v;
+            IrInst *u = ir_insert_before(iv->update->next, iv->ublock, IR_ADD);
+            u->dst = q;
+            u->a   = opd_vreg(q);
+            u->b   = opd_imm(a.scale * iv->step);
+            i->op = IR_MOV;
+            i->a  = opd_vreg(q);
+            i->b  = opd_none();
+            // leituras de t adiante no bloco passam a ler q direto
+            for (IrInst *j = i->next; j && j->dst != q && j->dst != t; j = j->next) {
+                if (j->a.kind == OPD_VREG && j->a.v == t) j->a.v = q;
+                if (j->b.kind == OPD_VREG && j->b.v == t) j->b.v = q;
+                for (int k2 = 0; k2 < j->nargs; k2++)
+                    if (j->args[k2].kind == OPD_VREG && j->args[k2].v == t)
+                        j->args[k2].v = q;
+            }
+            cand[t] = 0;
+            changed = 1;
+        }
+    }
+    free(plain);
+    free(cand);
+    return changed;
+}
+
+/* ------------------------------------------------------------------ */
+/* Desenrolamento                                                      */
+/* ------------------------------------------------------------------ */
+
+// Valor inicial de v ao entrar no laço, se é uma constante
+static int initial_value(const Loop *l, int v, int *out) {
+    IrInst *init = NULL;
+    IrBlock *ib = NULL;
+    for (IrBlock *b = fn->entry; b; b = b->next)
+        for (IrInst *i = b->first; i; i = i->next)
+            if (i->dst == v && !in_loop(l, b)) {
+                if (init) return 0;
+                init = i;
+                ib   = b;
+            }
+    if (!init || init->op != IR_MOV || init->a.kind != OPD_IMM || !dominates(ib, l->head))
+        return 0;
+    *out = init->a.v;
+    return 1;
+}
+
+/* Nas cópias do corpo, 'x = add x, c' fica pendente e os loads e
+ * stores por x absorvem o deslocamento no imediato:
+ *   ldr [x]; x += 4; ldr [x]; x += 4   ->   ldr [x]; ldr [x, #4]; x += 8
+ * Qualquer outra leitura de x (e o fim do bloco) materializa a soma. */
+static void fold_offsets(IrBlock *b) {
+    int nv = fn->nvregs;
+    int *delta = xcalloc(nv, sizeof *delta);
+    for (IrInst *i = b->first, *nx; i; i = nx) {
+        nx = i->next;
+        if (i->op == IR_ADD && i->a.kind == OPD_VREG && i->a.v == i->dst &&
+            i->b.kind == OPD_IMM) {
+            delta[i->dst] = (int)((unsigned)delta[i->dst] + (unsigned)i->b.v);
+            ir_remove(b, i);
+            continue;
+        }
+        // o endereço de load/store aceita o deslocamento (ldr/str: ±4095)
+        int addr = -1;
+        if ((i->op == IR_LOAD || i->op == IR_STORE) && i->a.kind == OPD_VREG &&
+            delta[i->a.v] && (i->b.kind != OPD_VREG || i->b.v != i->a.v)) {
+            long long off = (long long)i->imm + delta[i->a.v];
+            if (off > -4096 && off < 4096) {
+                i->imm = (int)off;
+                addr = i->a.v;
+            }
+        }
+        for (int v = 0; v < nv; v++) {
+            int used = (i->a.kind == OPD_VREG && i->a.v == v && v != addr) ||
+                       (i->b.kind == OPD_VREG && i->b.v == v) || ir_is_terminator(i->op);
+            for (int k = 0; k < i->nargs && !used; k++)
+                used = i->args[k].kind == OPD_VREG && i->args[k].v == v;
+            if (!delta[v] || !used)
+                continue;
+            IrInst *m = ir_insert_before(i, b, IR_ADD);
+            m->dst = v;
+            m->a   = opd_vreg(v);
+            m->b   = opd_imm(delta[v]);
+            delta[v] = 0;
+        }
+        if (i->dst >= 0)
+            delta[i->dst] = 0;  // redefinido: a soma pendente morreu
+    }
+    free(delta);
+}
+
+/* Forma aceita (a dos laços rotacionados, depois da limpeza):
+ *   h:    br cc i, N, body, exit
+ *   body: ...; i = i + c; ...; jmp h */
+static int unroll(const Loop *l) {
+    IrBlock *h = l->head, *body;
+    IrInst *br = h->first;
+    if (l->size != 2 || !br || br != h->last || br->op != IR_BR)
+        return 0;
+    body = br->target;
+    if (!in_loop(l, body) || body == h || in_loop(l, br->target2) ||
+        body->last->op != IR_JMP || body->last->target != h)
+        return 0;
+    BasicIv iv;
+    int i0;
+    if (br->a.kind != OPD_VREG || br->b.kind != OPD_IMM || !basic_iv(l, br->a.v, &iv) ||
+        iv.step <= 0 || !initial_value(l, iv.iv, &i0))
+        return 0;
+    long long n = br->b.v, trips;
+    switch (br->cc) {
+    case IR_LT: trips = n > i0 ? (n - i0 + iv.step - 1) / iv.step : 0; break;
+    case IR_LE: trips = n >= i0 ? (n - i0) / iv.step + 1 : 0; break;
+    case IR_NE: trips = n > i0 && (n - i0) % iv.step == 0 ? (n - i0) / iv.step : 0; break;
+    default:    return 0;
+    }
+    if ((long long)i0 + trips * iv.step > 0x7fffffffLL)
+        return 0;               // i estouraria antes de sair
+    int size = 0;
+    for (IrInst *i = body->first; i != body->last; i = i->next) {
+        if (i->op == IR_CALL)
+            return 0;
+        size++;
+    }
+    int factor = trips >= 4 && trips % 4 == 0 && 4 * size <= 2 * UNROLL_MAX ? 4
+               : trips >= 2 && trips % 2 == 0 && size <= UNROLL_MAX ? 2 : 1;
+    if (factor == 1)
+        return 0;
+
+    /* temporários de uma cópia (definição única, mortos na saída do
+     * corpo) ganham vregs novos em cada cópia */
+    ir_liveness(fn);
+    int nv = fn->nvregs;
+    int *map = xcalloc(nv, sizeof *map);
+    IrInst *last = body->last->prev;
+    for (int copy = 1; copy < factor; copy++) {
+        for (int v = 0; v < nv; v++)
+            map[v] = v;
+        for (IrInst *i = body->first; ; i = i->next) {
+            if (i->dst >= 0 && ndef[i->dst] == 1 && !bs_has(body->live_out, i->dst))
+                map[i->dst] = ir_new_vreg(fn);
+            if (i == last) break;
+        }
+        for (IrInst *i = body->first; ; i = i->next) {
+            IrInst *c = ir_insert_before(body->last, body, i->op);
+            IrInst *prev = c->prev, *next = c->next;
+            *c = *i;
+            c->prev = prev;
+            c->next = next;
+            if (c->dst >= 0)            c->dst = map[c->dst];
+            if (c->a.kind == OPD_VREG)  c->a.v = map[c->a.v];
+            if (c->b.kind == OPD_VREG)  c->b.v = map[c->b.v];
+            if (i == last) break;
+        }
+    }
+    free(map);
+    fold_offsets(body);
+    return 1;
+}
+
+/* ------------------------------------------------------------------ */
+
+static void release(void) {
+    free(blocks); free(bidx); free(dom);
+    free(ndef); free(def); free(defb); free(ivs);
+    blocks = NULL; bidx = NULL; dom = NULL;
+    ndef = NULL; def = NULL; defb = NULL; ivs = NULL;
+}
+
+// Blocos, dominadores e laços da forma atual de fn
+static int analyze(Loop **loops) {
+    ir_build_cfg(fn);
+    number_blocks();
+    dominators();
+    count_defs();
+    return find_loops(loops);
+}
+
+void ir_loop(IrFunc *f) {
+    if (!ir_loop_opt)
+        return;
+    fn = f;
+    Loop *loops;
+    int n = analyze(&loops), created = 0;
+    for (int k = 0; k < n; k++)
+        created |= make_preheader(&loops[k]);
+    free(loops);
+    if (!n) {
+        release();
+        return;
+    }
+    n = analyze(&loops);
+
+    int changed = created;
+    for (int k = 0; k < n; k++) {
+        IrBlock *ph = preheader(&loops[k]);
+        if (!ph) continue;
+        changed |= licm(&loops[k], ph);
+        changed |= strength_reduce(&loops[k], ph);
+        count_defs();
+    }
+    free(loops);
+
+    /* o desenrolamento copia o corpo já limpo: sem as contas que a
+     * redução de força deixou mortas */
+    if (changed)
+        ir_fold(f);
+    n = analyze(&loops);
+    int unrolled = 0;
+    for (int k = 0; k < n; k++)
+        if (unroll(&loops[k])) {
+            unrolled = 1;
+            count_defs();
+        }
+    free(loops);
+    release();
+    if (unrolled)
+        ir_fold(f);
+}
@@ -0,0 +1,582 @@
+#include "ir.h"
+#include "arena.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Tradução da AST (já tipada pela semântica) para a IR.
+ *
+ * Uma passada prévia por função descobre quais declarações têm o endereço
+ * tomado ('&x'): essas ganham um slot no quadro; as demais viram vregs.
+ * As declarações são numeradas em pré-ordem (parâmetros primeiro), o que
+ * vale igualmente para as duas passadas. */
+
+typedef struct {
+    const char *name;
+    int         decl;       // nº da declaração na função
+    int         vreg;       // local em registrador virtual
+    int         slot;       // >= 0: mora no quadro
+} Var;
+
+static IrFunc  *fn;
+static IrBlock *cur;
+static Var     *vars;           // pilha de escopos: visíveis no ponto atual
+static int      nvars, vars_cap;
+static char    *addr_taken;     // por declaração
+static int      ndecls, decls_cap;
+static int      next_decl;
+static char    *is_var;         // vreg pertence a uma variável (não é temporário)
+static int      is_var_cap;
+
+static void *grow(void *p, int *cap, int need, size_t elem) {
+    if (need <= *cap)
+        return p;
+    while (*cap < need)
+        *cap = *cap ? *cap * 2 : 64;
+    p = realloc(p, elem * *cap);
+    if (!p) {
+        perror("realloc");
+        exit(1);
+    }
+    return p;
+}
+
+static Var *find_var(const char *name) {
+    for (int i = nvars - 1; i >= 0; i--)
+        if (vars[i].name == name)       /* nomes internados */
+            return &vars[i];
+    return NULL;
+}
+
+static Var *push_var(const char *name, int decl) {
+    vars = grow(vars, &vars_cap, nvars + 1, sizeof *vars);
+    vars[nvars] = (Var){ name, decl, -1, -1 };
+    return &vars[nvars++];
+}
+
+/* ------------------------------------------------------------------ */
+/* Passada prévia: declarações com '&'                                 */
+/* ------------------------------------------------------------------ */
+
+static int new_decl(const char *name) {
+    addr_taken = grow(addr_taken, &decls_cap, ndecls + 1, 1);
+    addr_taken[ndecls] = 0;
+    push_var(name, ndecls);
+    return ndecls++;
+}
+
+static void mark_addr(NodeId n) {
+    if (!n) return;
+    switch (nd_kind(n)) {
+    case ND_NUM: case ND_VAR:
+        break;
+    case ND_DECL:
+        mark_addr(nd_init(n));
+        new_decl(nd_name(n));
+        break;
+    case ND_ADDR:
+        if (nd_kind(nd_lhs(n)) == ND_VAR) {
+            Var *v = find_var(nd_name(nd_lhs(n)));
+            if (v) addr_taken[v->decl] = 1;
+        }
+        mark_addr(nd_lhs(n));
+        break;
+    case ND_DEREF: case ND_POSTINC: case ND_POSTDEC: case ND_RETURN:
+        mark_addr(nd_lhs(n));
+        break;
+    case ND_BLOCK: {
+        int mark = nvars;
+        for (int i = 0; i < nd_count(n); i++)
+            mark_addr(nd_list(n)[i]);
+        nvars = mark;
+        break;
+    }
+    case ND_IF:
+        mark_addr(nd_cond(n));
+        mark_addr(nd_then(n));
+        mark_addr(nd_else(n));
+        break;
+    case ND_WHILE:
+        mark_addr(nd_cond(n));
+        mark_addr(nd_body(n));
+        break;
+    case ND_FOR: {
+        int mark = nvars;
+        mark_addr(nd_init(n));
+        mark_addr(nd_cond(n));
+        mark_addr(nd_body(n));
+        mark_addr(nd_inc(n));
+        nvars = mark;
+        break;
+    }
+    case ND_CALL:
+        for (int i = 0; i < nd_count(n); i++)
+            mark_addr(nd_list(n)[i]);
+        break;
+    default:            /* binários */
+        mark_addr(nd_lhs(n));
+        mark_addr(nd_rhs(n));
+        break;
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/* Emissão                                                             */
+/* ------------------------------------------------------------------ */
+
+static int new_temp(void) {
+    return ir_new_vreg(fn);
+}
+
+static int new_var_vreg(void) {
+    int v = ir_new_vreg(fn);
+    if (v >= is_var_cap) {
+        int old = is_var_cap;
+        is_var = grow(is_var, &is_var_cap, v + 1, 1);
+        memset(is_var + old, 0, is_var_cap - old);
+    }
+    is_var[v] = 1;
+    return v;
+}
+
+static int is_temp(Operand o) {
+    return o.kind == OPD_VREG && (o.v >= is_var_cap || !is_var[o.v]);
+}
+
+static IrInst *emit(IrOp op, int dst, Operand a, Operand b) {
+    IrInst *i = ir_append(cur, op);
+    i->dst = dst;
+    i->a   = a;
+    i->b   = b;
+    return i;
+}
+
+static Operand emit_value(IrOp op, Operand a, Operand b) {
+    int t = new_temp();
+    emit(op, t, a, b);
+    return opd_vreg(t);
+}
+
+static void start_block(IrBlock *b) {
+    ir_place_block(fn, b);
+    cur = b;
+}
+
+static void emit_jmp(IrBlock *target) {
+    ir_append(cur, IR_JMP)->target = target;
+}
+
+static void emit_br(IrOp cc, Operand a, Operand b, IrBlock *t, IrBlock *f) {
+    IrInst *i  = emit(IR_BR, -1, a, b);
+    i->cc      = cc;
+    i->target  = t;
+    i->target2 = f;
+}
+
+// Copia v para o vreg dst; se v acabou de ser calculado num temporário,
+// a última instrução passa a definir dst diretamente
+static void emit_move(int dst, Operand v) {
+    if (is_temp(v) && cur->last && cur->last->dst == v.v)
+        cur->last->dst = dst;
+    else if (!(v.kind == OPD_VREG && v.v == dst))
+        emit(IR_MOV, dst, v, opd_none());
+}
+
+/* ------------------------------------------------------------------ */
+/* Expressões                                                          */
+/* ------------------------------------------------------------------ */
+
+static Operand lower_expr(NodeId n);
+static Operand lower_incdec(NodeId n, int want);
+static void    lower_cond(NodeId n, IrBlock *t, IrBlock *f);
+
+// Endereço de um lvalue que mora na memória (global ou *p)
+static Operand lower_addr(NodeId lv) {
+    if (nd_kind(lv) == ND_DEREF)
+        return lower_expr(nd_lhs(lv));
+    Var *v = find_var(nd_name(lv));
+    if (v) {
+        IrInst *i = emit(IR_ADDR_LOCAL, new_temp(), opd_none(), opd_none());
+        i->imm = v->slot;
+        return opd_vreg(i->dst);
+    }
+    IrInst *i = emit(IR_ADDR_GLOBAL, new_temp(), opd_none(), opd_none());
+    i->sym = nd_name(lv);
+    return opd_vreg(i->dst);
+}
+
+/* *p++ / *p-- com p num vreg: o acesso usa p e o passo vem logo depois,
+ * sem cópia do valor antigo (o peephole junta os dois num ldr/str
+ * pós-indexado). Devolve p, ou NULL se não é esse o caso. */
+static Var *post_step(NodeId deref) {
+    NodeId n = nd_lhs(deref);
+    if ((nd_kind(n) != ND_POSTINC && nd_kind(n) != ND_POSTDEC) || nd_kind(nd_lhs(n)) != ND_VAR)
+        return NULL;
+    Var *p = find_var(nd_name(nd_lhs(n)));
+    return p && p->slot < 0 ? p : NULL;
+}
+
+static Operand lower_assign(NodeId n) {
+    NodeId  lv = nd_lhs(n);
+    Operand v  = lower_expr(nd_rhs(n));
+    Var    *x  = nd_kind(lv) == ND_VAR ? find_var(nd_name(lv)) : NULL;
+    Var    *p  = nd_kind(lv) == ND_DEREF ? post_step(lv) : NULL;
+    if (p) {
+        emit(IR_STORE, -1, opd_vreg(p->vreg), v);
+        lower_incdec(nd_lhs(lv), 0);
+        return v;
+    }
+    if (x && x->slot < 0) {
+        emit_move(x->vreg, v);
+        return opd_vreg(x->vreg);
+    }
+    if (x) {
+        emit(IR_STORE_LOCAL, -1, opd_none(), v)->imm = x->slot;
+        return v;
+    }
+    Operand a = lower_addr(lv);
+    emit(IR_STORE, -1, a, v);
+    return v;
+}
+
+// x++ / x--: devolve o valor antigo se 'want'; ponteiros andam 4 bytes
+static Operand lower_incdec(NodeId n, int want) {
+    IrOp    op   = nd_kind(n) == ND_POSTINC ? IR_ADD : IR_SUB;
+    NodeId  lv   = nd_lhs(n);
+    Var    *x    = nd_kind(lv) == ND_VAR ? find_var(nd_name(lv)) : NULL;
+    Operand step = opd_imm(nd_type(lv) && nd_type(lv)->kind == TY_PTR ? 4 : 1);
+    if (x && x->slot < 0) {
+        Operand old = want ? emit_value(IR_MOV, opd_vreg(x->vreg), opd_none()) : opd_none();
+        emit(op, x->vreg, opd_vreg(x->vreg), step);
+        return old;
+    }
+    if (x) {
+        IrInst *ld = emit(IR_LOAD_LOCAL, new_temp(), opd_none(), opd_none());
+        ld->imm = x->slot;
+        Operand nv = emit_value(op, opd_vreg(ld->dst), step);
+        emit(IR_STORE_LOCAL, -1, opd_none(), nv)->imm = x->slot;
+        return opd_vreg(ld->dst);
+    }
+    Operand a  = lower_addr(lv);
+    Operand ov = emit_value(IR_LOAD, a, opd_none());
+    Operand nv = emit_value(op, ov, step);
+    emit(IR_STORE, -1, a, nv);
+    return ov;
+}
+
+static Operand lower_call(NodeId n, int want) {
+    Operand *args = nd_count(n)
+                  ? arena_alloc(&compile_arena, sizeof(Operand) * nd_count(n)) : NULL;
+    for (int i = 0; i < nd_count(n); i++)  /* da esquerda para a direita */
+        args[i] = lower_expr(nd_list(n)[i]);
+    IrInst *c = emit(IR_CALL, want ? new_temp() : -1, opd_none(), opd_none());
+    c->sym   = nd_name(n);
+    c->args  = args;
+    c->nargs = nd_count(n);
+    return want ? opd_vreg(c->dst) : opd_none();
+}
+
+// Aritmética de ponteiro: o lado inteiro é escalado pelo tamanho (4 bytes)
+static Operand scale(NodeId side, NodeId other, Operand v) {
+    if (nd_type(other) && nd_type(other)->kind == TY_PTR && nd_type(side) == ty_int)
+        return emit_value(IR_MUL, v, opd_imm(4));
+    return v;
+}
+
+static Operand lower_expr(NodeId n) {
+    switch (nd_kind(n)) {
+    case ND_NUM:
+        return opd_imm(nd_val(n));
+    case ND_VAR: {
+        Var *x = find_var(nd_name(n));
+        if (x && x->slot < 0)
+            return opd_vreg(x->vreg);
+        if (x) {
+            IrInst *i = emit(IR_LOAD_LOCAL, new_temp(), opd_none(), opd_none());
+            i->imm = x->slot;
+            return opd_vreg(i->dst);
+        }
+        return emit_value(IR_LOAD, lower_addr(n), opd_none());
+    }
+    case ND_ADDR:
+        return lower_addr(nd_lhs(n));
+    case ND_DEREF: {
+        Var *p = post_step(n);
+        if (p) {
+            Operand v = emit_value(IR_LOAD, opd_vreg(p->vreg), opd_none());
+            lower_incdec(nd_lhs(n), 0);
+            return v;
+        }
+        return emit_value(IR_LOAD, lower_expr(nd_lhs(n)), opd_none());
+    }
+    case ND_ASSIGN:
+        return lower_assign(n);
+    case ND_POSTINC:
+    case ND_POSTDEC:
+        return lower_incdec(n, 1);
+    case ND_CALL:
+        return lower_call(n, 1);
+    case ND_ADD:
+    case ND_SUB: {
+        Operand l = scale(nd_lhs(n), nd_rhs(n), lower_expr(nd_lhs(n)));
+        Operand r = scale(nd_rhs(n), nd_lhs(n), lower_expr(nd_rhs(n)));
+        return emit_value(nd_kind(n) == ND_ADD ? IR_ADD : IR_SUB, l, r);
+    }
+    case ND_MUL: case ND_DIV: case ND_MOD:
+    case ND_EQ: case ND_NE: case ND_LT: case ND_LE: {
+        static const IrOp ops[] = {
+            [ND_MUL] = IR_MUL, [ND_DIV] = IR_DIV, [ND_MOD] = IR_MOD,
+            [ND_EQ]  = IR_EQ,  [ND_NE]  = IR_NE,  [ND_LT]  = IR_LT,
+            [ND_LE]  = IR_LE,
+        };
+        Operand l = lower_expr(nd_lhs(n));
+        Operand r = lower_expr(nd_rhs(n));
+        return emit_value(ops[nd_kind(n)], l, r);
+    }
+    case ND_LOGAND:
+    case ND_LOGOR: {
+        /* valor 0/1 de && e ||: dois blocos definem o mesmo vreg */
+        IrBlock *t = ir_new_block(fn), *f = ir_new_block(fn), *end = ir_new_block(fn);
+        int r = new_temp();
+        lower_cond(n, t, f);
+        start_block(t);
+        emit(IR_MOV, r, opd_imm(1), opd_none());
+        emit_jmp(end);
+        start_block(f);
+        emit(IR_MOV, r, opd_imm(0), opd_none());
+        emit_jmp(end);
+        start_block(end);
+        return opd_vreg(r);
+    }
+    default:
+        return opd_imm(0);
+    }
+}
+
+// Desvia para t se a condição for verdadeira, senão para f (curto-circuito)
+static void lower_cond(NodeId n, IrBlock *t, IrBlock *f) {
+    if (nd_kind(n) == ND_LOGAND || nd_kind(n) == ND_LOGOR) {
+        IrBlock *mid = ir_new_block(fn);
+        if (nd_kind(n) == ND_LOGAND)
+            lower_cond(nd_lhs(n), mid, f);
+        else
+            lower_cond(nd_lhs(n), t, mid);
+        start_block(mid);
+        lower_cond(nd_rhs(n), t, f);
+        return;
+    }
+    if (nd_kind(n) == ND_EQ || nd_kind(n) == ND_NE || nd_kind(n) == ND_LT || nd_kind(n) == ND_LE) {
+        /* comparação: o desvio usa as flags direto, sem materializar 0/1 */
+        static const IrOp cc[] = {
+            [ND_EQ] = IR_EQ, [ND_NE] = IR_NE, [ND_LT] = IR_LT, [ND_LE] = IR_LE,
+        };
+        Operand l = lower_expr(nd_lhs(n));
+        Operand r = lower_expr(nd_rhs(n));
+        emit_br(cc[nd_kind(n)], l, r, t, f);
+        return;
+    }
+    emit_br(IR_NE, lower_expr(n), opd_imm(0), t, f);
+}
+
+/* ------------------------------------------------------------------ */
+/* Comandos                                                            */
+/* ------------------------------------------------------------------ */
+
+static void lower_stmt(NodeId n) {
+    switch (nd_kind(n)) {
+    case ND_RETURN:
+        emit(IR_RET, -1, nd_lhs(n) ? lower_expr(nd_lhs(n)) : opd_none(), opd_none());
+        start_block(ir_new_block(fn));      /* o que vier depois é inalcançável */
+        break;
+    case ND_BLOCK: {
+        int mark = nvars;
+        for (int i = 0; i < nd_count(n); i++)
+            lower_stmt(nd_list(n)[i]);
+        nvars = mark;
+        break;
+    }
+    case ND_IF: {
+        IrBlock *then = ir_new_block(fn);
+        IrBlock *els  = nd_else(n) ? ir_new_block(fn) : NULL;
+        IrBlock *end  = ir_new_block(fn);
+        lower_cond(nd_cond(n), then, els ? els : end);
+        start_block(then);
+        lower_stmt(nd_then(n));
+        emit_jmp(end);
+        if (els) {
+            start_block(els);
+            lower_stmt(nd_else(n));
+            emit_jmp(end);
+        }
+        start_block(end);
+        break;
+    }
+    /* laços com o teste no fim: entra saltando para o teste e, a cada
+     * volta, um único desvio condicional retorna ao corpo */
+    case ND_WHILE: {
+        IrBlock *body = ir_new_block(fn), *test = ir_new_block(fn), *end = ir_new_block(fn);
+        emit_jmp(test);
+        start_block(body);
+        lower_stmt(nd_body(n));
+        emit_jmp(test);
+        start_block(test);
+        lower_cond(nd_cond(n), body, end);
+        start_block(end);
+        break;
+    }
+    case ND_FOR: {
+        int mark = nvars;
+        if (nd_init(n)) lower_stmt(nd_init(n));
+        IrBlock *body = ir_new_block(fn), *step = ir_new_block(fn);
+        IrBlock *test = ir_new_block(fn), *end  = ir_new_block(fn);
+        emit_jmp(test);
+        start_block(body);
+        lower_stmt(nd_body(n));
+        emit_jmp(step);
+        start_block(step);
+        if (nd_inc(n)) lower_stmt(nd_inc(n));
+        emit_jmp(test);
+        start_block(test);
+        if (nd_cond(n)) lower_cond(nd_cond(n), body, end);
+        else            emit_jmp(body);
+        start_block(end);
+        nvars = mark;
+        break;
+    }
+    case ND_DECL: {
+        /* o inicializador é avaliado antes de a nova local ficar visível */
+        int     k = next_decl++;
+        Operand v = nd_init(n) ? lower_expr(nd_init(n)) : opd_none();
+        Var    *x = push_var(nd_name(n), k);
+        if (addr_taken[k]) {
+            x->slot = fn->nslots++;
+            if (nd_init(n))
+                emit(IR_STORE_LOCAL, -1, opd_none(), v)->imm = x->slot;
+        } else {
+            x->vreg = new_var_vreg();
+            if (nd_init(n))
+                emit_move(x->vreg, v);
+        }
+        break;
+    }
+    case ND_POSTINC:
+    case ND_POSTDEC:
+        lower_incdec(n, 0);
+        break;
+    case ND_CALL:
+        lower_call(n, 0);
+        break;
+    default:
+        lower_expr(n);
+        break;
+    }
+}
+
+static IrFunc *lower_function(NodeId f) {
+    const NodeId *params = nd_list(f);
+    int           nparams = nd_count(f);
+    NodeId        body    = nd_body(f);
+    fn = ir_new_func(nd_name(f), nparams);
+
+    nvars  = 0;
+    ndecls = 0;
+    for (int i = 0; i < nparams; i++)
+        new_decl(nd_name(params[i]));
+    for (int i = 0; i < nd_count(body); i++)
+        mark_addr(nd_list(body)[i]);
+
+    nvars     = 0;
+    next_decl = 0;
+    if (is_var)
+        memset(is_var, 0, is_var_cap);
+    start_block(ir_new_block(fn));
+
+    /* parâmetros: todos os PARAM juntos no início do bloco de entrada */
+    int *tmp = arena_alloc(&compile_arena, sizeof(int) * (nparams ? nparams : 1));
+    for (int i = 0; i < nparams; i++) {
+        Var *x = push_var(nd_name(params[i]), next_decl++);
+        if (addr_taken[x->decl]) {
+            x->slot = fn->nslots++;
+            tmp[i]  = new_temp();
+        } else {
+            tmp[i]  = x->vreg = new_var_vreg();
+        }
+        emit(IR_PARAM, tmp[i], opd_none(), opd_none())->imm = i;
+    }
+    for (int i = 0; i < nparams; i++)
+        if (vars[i].slot >= 0)
+            emit(IR_STORE_LOCAL, -1, opd_none(), opd_vreg(tmp[i]))->imm = vars[i].slot;
+
+    for (int i = 0; i < nd_count(body); i++)
+        lower_stmt(nd_list(body)[i]);
+    /* queda no fim da função: devolve 0 */
+    if (!cur->last || !ir_is_terminator(cur->last->op))
+        emit(IR_RET, -1, opd_imm(0), opd_none());
+
+    ir_cleanup(fn);
+    return fn;
+}
+
+/* Inicializador constante de global: literais com + - * / % e
+ * comparações. Divisão por zero (ou INT_MIN / -1) não é constante. */
+static int const_value(NodeId n, int *out) {
+    int l, r;
+    switch (nd_kind(n)) {
+    case ND_NUM:
+        *out = nd_val(n);
+        return 1;
+    case ND_ADD: case ND_SUB: case ND_MUL: case ND_DIV: case ND_MOD:
+    case ND_EQ: case ND_NE: case ND_LT: case ND_LE:
+        if (!const_value(nd_lhs(n), &l) || !const_value(nd_rhs(n), &r))
+            return 0;
+        if ((nd_kind(n) == ND_DIV || nd_kind(n) == ND_MOD) && (r == 0 || (l == INT_MIN && r == -1)))
+            return 0;
+        switch (nd_kind(n)) {
+        case ND_ADD: *out = (int)((unsigned)l + (unsigned)r); break;
+        case ND_SUB: *out = (int)((unsigned)l - (unsigned)r); break;
+        case ND_MUL: *out = (int)((unsigned)l * (unsigned)r); break;
+        case ND_DIV: *out = l / r;  break;
+        case ND_MOD: *out = l % r;  break;
+        case ND_EQ:  *out = l == r; break;
+        case ND_NE:  *out = l != r; break;
+        case ND_LT:  *out = l < r;  break;
+        default:     *out = l <= r; break;
+        }
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+IrProgram *ir_build(NodeId root) {
+    IrProgram *p = arena_calloc(&compile_arena, sizeof(IrProgram));
+    IrFunc   **ftail = &p->funcs;
+    IrGlobal **gtail = &p->globals;
+    int errors = 0;
+    for (int i = 0; root && i < nd_count(root); i++) {
+        NodeId n = nd_list(root)[i];
+        if (nd_kind(n) == ND_DECL) {
+            IrGlobal *g = arena_calloc(&compile_arena, sizeof(IrGlobal));
+            g->name     = nd_name(n);
+            g->has_init = nd_init(n) != 0;
+            if (nd_init(n) && !const_value(nd_init(n), &g->init)) {
+                // sem valor em tempo de compilação: nada de '.word 0' calado
+                Token t = nd_token(nd_init(n));
+                fprintf(stderr, "%d:%d: ", t.line, t.col);
+                fprintf(stderr, "erro: inicializador da global '%s' não é constante\n", nd_name(n));
+                errors++;
+            }
+            *gtail = g;
+            gtail  = &g->next;
+        } else if (nd_kind(n) == ND_FUNC) {
+            *ftail = lower_function(n);
+            ftail  = &(*ftail)->next;
+        }
+    }
+    free(vars);
+    free(addr_taken);
+    free(is_var);
+    vars = NULL; addr_taken = NULL; is_var = NULL;
+    vars_cap = decls_cap = is_var_cap = 0;
+    return errors ? NULL : p;
+}
@@ -0,0 +1,157 @@
+#include "ir.h"
+#include "arena.h"
+
+/* Chamadas em posição de cauda: 'call' seguido de 'ret' do seu valor.
+ *
+ * Uma chamada da própria função vira laço: os argumentos são copiados
+ * para os vregs dos parâmetros e o fluxo volta ao início do corpo (um
+ * bloco novo logo depois dos PARAMs). Também 'return x * f(...)' e
+ * 'return x + f(...)' viram laço com um acumulador: a soma e o produto
+ * de inteiros (módulo 2^32) são associativos e comutativos, então
+ * acc*f(...) com acc *= x dá o mesmo que x*f(...); os demais 'ret v'
+ * passam a devolver acc*v.
+ *
+ * Chamadas a outras funções viram IR_TAILCALL, que o gerador emite
+ * como 'b' depois de desfazer o quadro. Só com até 4 argumentos (nada
+ * na pilha do chamador) e sem locais com '&', cujo endereço poderia
+ * estar nos argumentos e não sobrevive ao quadro desfeito. */
+
+#define REG_ARGS 4      // argumentos passados em r0–r3
+
+typedef enum { SITE_NONE, SITE_SELF, SITE_ACC, SITE_OTHER } SiteKind;
+
+// Classifica o fim do bloco b; em SITE_ACC, *op é a instrução de acumulação
+static SiteKind classify(IrFunc *f, IrBlock *b, IrInst **call, IrInst **op) {
+    IrInst *t = b->last, *p = t ? t->prev : NULL;
+    if (!t || t->op != IR_RET || !p)
+        return SITE_NONE;
+    if (p->op == IR_CALL &&
+        (p->dst < 0 ? t->a.kind == OPD_NONE : t->a.kind == OPD_VREG && t->a.v == p->dst)) {
+        *call = p;
+        return p->sym == f->name ? SITE_SELF : SITE_OTHER;
+    }
+    /* %c = call f(...); %r = op x, %c; ret %r */
+    IrInst *c = p->prev;
+    if ((p->op == IR_ADD || p->op == IR_MUL) && c && c->op == IR_CALL && c->dst >= 0 &&
+        c->sym == f->name && t->a.kind == OPD_VREG && t->a.v == p->dst) {
+        int in_a = p->a.kind == OPD_VREG && p->a.v == c->dst;
+        int in_b = p->b.kind == OPD_VREG && p->b.v == c->dst;
+        if (in_a != in_b) {
+            *call = c;
+            *op   = p;
+            return SITE_ACC;
+        }
+    }
+    return SITE_NONE;
+}
+
+void ir_tailcall(IrFunc *f) {
+    if (f->nslots)
+        return;
+
+    int nself = 0, nacc = 0, accok = 1;
+    IrOp accop = IR_ADD;
+    for (IrBlock *b = f->entry; b; b = b->next) {
+        IrInst *c, *op;
+        switch (classify(f, b, &c, &op)) {
+        case SITE_SELF:
+            nself++;
+            break;
+        case SITE_ACC:
+            if (nacc++ && op->op != accop)
+                accok = 0;              // '+' e '*' misturados
+            accop = op->op;
+            break;
+        case SITE_NONE:
+            if (b->last && b->last->op == IR_RET && b->last->a.kind == OPD_NONE)
+                accok = 0;              // ret sem valor não acumula
+            break;
+        default:
+            break;
+        }
+    }
+    if (!accok)
+        nacc = 0;
+
+    if (nself || nacc) {
+        /* entrada: PARAMs (e o acumulador); o resto vai para 'head' */
+        IrBlock *entry = f->entry, *head = ir_new_block(f);
+        IrInst *first = entry->first;
+        while (first && first->op == IR_PARAM)
+            first = first->next;
+        if (first) {
+            head->first = first;
+            head->last  = entry->last;
+            entry->last = first->prev;
+            if (first->prev) first->prev->next = NULL;
+            else             entry->first      = NULL;
+            first->prev = NULL;
+        }
+        ir_place_after(f, entry, head);
+
+        int *param = arena_alloc(&compile_arena, sizeof(int) * (f->nparams + 1));
+        for (int k = 0; k < f->nparams; k++)
+            param[k] = -1;              // parâmetro sem uso: PARAM removido
+        for (IrInst *i = entry->first; i; i = i->next)
+            param[i->imm] = i->dst;
+        int acc = -1;
+        if (nacc) {
+            acc = ir_new_vreg(f);
+            IrInst *i = ir_append(entry, IR_MOV);
+            i->dst = acc;
+            i->a   = opd_imm(accop == IR_MUL ? 1 : 0);
+        }
+        ir_append(entry, IR_JMP)->target = head;
+
+        for (IrBlock *b = head; b; b = b->next) {
+            IrInst *c, *op = NULL;
+            SiteKind k = classify(f, b, &c, &op);
+            IrInst *t = b->last;
+            if ((k == SITE_ACC && !nacc) || (k == SITE_OTHER && nacc))
+                k = SITE_NONE;          // ret comum (com acumulador, se houver)
+            if (k == SITE_SELF || k == SITE_ACC) {
+                if (op) {               // acc = acc op x
+                    Operand x = op->a.kind == OPD_VREG && op->a.v == c->dst ? op->b : op->a;
+                    IrInst *i = ir_insert_before(t, b, accop);
+                    i->dst = acc;
+                    i->a   = opd_vreg(acc);
+                    i->b   = x;
+                    ir_remove(b, op);
+                }
+                /* cópia em dois passos: os argumentos podem ler parâmetros */
+                int *tmp = arena_alloc(&compile_arena, sizeof(int) * (c->nargs + 1));
+                for (int k2 = 0; k2 < c->nargs; k2++) {
+                    IrInst *i = ir_insert_before(t, b, IR_MOV);
+                    i->dst = tmp[k2] = ir_new_vreg(f);
+                    i->a   = c->args[k2];
+                }
+                for (int k2 = 0; k2 < c->nargs && k2 < f->nparams; k2++) {
+                    if (param[k2] < 0) continue;
+                    IrInst *i = ir_insert_before(t, b, IR_MOV);
+                    i->dst = param[k2];
+                    i->a   = opd_vreg(tmp[k2]);
+                }
+                ir_remove(b, c);
+                t->op     = IR_JMP;
+                t->a      = opd_none();
+                t->target = head;
+            } else if (k == SITE_NONE && nacc && t && t->op == IR_RET) {
+                IrInst *i = ir_insert_before(t, b, accop);
+                i->dst = ir_new_vreg(f);
+                i->a   = opd_vreg(acc);
+                i->b   = t->a;
+                t->a   = opd_vreg(i->dst);
+            }
+        }
+    }
+
+    for (IrBlock *b = f->entry; b; b = b->next) {
+        IrInst *c, *op;
+        if (classify(f, b, &c, &op) != SITE_OTHER || c->nargs > REG_ARGS)
+            continue;
+        ir_remove(b, b->last);          // o ret
+        c->op  = IR_TAILCALL;
+        c->dst = -1;
+    }
+    ir_build_cfg(f);
+}
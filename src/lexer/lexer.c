@@ -1,39 +1,88 @@
 // src/lexer/lexer.c
+#define _POSIX_C_SOURCE 200809L
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
+#include <stdint.h>
 #include "lexer.h"
+#include "arena.h"
+#include "intern.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 // forward declaration
-static Token *tokenize_buffer(const char *buf);
+static Token *tokenize_buffer(const char *p, const char *end);
 
-// Lê arquivo inteiro em buffer (terminado em '\0')
+// Lê arquivo inteiro em buffer (terminado em '\0') alocado na arena
 char *read_file(const char *path) {
     FILE *f = fopen(path, "rb");
     if (!f) { perror(path); exit(1); }
     fseek(f, 0, SEEK_END);
     long sz = ftell(f);
     rewind(f);
-    char *buf = malloc(sz + 1);
-    if (!buf) { perror("malloc"); exit(1); }
+    char *buf = arena_alloc(&compile_arena, sz + 1);
     fread(buf, 1, sz, f);
     buf[sz] = '\0';
     fclose(f);
     return buf;
 }
 
+// Mapeia o arquivo somente leitura. O lexer precisa de um '\0' após o último
+// byte: o mmap garante zeros no resto da última página, então só mapeamos
+// quando o tamanho não é múltiplo da página; senão cai no read_file.
+void source_open(SourceFile *sf, const char *path) {
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) { perror(path); exit(1); }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        size_t sz   = (size_t)st.st_size;
+        long   page = sysconf(_SC_PAGESIZE);
+        if (page > 0 && sz % (size_t)page != 0) {
+            void *m = mmap(NULL, sz, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (m != MAP_FAILED) {
+                close(fd);
+                sf->data   = m;
+                sf->len    = sz;
+                sf->mapped = 1;
+                return;
+            }
+        }
+    }
+    close(fd);
+#endif
+    char *buf  = read_file(path);
+    sf->data   = buf;
+    sf->len    = strlen(buf);
+    sf->mapped = 0;
+}
+
+void source_close(SourceFile *sf) {
+#ifndef _WIN32
+    if (sf->mapped)
+        munmap((void *)sf->data, sf->len);
+#endif
+    sf->data   = NULL;
+    sf->len    = 0;
+    sf->mapped = 0;
+}
+
 // Tokeniza um buffer em memória; não libera buf
 Token *tokenize(const char *buf) {
-    return tokenize_buffer(buf);
+    return tokenize_buffer(buf, buf + strlen(buf));
+}
+
+Token *tokenize_n(const char *buf, size_t len) {
+    return tokenize_buffer(buf, buf + len);
 }
 
-// Wrapper legado: lê + tokeniza + libera buf
+// Wrapper legado: lê + tokeniza (buffer e tokens ficam na arena)
 Token *tokenize_file(const char *path) {
-    char *buf = read_file(path);
-    Token *toks = tokenize(buf);
-    free(buf);
-    return toks;
+    return tokenize(read_file(path));
 }
 
 // Imprime tokens até TK_EOF
@@ -46,91 +95,266 @@ void print_tokens(Token *tokens) {
     printf("%2d:%2d %-12d '<EOF>'\n", tokens->line, tokens->col, TK_EOF);
 }
 
-// Libera cada lexema e o vetor de tokens
-void free_tokens(Token *tokens) {
-    for (Token *t = tokens; t->kind != TK_EOF; ++t) {
-        free((char *)t->lexeme);
+/* ------------------------------------------------------------------------
+ * Classes de caractere: uma consulta à tabela substitui isspace/isalpha/...
+ * (que dependem do locale) e o switch de símbolos.
+ * ---------------------------------------------------------------------- */
+enum {
+    CC_SPACE = 1 << 0,   // ' ' \t \r \v \f  ('\n' é tratado à parte)
+    CC_IDENT = 1 << 1,   // [A-Za-z_]
+    CC_DIGIT = 1 << 2,   // [0-9]
+    CC_HEX   = 1 << 3,   // [0-9A-Fa-f]
+};
+
+#define CC_RANGE(lo, hi, c) [lo ... hi] = (c)
+static const unsigned char char_class[256] = {
+    [' '] = CC_SPACE, ['\t'] = CC_SPACE, ['\r'] = CC_SPACE,
+    ['\v'] = CC_SPACE, ['\f'] = CC_SPACE,
+    CC_RANGE('a', 'f', CC_IDENT | CC_HEX), CC_RANGE('g', 'z', CC_IDENT),
+    CC_RANGE('A', 'F', CC_IDENT | CC_HEX), CC_RANGE('G', 'Z', CC_IDENT),
+    ['_'] = CC_IDENT,
+    CC_RANGE('0', '9', CC_DIGIT | CC_HEX),
+};
+#undef CC_RANGE
+
+// Símbolos de um caractere (0 = inválido sozinho)
+static const unsigned char sym_kind[256] = {
+    ['+'] = TK_SYM_PLUS,   ['-'] = TK_SYM_MINUS,  ['*'] = TK_SYM_STAR,
+    ['&'] = TK_SYM_AMP,    ['/'] = TK_SYM_SLASH,  [';'] = TK_SYM_SEMI,
+    [','] = TK_SYM_COMMA,  ['('] = TK_SYM_LPAREN, [')'] = TK_SYM_RPAREN,
+    ['{'] = TK_SYM_LBRACE, ['}'] = TK_SYM_RBRACE, ['<'] = TK_SYM_LT,
+    ['>'] = TK_SYM_GT,     ['='] = TK_SYM_ASSIGN, ['%'] = TK_SYM_PERCENT,
+};
+
+// Operadores de dois caracteres: cada primeiro caractere tem no máximo um
+static const char          op2_second[256] = {
+    ['='] = '=', ['!'] = '=', ['<'] = '=', ['>'] = '=',
+    ['&'] = '&', ['|'] = '|', ['+'] = '+', ['-'] = '-',
+};
+static const unsigned char op2_kind[256] = {
+    ['='] = TK_EQ,  ['!'] = TK_NEQ, ['<'] = TK_LE,  ['>'] = TK_GE,
+    ['&'] = TK_AND, ['|'] = TK_OR,  ['+'] = TK_INC, ['-'] = TK_DEC,
+};
+
+/* Palavras-chave: hash perfeito (s[0] + s[1] + len) & 15, sem colisões para
+ * o conjunto abaixo; uma única comparação confirma o acerto. */
+typedef struct { const char *kw; unsigned char len, kind; } Keyword;
+static const Keyword kw_table[16] = {
+    [ 1] = { "if",     2, TK_KW_IF     },
+    [ 4] = { "while",  5, TK_KW_WHILE  },
+    [ 5] = { "else",   4, TK_KW_ELSE   },
+    [ 8] = { "for",    3, TK_KW_FOR    },
+    [ 9] = { "void",   4, TK_KW_VOID   },
+    [10] = { "int",    3, TK_KW_INT    },
+    [13] = { "return", 6, TK_KW_RETURN },
+    [15] = { "char",   4, TK_KW_CHAR   },
+};
+
+static TokenKind keyword_kind(const char *s, size_t l) {
+    if (l < 2 || l > 6)
+        return TK_IDENT;
+    const Keyword *k =
+        &kw_table[((unsigned char)s[0] + (unsigned char)s[1] + l) & 15];
+    if (k->len == l && !memcmp(k->kw, s, l))
+        return (TokenKind)k->kind;
+    return TK_IDENT;
+}
+
+/* ------------------------------------------------------------------------
+ * Varreduras em bloco: espaço/tab, identificadores e comentários avançam
+ * 16 (SSE2) ou 32 (AVX2) bytes por iteração; o resto cai no laço escalar.
+ * Os blocos nunca passam de end, pois o mmap só garante um byte após a fonte.
+ * ---------------------------------------------------------------------- */
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define VEC_W 32
+typedef __m256i vec;
+#define vload(p)      _mm256_loadu_si256((const __m256i *)(p))
+#define vset(c)       _mm256_set1_epi8((char)(c))
+#define veq(a, b)     _mm256_cmpeq_epi8(a, b)
+#define vlt(a, b)     _mm256_cmpgt_epi8(b, a)
+#define vadd(a, b)    _mm256_add_epi8(a, b)
+#define vor(a, b)     _mm256_or_si256(a, b)
+#define vmask(a)      ((uint32_t)_mm256_movemask_epi8(a))
+#define VEC_FULL      0xFFFFFFFFu
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define VEC_W 16
+typedef __m128i vec;
+#define vload(p)      _mm_loadu_si128((const __m128i *)(p))
+#define vset(c)       _mm_set1_epi8((char)(c))
+#define veq(a, b)     _mm_cmpeq_epi8(a, b)
+#define vlt(a, b)     _mm_cmplt_epi8(a, b)
+#define vadd(a, b)    _mm_add_epi8(a, b)
+#define vor(a, b)     _mm_or_si128(a, b)
+#define vmask(a)      ((uint32_t)_mm_movemask_epi8(a))
+#define VEC_FULL      0xFFFFu
+#endif
+
+#ifdef VEC_W
+// bytes de v dentro de [lo, hi]: desloca para a faixa com sinal e compara
+static inline vec vrange(vec v, unsigned char lo, unsigned char hi) {
+    vec t = vadd(v, vset(0x80 - lo));
+    return vlt(t, vset(0x80 + (hi - lo) + 1));
+}
+#endif
+
+// Avança sobre ' ' e '\t'
+static const char *skip_blanks(const char *p, const char *end) {
+#ifndef VEC_W
+    (void)end;
+#endif
+#ifdef VEC_W
+    const vec sp = vset(' '), tab = vset('\t');
+    while (end - p >= VEC_W) {
+        vec v = vload(p);
+        uint32_t m = vmask(vor(veq(v, sp), veq(v, tab)));
+        if (m != VEC_FULL)
+            return p + __builtin_ctz(~m);
+        p += VEC_W;
     }
-    free(tokens);
+#endif
+    while (*p == ' ' || *p == '\t') p++;
+    return p;
 }
 
-// Implementação de tokenize_buffer (igual à anterior)
-static Token *tokenize_buffer(const char *p) {
-    size_t cap = 128, len = 0;
-    Token *tokens = malloc(cap * sizeof(Token));
-    int line = 1, col = 1;
+// Avança sobre [A-Za-z0-9_]
+static const char *skip_ident(const char *p, const char *end) {
+#ifndef VEC_W
+    (void)end;
+#endif
+#ifdef VEC_W
+    while (end - p >= VEC_W) {
+        vec v  = vload(p);
+        vec ok = vor(vor(vrange(vor(v, vset(0x20)), 'a', 'z'),
+                         vrange(v, '0', '9')),
+                     veq(v, vset('_')));
+        uint32_t m = vmask(ok);
+        if (m != VEC_FULL)
+            return p + __builtin_ctz(~m);
+        p += VEC_W;
+    }
+#endif
+    while (char_class[(unsigned char)*p] & (CC_IDENT | CC_DIGIT)) p++;
+    return p;
+}
+
+// Primeira ocorrência de a ou b em [p, end); end se não houver
+static const char *find_either(const char *p, const char *end, char a, char b) {
+#ifdef VEC_W
+    const vec va = vset(a), vb = vset(b);
+    while (end - p >= VEC_W) {
+        vec v = vload(p);
+        uint32_t m = vmask(vor(veq(v, va), veq(v, vb)));
+        if (m)
+            return p + __builtin_ctz(m);
+        p += VEC_W;
+    }
+#endif
+    while (p < end && *p != a && *p != b) p++;
+    return p;
+}
+
+void lexer_init(Lexer *lx, const char *src, size_t len) {
+    lx->p    = src;
+    lx->end  = src + len;
+    lx->line = 1;
+    lx->col  = 1;
+}
+
+// Produz o próximo token; no fim da fonte devolve TK_EOF indefinidamente
+Token lexer_next(Lexer *lx) {
+    const char *p = lx->p, *end = lx->end;
+    int line = lx->line, col = lx->col;
+    Token tok;
     #define EMIT(kind, start, l) do {                                         \
-        if (len+1 >= cap) { cap *= 2;                                         \
-            tokens = realloc(tokens, cap * sizeof(Token));                    \
-            if (!tokens) { perror("realloc"); exit(1); }                      \
-        }                                                                     \
-        char *lex = malloc((l) + 1);                                          \
-        if (!lex) { perror("malloc"); exit(1); }                              \
-        memcpy(lex, start, (l));                                              \
-        lex[(l)] = '\0';                                                      \
-        tokens[len++] = (Token){kind, lex, l, line, col,                      \
-            (kind==TK_NUM ? strtol(start, NULL, 0) : 0)};                     \
+        tok = (Token){kind, start, l, line, col,                              \
+            (kind==TK_NUM ? strtol(start, NULL, 0) : 0),                      \
+            (kind==TK_IDENT ? intern(start, l) : NULL)};                      \
         col += l;                                                             \
+        goto done;                                                            \
     } while (0)
 
-    while (*p) {
-        if (*p == '\n') { p++; line++; col = 1; continue; }
-        if (isspace((unsigned char)*p)) { p++; col++; continue; }
-        if (p[0]=='/' && p[1]=='/') { while (*p && *p!='\n') p++; continue; }
-        if (p[0]=='/' && p[1]=='*') { p+=2; while (p[0] && !(p[0]=='*'&&p[1]=='/')) p++; p+=2; continue; }
-        if (isalpha((unsigned char)*p) || *p=='_') {
+    while (p < end) {
+        unsigned char c  = (unsigned char)*p;
+        unsigned char cc = char_class[c];
+        if (c == '\n') { p++; line++; col = 1; continue; }
+        if (cc & CC_SPACE) {
+            const char *q = skip_blanks(p + 1, end);
+            col += (int)(q - p);
+            p = q;
+            continue;
+        }
+        if (cc & CC_IDENT) {
             const char *start = p;
-            while (isalnum((unsigned char)*p)||*p=='_') p++;
+            p = skip_ident(p + 1, end);
             size_t l = p - start;
-            TokenKind k = TK_IDENT;
-            if (l==3 && !memcmp(start,"int",3)) k = TK_KW_INT;
-            else if (l==6 && !memcmp(start,"return",6)) k=TK_KW_RETURN;
-            else if (l==2 && !memcmp(start,"if",2)) k=TK_KW_IF;
-            else if (l==4 && !memcmp(start,"else",4)) k=TK_KW_ELSE;
-            else if (l==5 && !memcmp(start,"while",5)) k=TK_KW_WHILE;
-            else if (l==3 && !memcmp(start,"for",3)) k=TK_KW_FOR;
-            else if (l==4 && !memcmp(start,"void",4)) k = TK_KW_VOID;
-            EMIT(k, start, l);
-            continue;
+            EMIT(keyword_kind(start, l), start, l);
         }
-        if (isdigit((unsigned char)*p)) {
+        if (cc & CC_DIGIT) {
             const char *start = p;
-            if (p[0]=='0' && (p[1]=='x'||p[1]=='X')) { p+=2; while (isxdigit((unsigned char)*p)) p++; }
-            else { while (isdigit((unsigned char)*p)) p++; }
+            if (p[0]=='0' && (p[1]=='x'||p[1]=='X')) {
+                p += 2;
+                while (char_class[(unsigned char)*p] & CC_HEX) p++;
+            } else {
+                while (char_class[(unsigned char)*p] & CC_DIGIT) p++;
+            }
             EMIT(TK_NUM, start, p-start);
+        }
+        if (c == '/' && p[1] == '/') {
+            p = find_either(p + 2, end, '\n', '\n');
             continue;
         }
-        if (p[0]=='=' && p[1]=='=') { EMIT(TK_EQ,p,2); p+=2; continue; }
-        if (p[0]=='!' && p[1]=='=') { EMIT(TK_NEQ,p,2); p+=2; continue; }
-        if (p[0]=='<' && p[1]=='=') { EMIT(TK_LE,p,2); p+=2; continue; }
-        if (p[0]=='>' && p[1]=='=') { EMIT(TK_GE,p,2); p+=2; continue; }
-        if (p[0]=='&' && p[1]=='&') { EMIT(TK_AND,p,2); p+=2; continue; }
-        if (p[0]=='|' && p[1]=='|') { EMIT(TK_OR,p,2); p+=2; continue; }
-        if (p[0]=='+' && p[1]=='+') { EMIT(TK_INC, p, 2); p+=2; continue; }
-        if (p[0]=='-' && p[1]=='-') { EMIT(TK_DEC, p, 2); p+=2; continue; }
-        TokenKind sk;
-        switch (*p) {
-            case '+': sk = TK_SYM_PLUS;   break;
-            case '-': sk = TK_SYM_MINUS;  break;
-            case '*': sk = TK_SYM_STAR;   break;
-            case '&': sk = TK_SYM_AMP;    break;
-            case '/': sk = TK_SYM_SLASH;  break;
-            case ';': sk = TK_SYM_SEMI;   break;
-            case ',': sk = TK_SYM_COMMA;  break;
-            case '(': sk = TK_SYM_LPAREN; break;
-            case ')': sk = TK_SYM_RPAREN; break;
-            case '{': sk = TK_SYM_LBRACE; break;
-            case '}': sk = TK_SYM_RBRACE; break;
-            case '<': sk = TK_SYM_LT;     break;
-            case '>': sk = TK_SYM_GT;     break;
-            case '=': sk = TK_SYM_ASSIGN; break;
-            default:
-                fprintf(stderr, "%d:%d: caractere inválido '%c'\n", line, col, *p);
-                exit(1);
+        if (c == '/' && p[1] == '*') {
+            const char *q = p + 2;
+            col += 2;
+            for (;;) {
+                const char *r = find_either(q, end, '*', '\n');
+                col += (int)(r - q);
+                if (r == end) { q = end; break; }
+                if (*r == '\n') { line++; col = 1; q = r + 1; continue; }
+                if (r[1] == '/') { q = r + 2; col += 2; break; }
+                q = r + 1;
+                col++;
+            }
+            p = q;
+            continue;
+        }
+        if (op2_second[c] && p[1] == op2_second[c]) {
+            p += 2;
+            EMIT((TokenKind)op2_kind[c], p - 2, 2);
+        }
+        if (!sym_kind[c]) {
+            fprintf(stderr, "%d:%d: caractere inválido '%c'\n", line, col, *p);
+            exit(1);
         }
-        EMIT(sk, p, 1);
         p++;
+        EMIT((TokenKind)sym_kind[c], p - 1, 1);
     }
     EMIT(TK_EOF, p, 0);
+    #undef EMIT
+done:
+    lx->p    = p;
+    lx->line = line;
+    lx->col  = col;
+    return tok;
+}
+
+// Caminho de vetor completo (modo -tokens): puxa tokens até TK_EOF
+static Token *tokenize_buffer(const char *p, const char *end) {
+    // ~1 token a cada 4 bytes de fonte típica: reservar de início evita
+    // recópias do vetor; páginas nunca tocadas não custam memória real
+    size_t cap = (size_t)(end - p) / 4 + 128, len = 0;
+    Token *tokens = arena_alloc(&compile_arena, cap * sizeof(Token));
+    Lexer lx;
+    lexer_init(&lx, p, (size_t)(end - p));
+    do {
+        if (len + 1 >= cap) {
+            tokens = arena_grow(&compile_arena, tokens,
+                                cap * sizeof(Token), 2 * cap * sizeof(Token));
+            cap *= 2;
+        }
+        tokens[len] = lexer_next(&lx);
+    } while (tokens[len++].kind != TK_EOF);
     return tokens;
-}
\ No newline at end of file
+}
@@ -4,20 +4,43 @@
 #include "token.h"
 
 
-// Lê todo o arquivo em memória; quem chamar deve liberar o retorno
+// Lê todo o arquivo em memória; o buffer pertence à compile_arena
 char *read_file(const char *path);
 
-// Tokeniza um buffer em memória; NÃO libera src
+// Código-fonte em memória: mapeado (mmap) ou lido para a arena.
+// Os tokens apontam direto para data, portanto a fonte deve continuar
+// aberta enquanto tokens/AST estiverem em uso.
+typedef struct SourceFile {
+    const char *data;   // terminado em '\0'
+    size_t len;
+    int mapped;         // 1 se veio de mmap
+} SourceFile;
+
+void source_open(SourceFile *sf, const char *path);
+void source_close(SourceFile *sf);
+
+// Tokeniza um buffer em memória; o vetor vive na compile_arena e cada
+// lexema é uma fatia (lexeme, len) de src, sem cópia nem '\0' final
 Token *tokenize(const char *src);
 
-// Wrapper legado: read_file + tokenize + free(src)
+// Igual a tokenize, com o tamanho já conhecido (src[len] deve ser '\0')
+Token *tokenize_n(const char *src, size_t len);
+
+// Lexer incremental: produz um token por chamada, sem vetor intermediário.
+// Os tokens devolvidos são valores; lexeme aponta para a fonte.
+typedef struct Lexer {
+    const char *p, *end;    // posição atual e fim da fonte (*end == '\0')
+    int line, col;
+} Lexer;
+
+void  lexer_init(Lexer *lx, const char *src, size_t len);
+Token lexer_next(Lexer *lx);   // TK_EOF repetido ao fim da fonte
+
+// Wrapper legado: read_file + tokenize
 Token *tokenize_file(const char *path);
 
 // Imprime tokens até TK_EOF
 void print_tokens(Token *tokens);
 
-// Libera o vetor de tokens e cada lexema alocado
-void free_tokens(Token *tokens);
-
 
 #endif // LEXER_H
\ No newline at end of file
@@ -1,78 +1,84 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include "lexer/lexer.h"   // já declara read_file, tokenize, print_tokens, free_tokens
-#include "parser/parser.h" // declara parse_program, free_node, Node, etc.
+#include "lexer/lexer.h"   // já declara read_file, tokenize, print_tokens
+#include "parser/parser.h" // declara parse_program, Node, etc.
 #include "sema/sema.h"     // sema_analyze, SemaContext
+#include "ir/ir.h"
 #include "code_generator/code_generator.h"
+#include "code_generator/isel.h"
+#include "arena.h"
 
 // Imprime AST em formato prefixado
-static void print_ast(Node *n, int indent)
+static void print_ast(NodeId n, int indent)
 {
     if (!n)
         return;
     for (int i = 0; i < indent; i++)
         putchar(' ');
-    switch (n->kind)
+    switch (nd_kind(n))
     {
     case ND_NUM:
-        printf("(NUM %d)\n", n->val);
+        printf("(NUM %d)\n", nd_val(n));
         break;
     case ND_VAR:
-        printf("(VAR %s)\n", n->name);
+        printf("(VAR %s)\n", nd_name(n));
         break;
     case ND_ADD:
     case ND_SUB:
     case ND_MUL:
     case ND_DIV:
+    case ND_MOD:
     case ND_EQ:
     case ND_NE:
     case ND_LT:
     case ND_LE:
     case ND_ASSIGN:
     {
+        NodeKind k = nd_kind(n);
         const char *op =
-            n->kind == ND_ADD ? "ADD" : n->kind == ND_SUB ? "SUB"
-                                    : n->kind == ND_MUL   ? "MUL"
-                                    : n->kind == ND_DIV   ? "DIV"
-                                    : n->kind == ND_EQ    ? "EQ"
-                                    : n->kind == ND_NE    ? "NE"
-                                    : n->kind == ND_LT    ? "LT"
-                                    : n->kind == ND_LE    ? "LE"
-                                                          : "ASSIGN";
+            k == ND_ADD ? "ADD" : k == ND_SUB ? "SUB"
+                                : k == ND_MUL   ? "MUL"
+                                : k == ND_DIV   ? "DIV"
+                                : k == ND_MOD   ? "MOD"
+                                : k == ND_EQ    ? "EQ"
+                                : k == ND_NE    ? "NE"
+                                : k == ND_LT    ? "LT"
+                                : k == ND_LE    ? "LE"
+                                                : "ASSIGN";
         printf("(%s\n", op);
-        print_ast(n->lhs, indent + 2);
-        print_ast(n->rhs, indent + 2);
+        print_ast(nd_lhs(n), indent + 2);
+        print_ast(nd_rhs(n), indent + 2);
         break;
     }
     case ND_CALL:
-        printf("(CALL %s\n", n->name);
-        for (int i = 0; i < n->arg_count; i++)
-            print_ast(n->args[i], indent + 2);
+        printf("(CALL %s\n", nd_name(n));
+        for (int i = 0; i < nd_count(n); i++)
+            print_ast(nd_list(n)[i], indent + 2);
         break;
     case ND_DECL:
-        printf("(DECL %s\n", n->name);
-        if (n->init)
-            print_ast(n->init, indent + 2);
+        printf("(DECL %s\n", nd_name(n));
+        if (nd_init(n))
+            print_ast(nd_init(n), indent + 2);
         break;
     case ND_RETURN:
         printf("(RETURN\n");
-        if (n->lhs)
-            print_ast(n->lhs, indent + 2);
+        if (nd_lhs(n))
+            print_ast(nd_lhs(n), indent + 2);
         break;
     case ND_IF:
         printf("(IF\n");
         // condição
-        print_ast(n->lhs, indent + 2);
+        print_ast(nd_cond(n), indent + 2);
         // then
-        print_ast(n->rhs, indent + 2);
+        print_ast(nd_then(n), indent + 2);
         // else, se existir
-        if (n->els)
+        if (nd_else(n))
         {
             for (int i = 0; i < indent + 2; i++)
                 putchar(' ');
             printf("(ELSE\n");
-            print_ast(n->els, indent + 4);
+            print_ast(nd_else(n), indent + 4);
             for (int i = 0; i < indent + 2; i++)
                 putchar(' ');
             printf(")\n");
@@ -81,57 +87,57 @@ static void print_ast(Node *n, int indent)
     case ND_WHILE:
         printf("(WHILE\n");
         // imprime cond
-        print_ast(n->lhs, indent + 2);
+        print_ast(nd_cond(n), indent + 2);
         // imprime corpo
-        print_ast(n->rhs, indent + 2);
+        print_ast(nd_body(n), indent + 2);
         break;
     case ND_FOR:
         printf("(FOR\n");
-        if (n->init)
-            print_ast(n->init, indent + 2);
-        if (n->cond)
-            print_ast(n->cond, indent + 2);
-        if (n->inc)
-            print_ast(n->inc, indent + 2);
-        if (n->rhs)
-            print_ast(n->rhs, indent + 2);
+        if (nd_init(n))
+            print_ast(nd_init(n), indent + 2);
+        if (nd_cond(n))
+            print_ast(nd_cond(n), indent + 2);
+        if (nd_inc(n))
+            print_ast(nd_inc(n), indent + 2);
+        if (nd_body(n))
+            print_ast(nd_body(n), indent + 2);
         break;
     case ND_POSTINC:
         printf("(POSTINC\n");
-        print_ast(n->lhs, indent + 2);
+        print_ast(nd_lhs(n), indent + 2);
         break;
     case ND_POSTDEC:
         printf("(POSTDEC\n");
-        print_ast(n->lhs, indent + 2);
+        print_ast(nd_lhs(n), indent + 2);
         break;
     case ND_BLOCK:
         printf("(BLOCK\n");
-        for (int i = 0; i < n->stmt_count; i++)
-            print_ast(n->stmts[i], indent + 2);
+        for (int i = 0; i < nd_count(n); i++)
+            print_ast(nd_list(n)[i], indent + 2);
         break;
     case ND_FUNC:
-        printf("(FUNC %s\n", n->name);
-        for (int i = 0; i < n->arg_count; i++)
-            print_ast(n->args[i], indent + 2);
-        for (int i = 0; i < n->stmt_count; i++)
-            print_ast(n->stmts[i], indent + 2);
+        printf("(FUNC %s\n", nd_name(n));
+        for (int i = 0; i < nd_count(n); i++)
+            print_ast(nd_list(n)[i], indent + 2);
+        for (int i = 0; i < nd_count(nd_body(n)); i++)
+            print_ast(nd_list(nd_body(n))[i], indent + 2);
         break;
     case ND_ADDR:
         printf("(&\n");
-        print_ast(n->lhs, indent + 2);
+        print_ast(nd_lhs(n), indent + 2);
         // printf(")\n");
         break;
 
     case ND_DEREF:
         printf("(*\n");
-        print_ast(n->lhs, indent + 2);
+        print_ast(nd_lhs(n), indent + 2);
         // printf(")\n");
         break;
     default:
-        printf("(UNKNOWN %d)\n", n->kind);
+        printf("(UNKNOWN %d)\n", nd_kind(n));
     }
 
-    if (n->kind != ND_NUM && n->kind != ND_VAR){
+    if (nd_kind(n) != ND_NUM && nd_kind(n) != ND_VAR){
         for (int i = 0; i < indent; i++)
             putchar(' ');
         printf(")\n");
@@ -142,7 +148,8 @@ int main(int argc, char **argv)
 {
     init_types();
     /* opções */
-    int mode_tokens = 0, mode_ast = 0, mode_sema = 0, mode_codegen = 0;
+    int mode_tokens = 0, mode_ast = 0, mode_sema = 0, mode_ir = 0, mode_codegen = 0;
+    int stats = 0;
     char *path = NULL;
 
     for (int i = 1; i < argc; i++){
@@ -152,47 +159,83 @@ int main(int argc, char **argv)
             mode_ast = 1;
         else if (!strcmp(argv[i], "-sema"))
             mode_sema = 1;
+        else if (!strcmp(argv[i], "-ir"))
+            mode_ir = 1;
         else if (!strcmp(argv[i], "-S"))
             mode_codegen = 1;
+        else if (!strcmp(argv[i], "-stats"))
+            stats = 1;
+        else if (!strncmp(argv[i], "-finline-limit=", 15))
+            ir_inline_limit = atoi(argv[i] + 15);
+        else if (!strcmp(argv[i], "-fno-loop-opt"))
+            ir_loop_opt = 0;
+        else if (!strncmp(argv[i], "-mcpu=", 6)) {
+            if (!isel_set_cpu(argv[i] + 6)) {
+                fprintf(stderr, "núcleo desconhecido: %s (arm7tdmi, arm9tdmi)\n", argv[i] + 6);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "-mthumb"))
+            codegen_isa = ISA_THUMB;
+        else if (!strcmp(argv[i], "-mthumb=auto"))
+            codegen_isa = ISA_AUTO;
+        else if (!strcmp(argv[i], "-marm"))
+            codegen_isa = ISA_ARM;
         else
             path = argv[i];
     }
-    if (!path || (mode_tokens + mode_ast + mode_sema + mode_codegen) > 1){
+    if (!path || (mode_tokens + mode_ast + mode_sema + mode_ir + mode_codegen) > 1){
         fprintf(stderr,
-                "Uso: %s [-tokens|-ast|-sema|-S] arquivo.c\n"
+                "Uso: %s [-tokens|-ast|-sema|-ir|-S [-stats]] [-finline-limit=N] [-fno-loop-opt] [-mcpu=NÚCLEO] [-marm|-mthumb[=auto]] arquivo.c\n"
                 "  -tokens  imprime lista de tokens\n"
                 "  -ast     imprime AST (prefix)\n"
                 "  -sema    roda análise semântica (padrão)\n"
-                "  -S       gera código assembly\n",
+                "  -ir      imprime a IR de três endereços\n"
+                "  -S       gera código assembly\n"
+                "  -stats   com -S, resume o código gerado em stderr\n"
+                "  -finline-limit=N  expande funções de até N instruções da IR\n"
+                "           (padrão 20; 0 desliga)\n"
+                "  -fno-loop-opt     desliga LICM, redução de força e desenrolamento\n"
+                "  -mcpu=NÚCLEO      custos da seleção de instruções: arm7tdmi (padrão) ou arm9tdmi\n"
+                "  -marm             gera as funções em ARM (padrão)\n"
+                "  -mthumb           gera as funções em Thumb (16 bits), com stubs bx\n"
+                "           para o runtime em ARM\n"
+                "  -mthumb=auto      Thumb nas funções sem laço, ARM nas demais\n",
                 argv[0]);
         return 1;
     }
-    if (!mode_tokens && !mode_ast && !mode_codegen)
+    if (!mode_tokens && !mode_ast && !mode_ir && !mode_codegen)
         mode_sema = 1; /* default */
 
-    /* 1) leitura & tokenização */
-    char *src = read_file(path);
-    Token *toks = tokenize(src);
-    if (!toks){
-        fprintf(stderr, "lexer falhou\n");
-        free(src);
-        return 1;
-    }
+    /* 1) leitura (mmap): lexemas apontam para src.data */
+    SourceFile src;
+    source_open(&src, path);
 
-    if (mode_tokens){ /* só imprime tokens */
+    if (mode_tokens){ /* só imprime tokens: vetor completo */
+        Token *toks = tokenize_n(src.data, src.len);
+        if (!toks){
+            fprintf(stderr, "lexer falhou\n");
+            source_close(&src);
+            arena_release(&compile_arena);
+            ast_release();
+            return 1;
+        }
         print_tokens(toks);
-        free_tokens(toks);
-        free(src);
+        source_close(&src);
+        arena_release(&compile_arena);
+        ast_release();
         return 0;
     }
 
-    /* 2) parsing */
-    Node *ast = parse_program(toks);
+    /* 2) parsing: o parser puxa os tokens do lexer sob demanda */
+    Lexer lx;
+    lexer_init(&lx, src.data, src.len);
+    NodeId ast = parse_program(&lx);
     if (mode_ast){ /* imprime AST e termina */
         print_ast(ast, 0);
-        free_node(ast);
-        free_tokens(toks);
-        free(src);
+        source_close(&src);
+        arena_release(&compile_arena);
+        ast_release();
         return 0;
     }
 
@@ -201,15 +244,36 @@ int main(int argc, char **argv)
     sema_init(&sema);
     if (sema_analyze(&sema, ast) != SEMA_OK){
         fprintf(stderr, "Compilação abortada: erros semânticos\n");
-        free_node(ast);
-        free_tokens(toks);
-        free(src);
+        source_close(&src);
+        arena_release(&compile_arena);
+        ast_release();
         return 1;
     }
     // printf("✓ Semântica OK\n");
     /* mensagens informativas para stderr, não para o .s */
     fprintf(stderr, "✓ Semântica OK\n");
 
+    IrProgram *ir = NULL;
+    if (mode_ir || mode_codegen) {
+        ir = ir_build(ast);
+        if (!ir) {
+            fprintf(stderr, "Compilação abortada: erros na geração da IR\n");
+            source_close(&src);
+            arena_release(&compile_arena);
+            ast_release();
+            return 1;
+        }
+    }
+
+    if (mode_ir) { /* imprime a IR e termina */
+        ir_optimize(ir);
+        ir_dump(ir, stdout);
+        source_close(&src);
+        arena_release(&compile_arena);
+        ast_release();
+        return 0;
+    }
+
     if (mode_codegen) {
         /* NEW: gera foo.s  */
         char out_file[256];
@@ -229,15 +293,20 @@ int main(int argc, char **argv)
         memcpy(out_file, path, len);
         out_file[len] = '\0';
         strcat(out_file, ".s");
-        codegen_to_file(ast, out_file);
+        ir_optimize(ir);
+        CodegenStats st;
+        codegen_to_file(ir, out_file, &st);
+        if (stats)
+            fprintf(stderr, "instruções: %d (peephole removeu %d), %d bytes\n",
+                    st.insns, st.removed, st.bytes);
         // printf("Assembly salvo em %s\n", out_file);
         fprintf(stderr, "Assembly salvo em %s\n", out_file);
 
     }
 
-    /* 4) cleanup geral */
-    free_node(ast);
-    free_tokens(toks);
-    free(src);
+    /* 4) cleanup geral: fonte mapeada + arena da compilação */
+    source_close(&src);
+    arena_release(&compile_arena);
+    ast_release();
     return 0;
 }
\ No newline at end of file
@@ -1,12 +1,21 @@
 #include <stdio.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #include "parser.h"
 #include "../lexer/lexer.h"
 #include "type.h"
-
-// Token stream pointer
-static Token *cur;
+#include "arena.h"
+
+/* Fluxo de tokens: o lexer é puxado sob demanda e só os próximos tokens
+ * ficam num anel de LOOKAHEAD posições (o parser usa no máximo peek(2)).
+ * Ponteiros do anel são temporários: quem ainda precisa de um token depois
+ * de avançar guarda uma cópia por valor (take()). A AST não guarda tokens,
+ * só a posição de cada um na fonte (ver nd_token). */
+#define LOOKAHEAD 4                 // potência de 2, > maior peek + 1
+static Lexer   *lex;
+static Token    ring[LOOKAHEAD];
+static unsigned ring_head, ring_len;
 
 // Error reporting
 static void error_at(Token *tok, const char *msg) {
@@ -14,31 +23,93 @@ static void error_at(Token *tok, const char *msg) {
     exit(1);
 }
 
-static char *copy_str(const char *s) {
-    size_t l = strlen(s);
-    char *r = malloc(l + 1);
-    if (!r) { perror("malloc"); exit(1); }
-    memcpy(r, s, l + 1);
-    return r;
+Ast compile_ast;
+
+// Reserva 'n' posições consecutivas em extra; devolve o índice da primeira
+static uint32_t extra_alloc(size_t n) {
+    Ast *t = &compile_ast;
+    if (t->extra_len + n > t->extra_cap) {
+        size_t cap = t->extra_cap ? t->extra_cap : 1024;
+        while (cap < t->extra_len + n)
+            cap *= 2;
+        if (cap > UINT32_MAX) {
+            fprintf(stderr, "AST grande demais para índices de 32 bits\n");
+            exit(1);
+        }
+        t->extra = realloc(t->extra, sizeof(NodeId) * cap);
+        if (!t->extra) {
+            perror("realloc");
+            exit(1);
+        }
+        t->extra_cap = cap;
+    }
+    uint32_t x = (uint32_t)t->extra_len;
+    t->extra_len += n;
+    return x;
+}
+
+/* Pilha de rascunho para listas de filhos (statements, argumentos,
+ * parâmetros): cada lista guarda a base com scratch_mark(), empilha os
+ * filhos e, no fim, scratch_commit() copia o trecho uma única vez para
+ * posições consecutivas de compile_ast.extra. Listas aninhadas
+ * compartilham a pilha, que cresce geometricamente e é reaproveitada
+ * entre compilações (até ast_release()). */
+static NodeId *scratch;
+static size_t  scratch_len, scratch_cap;
+
+static size_t scratch_mark(void) {
+    return scratch_len;
+}
+static void scratch_push(NodeId n) {
+    if (scratch_len == scratch_cap) {
+        scratch_cap = scratch_cap ? scratch_cap * 2 : 256;
+        scratch = realloc(scratch, sizeof(NodeId) * scratch_cap);
+        if (!scratch) {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    scratch[scratch_len++] = n;
+}
+// Desempilha tudo acima de 'mark' para extra, precedido da contagem;
+// devolve o índice da contagem
+static uint32_t scratch_commit(size_t mark) {
+    size_t   n = scratch_len - mark;
+    uint32_t x = extra_alloc(n + 1);
+    compile_ast.extra[x] = (NodeId)n;
+    memcpy(compile_ast.extra + x + 1, scratch + mark, sizeof(NodeId) * n);
+    scratch_len = mark;
+    return x;
 }
 
 // Stream navigation helpers
 static Token *peek(int n) {
-    return &cur[n];
+    while (ring_len <= (unsigned)n) {
+        ring[(ring_head + ring_len) & (LOOKAHEAD - 1)] = lexer_next(lex);
+        ring_len++;
+    }
+    return &ring[(ring_head + n) & (LOOKAHEAD - 1)];
 }
 static Token *next(void) {
-    return cur++;
+    Token *t = peek(0);
+    ring_head = (ring_head + 1) & (LOOKAHEAD - 1);
+    ring_len--;
+    return t;
+}
+// Consome o token corrente e devolve uma cópia estável
+static Token take(void) {
+    return *next();
 }
 static int consume(TokenKind kind) {
-    if (cur->kind == kind) {
-        cur++;
+    if (peek(0)->kind == kind) {
+        next();
         return 1;
     }
     return 0;
 }
 static Token *expect(TokenKind kind) {
-    if (cur->kind != kind) {
-        error_at(cur, "unexpected token");
+    if (peek(0)->kind != kind) {
+        error_at(peek(0), "unexpected token");
     }
     return next();
 }
@@ -51,135 +122,183 @@ static int count_stars(void) {
     return n;
 }
 
-// AST node constructors
-// AST node constructors (recebem Token *tok para localização)
-static Node *new_node(Token *tok, NodeKind kind) {
-    Node *node = calloc(1, sizeof(Node));
-    node->kind  = kind;
-    node->token = tok;
-    node->type  = NULL;
-    return node;
+// AST node constructors (recebem o token só para a posição e o nome)
+static NodeId new_node(const Token *tok, NodeKind kind) {
+    Ast *t = &compile_ast;
+    if (t->len == t->cap) {
+        t->cap = t->cap ? t->cap * 2 : 1024;
+        if (t->cap > UINT32_MAX) {
+            fprintf(stderr, "AST grande demais para índices de 32 bits\n");
+            exit(1);
+        }
+        t->kind = realloc(t->kind, sizeof *t->kind * t->cap);
+        t->pos  = realloc(t->pos,  sizeof *t->pos  * t->cap);
+        t->type = realloc(t->type, sizeof *t->type * t->cap);
+        t->data = realloc(t->data, sizeof *t->data * t->cap);
+        if (!t->kind || !t->pos || !t->type || !t->data) {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    NodeId n = (NodeId)t->len++;
+    t->kind[n] = (unsigned char)kind;
+    t->pos[n]  = (uint32_t)(tok->lexeme - t->src);
+    t->type[n] = NULL;
+    t->data[n] = (NodeData){0, 0};
+    return n;
 }
 
-static Node *new_node_binary(Token *tok, NodeKind kind, Node *lhs, Node *rhs) {
-    Node *node = new_node(tok, kind);
-    node->lhs  = lhs;
-    node->rhs  = rhs;
-    return node;
+// Guarda um nome internado; devolve seu índice em names
+static uint32_t add_name(const char *name) {
+    Ast *t = &compile_ast;
+    if (t->names_len == t->names_cap) {
+        t->names_cap = t->names_cap ? t->names_cap * 2 : 256;
+        t->names = realloc(t->names, sizeof(const char *) * t->names_cap);
+        if (!t->names) {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    t->names[t->names_len] = name;
+    return (uint32_t)t->names_len++;
 }
 
-static Node *new_node_unary(Token *tok, NodeKind kind, Node *expr) {
-    Node *node = new_node(tok, kind);
-    node->lhs  = expr;
+static NodeId new_node_binary(const Token *tok, NodeKind kind, NodeId lhs, NodeId rhs) {
+    NodeId node = new_node(tok, kind);
+    compile_ast.data[node] = (NodeData){lhs, rhs};
     return node;
 }
 
-static Node *new_node_num(Token *tok) {
-    Node *node = new_node(tok, ND_NUM);
-    node->val  = tok->ival;
-    return node;
+static NodeId new_node_unary(const Token *tok, NodeKind kind, NodeId expr) {
+    return new_node_binary(tok, kind, expr, 0);
 }
 
-static Node *new_node_var(Token *tok) {
-    Node *node = new_node(tok, ND_VAR);
-    node->name = copy_str(tok->lexeme);
-    return node;
+static NodeId new_node_num(const Token *tok, int val) {
+    return new_node_binary(tok, ND_NUM, (uint32_t)val, 0);
+}
+
+static NodeId new_node_var(const Token *tok) {
+    return new_node_binary(tok, ND_VAR, add_name(tok->name), 0);
 }
 
-static Node *new_node_call(Token *tok, const char *name, Node **args, int argc) {
-    Node *node = new_node(tok, ND_CALL);
-    node->name      = copy_str(name);
-    node->args      = args;
-    node->arg_count = argc;
+// Nó com lista de filhos já copiada para extra (ver scratch_commit);
+// ND_CALL e ND_FUNC levam o nome do token
+static NodeId new_node_list(const Token *tok, NodeKind kind, uint32_t x) {
+    uint32_t name = kind == ND_BLOCK ? 0 : add_name(tok->name);
+    return new_node_binary(tok, kind, name, x);
+}
+
+// Nó de declaração com tipo e inicializador (0 se ausente)
+static NodeId new_node_decl(const Token *tok, Type *ty, NodeId init) {
+    NodeId node = new_node_binary(tok, ND_DECL, init, add_name(tok->name));
+    compile_ast.type[node] = ty;
     return node;
 }
 
+// Reconstrói o token de um nó (só para mensagens: relê a fonte)
+Token nd_token(NodeId n) {
+    const Ast  *t   = &compile_ast;
+    const char *at  = t->src + t->pos[n];
+    const char *bol = t->src;
+    Lexer lx;
+    lexer_init(&lx, at, t->src_len - t->pos[n]);
+    Token tok = lexer_next(&lx);
+    // linha e coluna contadas como no lexer (coluna em bytes, a partir de 1)
+    tok.line = 1;
+    for (const char *c = t->src; c < at; c++)
+        if (*c == '\n') {
+            tok.line++;
+            bol = c + 1;
+        }
+    tok.col = (int)(at - bol) + 1;
+    return tok;
+}
+
+void ast_release(void) {
+    Ast *t = &compile_ast;
+    free(t->kind);
+    free(t->pos);
+    free(t->type);
+    free(t->data);
+    free(t->extra);
+    free(t->names);
+    *t = (Ast){0};
+    free(scratch);
+    scratch     = NULL;
+    scratch_len = scratch_cap = 0;
+}
+
 // Forward declarations for recursive functions
-static Node *parse_expression(void);
-static Node *parse_assignment(void);
-static Node *parse_logical_or(void);
-static Node *parse_logical_and(void);
-static Node *parse_equality(void);
-static Node *parse_relational(void);
-static Node *parse_additive(void);
-static Node *parse_multiplicative(void);
-static Node *parse_unary(void);
-static Node *parse_primary(void);
-static Node *parse_postfix(void);
-static Node *parse_statement(void);
-static Node *parse_compound(void);
-static Node *parse_global_decl(void);
-static Node *parse_function_decl(void);
+static NodeId parse_expression(void);
+static NodeId parse_assignment(void);
+static NodeId parse_logical_or(void);
+static NodeId parse_logical_and(void);
+static NodeId parse_equality(void);
+static NodeId parse_relational(void);
+static NodeId parse_additive(void);
+static NodeId parse_multiplicative(void);
+static NodeId parse_unary(void);
+static NodeId parse_primary(void);
+static NodeId parse_postfix(void);
+static NodeId parse_statement(void);
+static NodeId parse_compound(void);
+static NodeId parse_global_decl(void);
+static NodeId parse_function_decl(void);
 
 // Primary expressions: numbers, identifiers, calls, parentheses
-static Node *parse_primary(void) {
+static NodeId parse_primary(void) {
     // ( expr )
     if (consume(TK_SYM_LPAREN)) {
-        Node *node = parse_expression();
+        NodeId node = parse_expression();
         expect(TK_SYM_RPAREN);
         return node;
     }
 
     // literal numérico
-    if (cur->kind == TK_NUM) {
-        Token *tok = cur;
-        // long   v   = tok->ival;
-        next();
-        Node *node = new_node_num(tok);  // sua factory antiga
-        node->token = tok;             // só aqui guardamos a localização
-        return node;
+    if (peek(0)->kind == TK_NUM) {
+        Token tok = take();
+        return new_node_num(&tok, tok.ival);
     }
 
     // identificador ou chamada de função
-    if (cur->kind == TK_IDENT) {
-        Token *tok  = cur;
-        char  *name = copy_str(tok->lexeme);
-        next();
+    if (peek(0)->kind == TK_IDENT) {
+        Token tok = take();            // nome já internado pelo lexer
 
         // chamada de função?
         if (consume(TK_SYM_LPAREN)) {
-            Node **args = NULL;
-            int    argc = 0;
+            size_t mark = scratch_mark();
             if (!consume(TK_SYM_RPAREN)) {
                 do {
-                    Node *arg = parse_expression();
-                    args = realloc(args, sizeof(Node*) * (argc + 1));
-                    args[argc++] = arg;
+                    scratch_push(parse_expression());
                 } while (consume(TK_SYM_COMMA));
                 expect(TK_SYM_RPAREN);
             }
-            Node *call = new_node_call(tok ,name, args, argc);
-            Node *func_var  = new_node_var(tok);  // ND_VAR “add”
-            func_var->token = tok;                // localização
-            call->lhs       = func_var;           // <- ponto-chave
-            call->token = tok;
-            return call;
+            // o Sema resolve a função pelo nome da chamada (o do token)
+            return new_node_list(&tok, ND_CALL, scratch_commit(mark));
         }
 
         // simples uso de variável
-        Node *var = new_node_var(tok);
-        var->token = tok;
-        return var;
+        return new_node_var(&tok);
     }
 
-    error_at(cur, "expected primary expression");
-    return NULL;
+    error_at(peek(0), "expected primary expression");
+    return 0;
 }
 
 
-static Node *parse_postfix(void) {
-    Node *n = parse_primary();
+static NodeId parse_postfix(void) {
+    NodeId n = parse_primary();
     for (;;) {
         // pós-incremento
         if (peek(0)->kind == TK_INC) {
-            Token *tok = next();  // consome '++' e guarda o token
-            n = new_node_unary(tok, ND_POSTINC, n);
+            Token tok = take();   // consome '++' e guarda o token
+            n = new_node_unary(&tok, ND_POSTINC, n);
             continue;
         }
         // pós-decremento
         if (peek(0)->kind == TK_DEC) {
-            Token *tok = next();  // consome '--' e guarda o token
-            n = new_node_unary(tok, ND_POSTDEC, n);
+            Token tok = take();   // consome '--' e guarda o token
+            n = new_node_unary(&tok, ND_POSTDEC, n);
             continue;
         }
         break;
@@ -189,25 +308,24 @@ static Node *parse_postfix(void) {
 
 
 // Unary: +, -, !, then primary
-static Node *parse_unary(void) {
+static NodeId parse_unary(void) {
 
     /* &expr : operador de endereço */
     if (peek(0)->kind == TK_SYM_AMP) {
-        Token *tok = next();              // consome '&'
-        Node  *sub = parse_unary();       // avalia o operando recursivamente
-        Node  *n   = new_node_unary(tok, ND_ADDR, sub);
-        /* type será ajustado no Sema; se quiser já adiantar: */
-        /* n->type = pointer_to(sub->type); */
+        Token tok = take();               // consome '&'
+        NodeId sub = parse_unary();       // avalia o operando recursivamente
+        NodeId n   = new_node_unary(&tok, ND_ADDR, sub);
+        /* type será ajustado no Sema */
         return n;
     }
 
     /* *expr : operador de dereferência */
     if (peek(0)->kind == TK_SYM_STAR) {
-        Token *tok = next();              // consome '*'
-        Node  *sub = parse_unary();
-        Node  *n   = new_node_unary(tok, ND_DEREF, sub);
-        /* Deixe n->type = NULL; o Sema checará se sub->type é ponteiro
-           e então fará n->type = sub->type->base */
+        Token tok = take();               // consome '*'
+        NodeId sub = parse_unary();
+        NodeId n   = new_node_unary(&tok, ND_DEREF, sub);
+        /* tipo fica NULL; o Sema checará se o de sub é ponteiro
+           e então usará o tipo apontado */
         return n;
     }
 
@@ -219,30 +337,35 @@ static Node *parse_unary(void) {
 
     /* -expr : transforma em 0 - expr */
     if (peek(0)->kind == TK_SYM_MINUS) {
-        Token *tok = next();              // consome '-'
-        Node *zero = new_node_num(tok);   // literal 0 com mesmo token
-        zero->val  = 0;
-        return new_node_binary(tok, ND_SUB, zero, parse_unary());
+        Token tok = take();               // consome '-'
+        NodeId zero = new_node_num(&tok, 0); // literal 0 com mesmo token
+        return new_node_binary(&tok, ND_SUB, zero, parse_unary());
     }
 
     /* caso geral → postfix / primary */
     return parse_postfix();
 }
 
-// Multiplicative: *, /
-static Node *parse_multiplicative(void) {
-    Node *node = parse_unary();
+// Multiplicative: *, /, %
+static NodeId parse_multiplicative(void) {
+    NodeId node = parse_unary();
     for (;;) {
         // *
         if (peek(0)->kind == TK_SYM_STAR) {
-            Token *tok = next();  // consome '*'
-            node = new_node_binary(tok, ND_MUL, node, parse_unary());
+            Token tok = take();   // consome '*'
+            node = new_node_binary(&tok, ND_MUL, node, parse_unary());
             continue;
         }
         // /
         if (peek(0)->kind == TK_SYM_SLASH) {
-            Token *tok = next();  // consome '/'
-            node = new_node_binary(tok, ND_DIV, node, parse_unary());
+            Token tok = take();   // consome '/'
+            node = new_node_binary(&tok, ND_DIV, node, parse_unary());
+            continue;
+        }
+        // %
+        if (peek(0)->kind == TK_SYM_PERCENT) {
+            Token tok = take();   // consome '%'
+            node = new_node_binary(&tok, ND_MOD, node, parse_unary());
             continue;
         }
         break;
@@ -252,19 +375,19 @@ static Node *parse_multiplicative(void) {
 
 
 // Additive: +, -
-static Node *parse_additive(void) {
-    Node *node = parse_multiplicative();
+static NodeId parse_additive(void) {
+    NodeId node = parse_multiplicative();
     for (;;) {
         // +
         if (peek(0)->kind == TK_SYM_PLUS) {
-            Token *tok = next();  // consome '+' e captura o token
-            node = new_node_binary(tok, ND_ADD, node, parse_multiplicative());
+            Token tok = take();   // consome '+' e captura o token
+            node = new_node_binary(&tok, ND_ADD, node, parse_multiplicative());
             continue;
         }
         // -
         if (peek(0)->kind == TK_SYM_MINUS) {
-            Token *tok = next();  // consome '-' e captura o token
-            node = new_node_binary(tok, ND_SUB, node, parse_multiplicative());
+            Token tok = take();   // consome '-' e captura o token
+            node = new_node_binary(&tok, ND_SUB, node, parse_multiplicative());
             continue;
         }
         break;
@@ -274,33 +397,33 @@ static Node *parse_additive(void) {
 
 
 // Relational: <, <=, >, >=
-static Node *parse_relational(void) {
-    Node *node = parse_additive();
+static NodeId parse_relational(void) {
+    NodeId node = parse_additive();
     for (;;) {
         // <
         if (peek(0)->kind == TK_SYM_LT) {
-            Token *tok = next();  // consome '<'
-            node = new_node_binary(tok, ND_LT, node, parse_additive());
+            Token tok = take();   // consome '<'
+            node = new_node_binary(&tok, ND_LT, node, parse_additive());
             continue;
         }
         // <=
         if (peek(0)->kind == TK_LE) {
-            Token *tok = next();  // consome '<='
-            node = new_node_binary(tok, ND_LE, node, parse_additive());
+            Token tok = take();   // consome '<='
+            node = new_node_binary(&tok, ND_LE, node, parse_additive());
             continue;
         }
         // >
         if (peek(0)->kind == TK_SYM_GT) {
-            Token *tok = next();  // consome '>'
+            Token tok = take();   // consome '>'
             // transforma 'a > b' em 'b < a', reutilizando tok para localização
-            node = new_node_binary(tok, ND_LT, parse_additive(), node);
+            node = new_node_binary(&tok, ND_LT, parse_additive(), node);
             continue;
         }
         // >=
         if (peek(0)->kind == TK_GE) {
-            Token *tok = next();  // consome '>='
+            Token tok = take();   // consome '>='
             // transforma 'a >= b' em 'b <= a'
-            node = new_node_binary(tok, ND_LE, parse_additive(), node);
+            node = new_node_binary(&tok, ND_LE, parse_additive(), node);
             continue;
         }
         break;
@@ -310,19 +433,19 @@ static Node *parse_relational(void) {
 
 
 // Equality: ==, !=
-static Node *parse_equality(void) {
-    Node *node = parse_relational();
+static NodeId parse_equality(void) {
+    NodeId node = parse_relational();
     for (;;) {
         // ==
         if (peek(0)->kind == TK_EQ) {
-            Token *tok = next();  // consome '=='
-            node = new_node_binary(tok, ND_EQ, node, parse_relational());
+            Token tok = take();   // consome '=='
+            node = new_node_binary(&tok, ND_EQ, node, parse_relational());
             continue;
         }
         // !=
         if (peek(0)->kind == TK_NEQ) {
-            Token *tok = next();  // consome '!='
-            node = new_node_binary(tok, ND_NE, node, parse_relational());
+            Token tok = take();   // consome '!='
+            node = new_node_binary(&tok, ND_NE, node, parse_relational());
             continue;
         }
         break;
@@ -332,13 +455,13 @@ static Node *parse_equality(void) {
 
 
 // Logical AND: &&
-static Node *parse_logical_and(void) {
-    Node *node = parse_equality();
+static NodeId parse_logical_and(void) {
+    NodeId node = parse_equality();
     for (;;) {
         // &&
         if (peek(0)->kind == TK_AND) {
-            Token *tok = next();  // consome '&&'
-            node = new_node_binary(tok, ND_LOGAND, node, parse_equality());
+            Token tok = take();   // consome '&&'
+            node = new_node_binary(&tok, ND_LOGAND, node, parse_equality());
             continue;
         }
         break;
@@ -347,13 +470,13 @@ static Node *parse_logical_and(void) {
 }
 
 // Logical OR: ||
-static Node *parse_logical_or(void) {
-    Node *node = parse_logical_and();
+static NodeId parse_logical_or(void) {
+    NodeId node = parse_logical_and();
     for (;;) {
         // ||
         if (peek(0)->kind == TK_OR) {
-            Token *tok = next();  // consome '||'
-            node = new_node_binary(tok, ND_LOGOR, node, parse_logical_and());
+            Token tok = take();   // consome '||'
+            node = new_node_binary(&tok, ND_LOGOR, node, parse_logical_and());
             continue;
         }
         break;
@@ -362,90 +485,105 @@ static Node *parse_logical_or(void) {
 }
 
 // Assignment: = (right-associative)
-static Node *parse_assignment(void) {
-    Node *node = parse_logical_or();
+static NodeId parse_assignment(void) {
+    NodeId node = parse_logical_or();
     // =
     if (peek(0)->kind == TK_SYM_ASSIGN) {
-        Token *tok = next();  // consome '='
-        node = new_node_binary(tok, ND_ASSIGN, node, parse_assignment());
+        Token tok = take();   // consome '='
+        node = new_node_binary(&tok, ND_ASSIGN, node, parse_assignment());
     }
     return node;
 }
 
 // Expression entry
-static Node *parse_expression(void) {
+static NodeId parse_expression(void) {
     return parse_assignment();
 }
-static Node *parse_statement(void) {
+// Declaradores após 'int': int a, *b = expr;
+// Cada nome vira um ND_DECL empilhado no rascunho da lista corrente.
+static void parse_local_decls(void) {
+    do {
+        // 1) conta ponteiros igual ao global
+        int   stars = count_stars();
+        Type *ty    = ty_int;
+        for (int i = 0; i < stars; i++)
+            ty = pointer_to(ty);
+
+        // 2) jogador de identificador
+        Token id    = *expect(TK_IDENT);
+        NodeId init = 0;
+        if (peek(0)->kind == TK_SYM_ASSIGN) {
+            next();                  // consome '='
+            init = parse_expression();
+        }
+        scratch_push(new_node_decl(&id, ty, init));
+    } while (peek(0)->kind == TK_SYM_COMMA && (next(), 1));
+    expect(TK_SYM_SEMI);
+}
+
+static NodeId parse_statement(void) {
     // 1) bloco aninhado
     if (peek(0)->kind == TK_SYM_LBRACE)
         return parse_compound();
 
     // 2) return-stmt
     if (peek(0)->kind == TK_KW_RETURN) {
-        Token *tok = next();            // consome 'return'
-        Node *n = new_node(tok, ND_RETURN);
-        n->lhs = parse_expression();
+        Token tok = take();             // consome 'return'
+        NodeId n = new_node_unary(&tok, ND_RETURN, parse_expression());
         expect(TK_SYM_SEMI);
         return n;
     }
 
     // 3) if-else
     if (peek(0)->kind == TK_KW_IF) {
-        Token *tok = next();            // consome 'if'
+        Token tok = take();             // consome 'if'
         expect(TK_SYM_LPAREN);
-        Node *cond = parse_expression();
+        NodeId cond = parse_expression();
         expect(TK_SYM_RPAREN);
-        Node *then_branch = parse_statement();
-        Node *else_branch = NULL;
+        NodeId then_branch = parse_statement();
+        NodeId else_branch = 0;
         if (peek(0)->kind == TK_KW_ELSE) {
             next();                      // consome 'else'
             else_branch = parse_statement();
         }
-        Node *n = new_node(tok, ND_IF);
-        n->lhs = cond;
-        n->rhs = then_branch;
-        n->els = else_branch;
-        return n;
+        uint32_t x = extra_alloc(2);
+        compile_ast.extra[x]     = then_branch;
+        compile_ast.extra[x + 1] = else_branch;
+        return new_node_binary(&tok, ND_IF, cond, x);
     }
 
     // 4) while
     if (peek(0)->kind == TK_KW_WHILE) {
-        Token *tok = next();            // consome 'while'
+        Token tok = take();             // consome 'while'
         expect(TK_SYM_LPAREN);
-        Node *cond = parse_expression();
+        NodeId cond = parse_expression();
         expect(TK_SYM_RPAREN);
-        Node *body = parse_statement();
-        Node *n = new_node(tok, ND_WHILE);
-        n->lhs = cond;
-        n->rhs = body;
-        return n;
+        NodeId body = parse_statement();
+        return new_node_binary(&tok, ND_WHILE, cond, body);
     }
 
     // 5) for
     if (peek(0)->kind == TK_KW_FOR) {
-        Token *tok = next();            // consome 'for'
+        Token tok = take();             // consome 'for'
         expect(TK_SYM_LPAREN);
         // init
-        Node *init = NULL;
+        NodeId init = 0;
         if (peek(0)->kind != TK_SYM_SEMI) {
             if (peek(0)->kind == TK_KW_INT) {
-                // Token *idt = next();    // consome 'int'
+                // Token *idt = take();    // consome 'int'
                 next();
                 int   stars = count_stars();
-                Token *id   = expect(TK_IDENT);
+                Token id    = *expect(TK_IDENT);
                 /* constrói Type* */
                 Type *ty = ty_int;
                 for (int i = 0; i < stars; i++)
                     ty = pointer_to(ty);
-                Node *n  = new_node(id, ND_DECL);
-                n->name = copy_str(id->lexeme);
-                n->type = ty;
+                NodeId val = 0;
                 if (peek(0)->kind == TK_SYM_ASSIGN) {
                     next();
-                    n->init = parse_expression();
+                    val = parse_expression();
                 }
-                init = n;
+                init = new_node_decl(&id, ty, val);
             } else {
                 init = parse_expression();
             }
@@ -453,145 +591,97 @@ static Node *parse_statement(void) {
         expect(TK_SYM_SEMI);
 
         // cond
-        Node *cond = NULL;
+        NodeId cond = 0;
         if (peek(0)->kind != TK_SYM_SEMI) {
             cond = parse_expression();
         }
         expect(TK_SYM_SEMI);
 
         // inc
-        Node *inc = NULL;
+        NodeId inc = 0;
         if (peek(0)->kind != TK_SYM_RPAREN) {
             inc = parse_expression();
         }
         expect(TK_SYM_RPAREN);
 
         // body
-        Node *body = parse_statement();
-        Node *n = new_node(tok, ND_FOR);
-        n->init = init;
-        n->cond = cond;
-        n->inc  = inc;
-        n->rhs  = body;
-        return n;
+        NodeId body = parse_statement();
+        uint32_t x = extra_alloc(3);
+        compile_ast.extra[x]     = body;
+        compile_ast.extra[x + 1] = init;
+        compile_ast.extra[x + 2] = inc;
+        return new_node_binary(&tok, ND_FOR, cond, x);
     }
 
     // 6) declaração local simples: int x; int y = expr;
     if (peek(0)->kind == TK_KW_INT) {
-        Token *tok_int = next();        // consome 'int'
-        Node **decls = NULL;
-        int    cnt   = 0;
-        do {
-            // 1) conta ponteiros igual ao global
-            int   stars = count_stars();
-            Type *ty    = ty_int;
-            for (int i = 0; i < stars; i++)
-                ty = pointer_to(ty);
-
-            // 2) jogador de identificador
-            Token *id = expect(TK_IDENT);
-            Node *n  = new_node(id, ND_DECL);
-            n->name = copy_str(id->lexeme);
-            n->type = ty;                // <-- atribui o tipo
-            if (peek(0)->kind == TK_SYM_ASSIGN) {
-                next();                  // consome '='
-                n->init = parse_expression();
-            }
-            decls = realloc(decls, sizeof(Node*) * (cnt + 1));
-            decls[cnt++] = n;
-        } while (peek(0)->kind == TK_SYM_COMMA && (next(), 1));
-        expect(TK_SYM_SEMI);
-
-        if (cnt == 1) {
-            Node *only = decls[0];
-            free(decls);
-            return only;
-        }
-        Node *blk = new_node(tok_int, ND_BLOCK);
-        blk->stmts      = decls;
-        blk->stmt_count = cnt;
-        return blk;
+        Token tok_int = take();         // consome 'int'
+        size_t mark    = scratch_mark();
+        parse_local_decls();
+        if (scratch_len - mark == 1)
+            return scratch[--scratch_len];
+        return new_node_list(&tok_int, ND_BLOCK, scratch_commit(mark));
     }
 
     // 7) expression-stmt
     {
-        Node *expr = parse_expression();
+        NodeId expr = parse_expression();
         expect(TK_SYM_SEMI);
         return expr;
     }
 }
 
-static Node *parse_compound(void) {
+static NodeId parse_compound(void) {
     // consome '{' e captura token para localização do bloco
-    Token *tok = expect(TK_SYM_LBRACE);
+    Token tok = *expect(TK_SYM_LBRACE);
 
-    // cria nó de bloco com token do '{'
-    Node *blk = new_node(tok, ND_BLOCK);
-    blk->stmts      = NULL;
-    blk->stmt_count = 0;
+    size_t mark = scratch_mark();
 
     // até encontrar '}'...
     while (peek(0)->kind != TK_SYM_RBRACE) {
-        Node *st = parse_statement();
-
-        // achata blocos que vieram de declarações múltiplas
-        if (st->kind == ND_BLOCK &&
-            st->stmt_count > 0 &&
-            st->stmts[0]->kind == ND_DECL) {
-            for (int i = 0; i < st->stmt_count; i++) {
-                blk->stmts = realloc(
-                    blk->stmts,
-                    sizeof(Node*) * (blk->stmt_count + 1)
-                );
-                blk->stmts[blk->stmt_count++] = st->stmts[i];
-            }
-            free(st->stmts);
-            free(st);
+        // declarações múltiplas entram direto no bloco (sem bloco
+        // intermediário); blocos '{ ... }' aninhados mantêm o próprio escopo
+        if (peek(0)->kind == TK_KW_INT) {
+            next();                     // consome 'int'
+            parse_local_decls();
         } else {
-            // bloco normal ou outro statement
-            blk->stmts = realloc(
-                blk->stmts,
-                sizeof(Node*) * (blk->stmt_count + 1)
-            );
-            blk->stmts[blk->stmt_count++] = st;
+            scratch_push(parse_statement());
         }
     }
+    uint32_t stmts = scratch_commit(mark);
 
     // consome '}' final
     expect(TK_SYM_RBRACE);
-    return blk;
+    // nó de bloco com token do '{'
+    return new_node_list(&tok, ND_BLOCK, stmts);
 }
 
-static Node *parse_global_decl(void) {
+static NodeId parse_global_decl(void) {
     // consome 'int' (token não usado para localização da declaração em si)
     expect(TK_KW_INT);
     // conta quantos '*' para tipos de ponteiro
     int stars    = count_stars();
-    Token *id    = expect(TK_IDENT);
+    Token id     = *expect(TK_IDENT);
     // constrói o Type*: começa em int, envolve tantos ponteiros quanto 'stars'
     Type *ty     = ty_int;
     for (int i = 0; i < stars; i++)
         ty = pointer_to(ty);
-    Node *n      = new_node(id, ND_DECL);
-    n->type      = ty;                     // <–– atribui o tipo ao nó
-    n->name      = copy_str(id->lexeme);
-
     // inicializador opcional: = expr
+    NodeId init  = 0;
     if (peek(0)->kind == TK_SYM_ASSIGN) {
         next();  // consome '='
-        n->init = parse_expression();
+        init = parse_expression();
     }
 
     // ponto-e-vírgula final
     expect(TK_SYM_SEMI);
-    return n;
+    return new_node_decl(&id, ty, init);
 }
 
 // Função: parse_function_decl
 // Reconhece: int <name>( params ) { body }
-static Node *parse_function_decl(void) {
+static NodeId parse_function_decl(void) {
     // 1) palavra-chave 'int'
-    // Token *tok_int = expect(TK_KW_INT);
     /* tipo de retorno: int , int* , … */
     expect(TK_KW_INT);
     int   ret_stars = count_stars();
@@ -600,72 +690,85 @@ static Node *parse_function_decl(void) {
         ret_ty = pointer_to(ret_ty);
 
     // 2) nome da função
-    Token *fn = expect(TK_IDENT);
+    Token fn = *expect(TK_IDENT);
 
     // 3) parêntese de abertura
     expect(TK_SYM_LPAREN);
 
     // 4) parâmetros formais
-    Node **params = NULL;
-    int    pcount = 0;
+    size_t mark = scratch_mark();
     if (peek(0)->kind != TK_SYM_RPAREN) {
         do {
             // cada parâmetro começa com 'int'
             expect(TK_KW_INT);
             int stars = count_stars();
             // nome do parâmetro
-            Token *pt = expect(TK_IDENT);
+            Token pt = *expect(TK_IDENT);
             // cria nó ND_VAR para o parâmetro, usando o token do identificador
             Type *pty = ty_int;
             for (int i = 0; i < stars; i++)
                 pty = pointer_to(pty);
 
-            Node *p  = new_node(pt, ND_VAR);
-            p->name  = copy_str(pt->lexeme);
-            p->type  = pty;
+            NodeId p = new_node_var(&pt);
+            nd_set_type(p, pty);
 
-            params = realloc(params, sizeof(Node*) * (pcount + 1));
-            params[pcount++] = p;
+            scratch_push(p);
         } while (consume(TK_SYM_COMMA));
     }
+    // os parâmetros ficam no rascunho até o corpo: [params..., corpo]
+    int pcount = (int)(scratch_len - mark);
     // fecha a lista de parâmetros
     expect(TK_SYM_RPAREN);
 
     // 5) corpo da função (bloco composto)
-    Node *body = parse_compound();  // já consome '{' … '}' internamente
-
-    // 6) monta o nó ND_FUNC, usando o token do identificador da função
-    Node *fnode = new_node(fn, ND_FUNC);
-    fnode->name       = copy_str(fn->lexeme);
-    fnode->args       = params;
-    fnode->arg_count  = pcount;
-    // reaproveita statements do bloco interno
-    /* monta o Type* da função */
-    Type **ptypes = malloc(sizeof(Type*) * pcount);
-    for (int i = 0; i < pcount; i++)
-        ptypes[i] = params[i]->type;
-    fnode->type = func_type(ret_ty, ptypes, pcount);
+    NodeId body = parse_compound();  // já consome '{' … '}' internamente
 
-    fnode->stmts      = body->stmts;
-    fnode->stmt_count = body->stmt_count;
-    free(body);
+    // 6) monta o Type* da função
+    /* func_type copia a lista só se o tipo for novo: buffer temporário */
+    Type  *ptypes_buf[16];
+    Type **ptypes = pcount <= 16 ? ptypes_buf
+                                 : arena_alloc(&compile_arena, sizeof(Type*) * pcount);
+    for (int i = 0; i < pcount; i++)
+        ptypes[i] = nd_type(scratch[mark + i]);
+    Type *fty = func_type(ret_ty, ptypes, pcount);
+
+    // 7) nó ND_FUNC com o token do identificador da função; a contagem
+    //    da lista é a dos parâmetros, e o corpo vem logo depois deles
+    scratch_push(body);
+    uint32_t params = scratch_commit(mark);
+    compile_ast.extra[params] = (NodeId)pcount;
+    NodeId fnode = new_node_list(&fn, ND_FUNC, params);
+    nd_set_type(fnode, fty);
     return fnode;
 }
 
 // Program: sequence of globals and functions
-Node *parse_program(Token *tok_stream) {
+NodeId parse_program(Lexer *lx) {
     // inicializa stream de tokens
-    cur = tok_stream;
+    lex       = lx;
+    ring_head = 0;
+    ring_len  = 0;
+
+    // vetores da AST reaproveitados; posições são relativas à fonte
+    compile_ast.src       = lx->p;
+    compile_ast.src_len   = (size_t)(lx->end - lx->p);
+    compile_ast.len       = 0;
+    compile_ast.extra_len = 0;
+    compile_ast.names_len = 0;
+    if (compile_ast.src_len > UINT32_MAX) {
+        fprintf(stderr, "fonte grande demais para posições de 32 bits\n");
+        exit(1);
+    }
 
-    // cria nó bloco raiz usando o primeiro token para localização
-    Token *root_tok = peek(0);
-    Node *root = new_node(root_tok, ND_BLOCK);
-    root->stmts      = NULL;
-    root->stmt_count = 0;
+    // bloco raiz usa o primeiro token para localização; o índice 0 é
+    // "nenhum nó"
+    Token root_tok = *peek(0);
+    new_node(&root_tok, ND_BLOCK);
+    size_t mark = scratch_mark();
 
     // enquanto não chegarmos ao EOF
     while (peek(0)->kind != TK_EOF) {
-        Node *node;
+        NodeId node;
         // lookahead a 2 tokens: identificador seguido de '(' indica função
         if (peek(0)->kind == TK_KW_INT &&
             peek(1)->kind == TK_IDENT &&
@@ -675,28 +778,7 @@ Node *parse_program(Token *tok_stream) {
             node = parse_global_decl();
         }
         // adiciona ao bloco raiz
-        root->stmts = realloc(
-            root->stmts,
-            sizeof(Node*) * (root->stmt_count + 1)
-        );
-        root->stmts[root->stmt_count++] = node;
-    }
-
-    return root;
-}
-
-// Free AST nodes recursively
-void free_node(Node *node) {
-    if (!node) return;
-    // Free children
-    free_node(node->lhs);
-    free_node(node->rhs);
-    for (int i = 0; i < node->arg_count; i++)
-        free_node(node->args[i]);
-    free(node->args);
-    for (int i = 0; i < node->stmt_count; i++)
-        free_node(node->stmts[i]);
-    free(node->stmts);
-    free((char*)node->name);
-    free(node);
+        scratch_push(node);
+    }
+    return new_node_list(&root_tok, ND_BLOCK, scratch_commit(mark));
 }
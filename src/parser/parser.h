@@ -1,6 +1,8 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include <stddef.h>
+#include <stdint.h>
 #include "../lexer/lexer.h"
 #include "type.h"
 
@@ -33,7 +35,7 @@
 
 // AST Node kinds
 typedef enum {
-    ND_ADD, ND_SUB, ND_MUL, ND_DIV, ND_LOGAND, ND_LOGOR,
+    ND_ADD, ND_SUB, ND_MUL, ND_DIV, ND_MOD, ND_LOGAND, ND_LOGOR,
     ND_EQ, ND_NE, ND_LT, ND_LE,
     ND_ASSIGN, ND_VAR, ND_NUM, ND_DEREF, ND_ADDR,
     ND_RETURN, ND_IF, ND_WHILE, ND_FOR,
@@ -41,28 +43,104 @@ typedef enum {
     ND_POSTDEC, ND_CALL, ND_FUNC, ND_DECL,
 } NodeKind;
 
-// AST Node structure
-typedef struct Node {
-    NodeKind kind;
-    Token *token;
-    Type *type;               // tipo do nó, usado para semântica
-    struct Node *lhs;         // left-hand side or condition
-    struct Node *rhs;         // right-hand side or then-branch
-    struct Node *els;         // else-branch
-    int val;                  // used for ND_NUM
-    char *name;               // identifiers, function names
-    struct Node **args;       // argument list for calls
-    int arg_count;
-    struct Node **stmts;      // block statements
-    int stmt_count;
-    struct Node *init, *cond, *inc; // for ND_FOR
-} Node;
-
-// Parse the entire program; returns root node or NULL on error
-typedef struct Function Function;
-Node *parse_program(Token *tok);
-
-// Free the AST recursively
-void free_node(Node *node);
+/* AST em arrays contíguos (struct-of-arrays), endereçada por índices de
+ * 32 bits: um nó é um NodeId, posição nos vetores de compile_ast; o índice
+ * 0 é reservado e significa "nenhum nó". Cada nó tem kind, posição do seu
+ * token na fonte (32 bits), tipo e dois campos de dados (a, b) cujo
+ * significado depende do kind. Filhos a mais e listas (statements,
+ * argumentos, parâmetros) ficam no vetor compartilhado 'extra', e os
+ * nomes internados em 'names'. Leia os campos só pelos acessores abaixo,
+ * e só os que pertencem ao kind do nó.
+ *
+ *   kind           a              b              extra[x...]
+ *   ND_NUM         val            -              -
+ *   ND_VAR         nome           -              -
+ *   unários(*)     lhs            -              -
+ *   binários(**)   lhs            rhs            -
+ *   ND_WHILE       cond           body           -
+ *   ND_IF          cond           x              then, else
+ *   ND_FOR         cond           x              body, init, inc
+ *   ND_DECL        init           nome           -
+ *   ND_BLOCK       -              x              n, n statements
+ *   ND_CALL        nome           x              n, n argumentos
+ *   ND_FUNC        nome           x              n, n parâmetros, corpo
+ *
+ *   (*)  ND_DEREF, ND_ADDR, ND_RETURN, ND_POSTINC, ND_POSTDEC
+ *   (**) aritméticos, relacionais, lógicos, ND_ASSIGN
+ * 'nome' é um índice em names. O corpo de ND_FUNC é um ND_BLOCK; seus
+ * statements ficam no escopo dos parâmetros. */
+typedef uint32_t NodeId;
+
+typedef struct {
+    uint32_t a, b;
+} NodeData;
+
+typedef struct {
+    unsigned char *kind;          // NodeKind
+    uint32_t *pos;                // deslocamento do token do nó na fonte
+    Type    **type;               // tipo do nó, usado para semântica
+    NodeData *data;
+    NodeId   *extra;              // filhos extras e listas de filhos
+    const char **names;           // nomes internados dos nós
+    const char *src;              // fonte de onde vêm as posições
+    size_t    src_len;
+    size_t    len, cap;           // nós (len inclui o índice 0)
+    size_t    extra_len, extra_cap;
+    size_t    names_len, names_cap;
+} Ast;
+
+// AST da compilação corrente (reaproveitada a cada parse_program)
+extern Ast compile_ast;
+
+static inline NodeKind nd_kind(NodeId n) { return (NodeKind)compile_ast.kind[n]; }
+static inline Type *nd_type(NodeId n) { return compile_ast.type[n]; }
+static inline void nd_set_type(NodeId n, Type *ty) { compile_ast.type[n] = ty; }
+static inline int nd_val(NodeId n) { return (int)compile_ast.data[n].a; }
+static inline NodeId nd_lhs(NodeId n) { return compile_ast.data[n].a; }
+static inline NodeId nd_rhs(NodeId n) { return compile_ast.data[n].b; }
+static inline NodeId nd_cond(NodeId n) { return compile_ast.data[n].a; }
+static inline NodeId nd_then(NodeId n) { return compile_ast.extra[compile_ast.data[n].b]; }
+static inline NodeId nd_else(NodeId n) { return compile_ast.extra[compile_ast.data[n].b + 1]; }
+static inline NodeId nd_inc(NodeId n) { return compile_ast.extra[compile_ast.data[n].b + 2]; }
+
+// ND_DECL: b; ND_VAR, ND_CALL, ND_FUNC: a
+static inline const char *nd_name(NodeId n) {
+    const NodeData *d = &compile_ast.data[n];
+    return compile_ast.names[nd_kind(n) == ND_DECL ? d->b : d->a];
+}
+
+// ND_DECL: a; ND_FOR: extra
+static inline NodeId nd_init(NodeId n) {
+    const NodeData *d = &compile_ast.data[n];
+    return nd_kind(n) == ND_DECL ? d->a : compile_ast.extra[d->b + 1];
+}
+
+// Lista de filhos de ND_BLOCK, ND_CALL e ND_FUNC (válida após o parse)
+static inline int nd_count(NodeId n) {
+    return (int)compile_ast.extra[compile_ast.data[n].b];
+}
+static inline const NodeId *nd_list(NodeId n) {
+    return compile_ast.extra + compile_ast.data[n].b + 1;
+}
+
+// ND_WHILE: b; ND_FOR: extra; ND_FUNC: depois dos parâmetros
+static inline NodeId nd_body(NodeId n) {
+    const NodeData *d = &compile_ast.data[n];
+    switch (nd_kind(n)) {
+    case ND_WHILE: return d->b;
+    case ND_FOR:   return compile_ast.extra[d->b];
+    default:       return nd_list(n)[nd_count(n)];
+    }
+}
+
+// Token do nó, relido da fonte (para mensagens de erro)
+Token nd_token(NodeId n);
+
+// Parse the entire program; returns the root ND_BLOCK
+// (tokens são puxados de lx sob demanda; os nós vivem em compile_ast)
+NodeId parse_program(Lexer *lx);
+
+// Libera os vetores da AST (chamar junto com arena_release da compile_arena)
+void ast_release(void);
 
 #endif // PARSER_H
@@ -4,82 +4,136 @@
 
 #include "sema.h"
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <stdio.h>
 #include "token.h"
 #include "type.h"
+#include "arena.h"
 
-// Cria um novo escopo, linkando-o ao pai
-static SemaScope *new_scope(SemaScope *parent) {
-    SemaScope *sc = calloc(1, sizeof(SemaScope));
-    sc->parent = parent;
+/* Tabela de símbolos: um hash (nome internado → símbolo visível) e, por
+ * nome, uma pilha de sombreamento encadeada em SemaSymbol.shadow. Cada
+ * escopo guarda a lista do que declarou; sair do escopo desempilha só esses
+ * nomes. declare/resolve/leave ficam O(1) amortizado por símbolo. */
+
+static size_t hash_name(const char *name) {
+    uintptr_t h = (uintptr_t)name >> 3;
+    return (size_t)(h * 0x9E3779B97F4A7C15ull >> 16);
+}
+
+// Posição do nome na tabela (livre se ainda não existir)
+static SemaBinding *find_binding(SemaContext *ctx, const char *name) {
+    size_t mask = ctx->bind_cap - 1;
+    size_t i = hash_name(name) & mask;
+    while (ctx->bindings[i].name && ctx->bindings[i].name != name)
+        i = (i + 1) & mask;
+    return &ctx->bindings[i];
+}
+
+static void grow_bindings(SemaContext *ctx) {
+    SemaBinding *old = ctx->bindings;
+    size_t old_cap   = ctx->bind_cap;
+    ctx->bind_cap    = old_cap ? old_cap * 2 : 64;
+    ctx->bindings    = arena_calloc(&compile_arena,
+                                    ctx->bind_cap * sizeof(SemaBinding));
+    for (size_t i = 0; i < old_cap; i++)
+        if (old[i].name)
+            *find_binding(ctx, old[i].name) = old[i];
+}
+
+// Cria (ou reaproveita) um escopo, linkando-o ao pai
+static SemaScope *new_scope(SemaContext *ctx, SemaScope *parent) {
+    SemaScope *sc = ctx->free_scopes;
+    if (sc)
+        ctx->free_scopes = sc->parent;
+    else
+        sc = arena_alloc(&compile_arena, sizeof(SemaScope));
+    sc->symbols = NULL;
+    sc->parent  = parent;
+    sc->depth   = parent ? parent->depth + 1 : 0;
     return sc;
 }
 
 void sema_init(SemaContext *ctx) {
-    ctx->current_scope = new_scope(NULL);
+    ctx->bindings    = NULL;
+    ctx->bind_cap    = 0;
+    ctx->bind_count  = 0;
+    ctx->free_scopes = NULL;
+    ctx->free_syms   = NULL;
+    grow_bindings(ctx);
+    ctx->current_scope = new_scope(ctx, NULL);
     ctx->error_reported = false;
 }
 
 void sema_enter_scope(SemaContext *ctx) {
-    ctx->current_scope = new_scope(ctx->current_scope);
+    ctx->current_scope = new_scope(ctx, ctx->current_scope);
 }
 
+// Desempilha os nomes do escopo e devolve escopo/símbolos às listas livres
 void sema_leave_scope(SemaContext *ctx) {
-    SemaScope *old = ctx->current_scope;
-    ctx->current_scope = old->parent;
-
-    // libera símbolos do escopo antigo
-    SemaSymbol *sym = old->symbols;
-    while (sym) {
-        SemaSymbol *next = sym->next;
-        free(sym);
-        sym = next;
+    SemaScope  *old  = ctx->current_scope;
+    SemaSymbol *last = NULL;
+    for (SemaSymbol *sym = old->symbols; sym; sym = sym->next) {
+        find_binding(ctx, sym->name)->sym = sym->shadow;
+        last = sym;
+    }
+    if (last) {
+        last->next     = ctx->free_syms;
+        ctx->free_syms = old->symbols;
     }
-    free(old);
+    ctx->current_scope = old->parent;
+    old->parent        = ctx->free_scopes;
+    ctx->free_scopes   = old;
 }
 
 SemaErrorCode sema_declare(SemaContext *ctx, const char *name, NodeKind kind, Type *type) {
+    SemaBinding *b = find_binding(ctx, name);
     // verifica redeclaração no escopo atual
-    for (SemaSymbol *it = ctx->current_scope->symbols; it; it = it->next) {
-        if (strcmp(it->name, name) == 0) {
-            return SEMA_REDECLARED_IDENT;
+    if (b->sym && b->sym->depth == ctx->current_scope->depth)
+        return SEMA_REDECLARED_IDENT;
+    if (!b->name) {
+        if (2 * (ctx->bind_count + 1) > ctx->bind_cap) {
+            grow_bindings(ctx);
+            b = find_binding(ctx, name);
         }
+        b->name = name;
+        ctx->bind_count++;
     }
-    // insere novo símbolo
-    SemaSymbol *sym = calloc(1, sizeof(SemaSymbol));
+    // insere novo símbolo no topo da pilha do nome
+    SemaSymbol *sym = ctx->free_syms;
+    if (sym)
+        ctx->free_syms = sym->next;
+    else
+        sym = arena_alloc(&compile_arena, sizeof(SemaSymbol));
     sym->name        = name;
     sym->kind        = kind;
     sym->type        = type;
     sym->stack_offset = 0;  // será ajustado no codegen
+    sym->depth       = ctx->current_scope->depth;
+    sym->shadow      = b->sym;
     sym->next        = ctx->current_scope->symbols;
     ctx->current_scope->symbols = sym;
+    b->sym = sym;
     return SEMA_OK;
 }
 
 SemaSymbol *sema_resolve(SemaContext *ctx, const char *name) {
-    for (SemaScope *sc = ctx->current_scope; sc; sc = sc->parent) {
-        for (SemaSymbol *sym = sc->symbols; sym; sym = sym->next) {
-            if (strcmp(sym->name, name) == 0) {
-                return sym;
-            }
-        }
-    }
-    return NULL;
+    return find_binding(ctx, name)->sym;
 }
 
 // Reporta erro semântico com localização
 static void report_error_ctx(SemaContext *ctx,
                              const char *msg,
-                             const Node *node) {
-    if (node && node->token) {
+                             NodeId node) {
+    if (node) {
+        Token tok = nd_token(node);
         fprintf(stderr,
                 "%d:%d: erro semântico: %s em '%.*s'\n",
-                node->token->line,
-                node->token->col,
+                tok.line,
+                tok.col,
                 msg,
-                (int)node->token->len,
-                node->token->lexeme);
+                (int)tok.len,
+                tok.lexeme);
     } else {
         fprintf(stderr, "erro semântico: %s\n", msg);
     }
@@ -88,103 +142,105 @@ static void report_error_ctx(SemaContext *ctx,
 
 
 // Função auxiliar para checar binários inteiros
-static void check_binary_int(SemaContext *ctx, Node *node) {
-    Node *l = node->lhs;
-    Node *r = node->rhs;
+static void check_binary_int(SemaContext *ctx, NodeId node) {
+    NodeId l = nd_lhs(node);
+    NodeId r = nd_rhs(node);
 
-    /* caso 1: int  + int  → int  */
-    if (l->type->kind == TY_INT && r->type->kind == TY_INT) {
-        node->type = ty_int;
+    /* caso 1: int  + int  → int  (tipos canônicos: identidade por ponteiro) */
+    if (nd_type(l) == ty_int && nd_type(r) == ty_int) {
+        nd_set_type(node, ty_int);
         return;
     }
 
     /* caso 2: ptr + int / int + ptr → ptr (aritmética de ponteiro simples) */
-    if (l->type->kind == TY_PTR && r->type->kind == TY_INT) {
-        node->type = l->type;
+    if (nd_type(l)->kind == TY_PTR && nd_type(r) == ty_int) {
+        nd_set_type(node, nd_type(l));
         return;
     }
-    if (r->type->kind == TY_PTR && l->type->kind == TY_INT) {
-        node->type = r->type;
+    if (nd_type(r)->kind == TY_PTR && nd_type(l) == ty_int) {
+        nd_set_type(node, nd_type(r));
         return;
     }
 
     report_error_ctx(ctx, "tipos incompatíveis para operador aritmético", node);
 }
 
-SemaErrorCode sema_analyze(SemaContext *ctx, Node *root) {
+SemaErrorCode sema_analyze(SemaContext *ctx, NodeId root) {
     if (!root) return SEMA_OK;
-    // if (root && root->token) {
+    // if (root) {
     //     fprintf(stderr,
     //             "[sema] visiting kind=%d at %d:%d\n",
-    //             root->kind,
-    //             root->token->line,
-    //             root->token->col);
+    //             nd_kind(root),
+    //             nd_token(root).line,
+    //             nd_token(root).col);
     // }
-    switch (root->kind) {
+    switch (nd_kind(root)) {
 
     case ND_BLOCK:
         int need_scope = ctx->current_scope->parent != NULL;
         if(need_scope) sema_enter_scope(ctx);
-        for (int i = 0; i < root->stmt_count; i++) {
-            sema_analyze(ctx, root->stmts[i]);
+        for (int i = 0; i < nd_count(root); i++) {
+            sema_analyze(ctx, nd_list(root)[i]);
         }
         if (need_scope) sema_leave_scope(ctx);
         break;
     case ND_DEREF:
-        sema_analyze(ctx, root->lhs);
-        if (root->lhs->type->kind != TY_PTR)
+        sema_analyze(ctx, nd_lhs(root));
+        if (nd_type(nd_lhs(root))->kind != TY_PTR)
             report_error_ctx(ctx, "operador * exige ponteiro", root);
         else
-            root->type = root->lhs->type->base;
+            nd_set_type(root, nd_type(nd_lhs(root))->base);
         break;
 
     case ND_DECL:
         // declara variável ou função-local (parser não separa global/local aqui)
-        if (sema_declare(ctx, root->name, ND_DECL, root->type) != SEMA_OK) {
+        if (sema_declare(ctx, nd_name(root), ND_DECL, nd_type(root)) != SEMA_OK) {
             report_error_ctx(ctx,"Redeclaração de identificador", root);
             ctx->error_reported = true;
         }
-        if (root->init) {
-            sema_analyze(ctx, root->init);
-            // opcional: aqui poderíamos checar root->init->type vs root->type
+        if (nd_init(root)) {
+            sema_analyze(ctx, nd_init(root));
+            // opcional: aqui poderíamos checar nd_type(nd_init(root)) vs nd_type(root)
         }
         break;
 
     case ND_FUNC:
         // registro do nome da função no escopo global
-        if (sema_declare(ctx, root->name, ND_FUNC, root->type) != SEMA_OK) {
+        if (sema_declare(ctx, nd_name(root), ND_FUNC, nd_type(root)) != SEMA_OK) {
             report_error_ctx(ctx,"Redeclaração de função", root);
             ctx->error_reported = true;
         }
         // escopo para parâmetros e corpo
         sema_enter_scope(ctx);
-        for (int i = 0; i < root->arg_count; i++) {
-            Node *param = root->args[i];
-            if (sema_declare(ctx, param->name, ND_DECL, param->type) != SEMA_OK) {
+        for (int i = 0; i < nd_count(root); i++) {
+            NodeId param = nd_list(root)[i];
+            if (sema_declare(ctx, nd_name(param), ND_DECL, nd_type(param)) != SEMA_OK) {
                 report_error_ctx(ctx,"Redeclaração de parâmetro", param);
                 ctx->error_reported = true;
             }
         }
-        for (int i = 0; i < root->stmt_count; i++) {
-            sema_analyze(ctx, root->stmts[i]);
+        // statements do corpo no mesmo escopo dos parâmetros
+        NodeId body = nd_body(root);
+        for (int i = 0; i < nd_count(body); i++) {
+            sema_analyze(ctx, nd_list(body)[i]);
         }
         sema_leave_scope(ctx);
         break;
 
     case ND_VAR:
         // uso de variável: deve já ter sido declarada
-        SemaSymbol *sym = sema_resolve(ctx, root->name);
+        SemaSymbol *sym = sema_resolve(ctx, nd_name(root));
         if (!sym) {
              report_error_ctx(ctx,"Identificador não declarado", root);
              ctx->error_reported = true;
         } else {
-            root->type = sym->type;     /* → propaga o tipo para a AST */
+            nd_set_type(root, sym->type);     /* → propaga o tipo para a AST */
         }
         break;
 
     case ND_NUM:
         // literal numérico: já tipado como inteiro
-        root->type = ty_int;
+        nd_set_type(root, ty_int);
         break;
         break;
 
@@ -192,127 +248,124 @@ SemaErrorCode sema_analyze(SemaContext *ctx, Node *root) {
     case ND_SUB:
     case ND_MUL:
     case ND_DIV:
-        sema_analyze(ctx, root->lhs);
-        sema_analyze(ctx, root->rhs);
+    case ND_MOD:
+        sema_analyze(ctx, nd_lhs(root));
+        sema_analyze(ctx, nd_rhs(root));
         check_binary_int(ctx, root);
         break;
     // ─────── Atribuição ─────────────────────────────────────────────────
     case ND_ASSIGN:
         // visita lhs e rhs
-        sema_analyze(ctx, root->lhs);
-        sema_analyze(ctx, root->rhs);
-        // opcional: exigir tipos compatíveis (int ← int, ptr ← ptr)
-        if (!root->lhs->type || !root->rhs->type ||
-            root->lhs->type->kind != root->rhs->type->kind) {
+        sema_analyze(ctx, nd_lhs(root));
+        sema_analyze(ctx, nd_rhs(root));
+        // exige o mesmo tipo dos dois lados (int ← int, int* ← int*, ...)
+        if (!nd_type(nd_lhs(root)) || nd_type(nd_lhs(root)) != nd_type(nd_rhs(root))) {
             report_error_ctx(ctx, "tipos incompatíveis em atribuição", root);
         }
-        root->type = root->lhs->type;
+        nd_set_type(root, nd_type(nd_lhs(root)));
         break;
 
     // ─────── Relacionais (<, <=, >, >=) ────────────────────────────────
     // case ND_LT: case ND_LE: case ND_GT: case ND_GE:
     case ND_LT: case ND_LE:
-        sema_analyze(ctx, root->lhs);
-        sema_analyze(ctx, root->rhs);
+        sema_analyze(ctx, nd_lhs(root));
+        sema_analyze(ctx, nd_rhs(root));
         // só faça comparações entre inteiros
-        if (root->lhs->type->kind != TY_INT || root->rhs->type->kind != TY_INT) {
+        if (nd_type(nd_lhs(root)) != ty_int || nd_type(nd_rhs(root)) != ty_int) {
             report_error_ctx(ctx, "comparação exige inteiros", root);
         }
-        root->type = ty_int;  // comparações produzem int (0 ou 1)
+        nd_set_type(root, ty_int);  // comparações produzem int (0 ou 1)
         break;
 
     // ─────── Igualdade (==, !=) ─────────────────────────────────────────
     case ND_EQ: case ND_NE:
-        sema_analyze(ctx, root->lhs);
-        sema_analyze(ctx, root->rhs);
-        // permita comparar ptr ou int, mas ambos lados devem ser do mesmo kind
-        if (!root->lhs->type || !root->rhs->type ||
-            root->lhs->type->kind != root->rhs->type->kind) {
+        sema_analyze(ctx, nd_lhs(root));
+        sema_analyze(ctx, nd_rhs(root));
+        // permita comparar ptr ou int, mas ambos lados devem ter o mesmo tipo
+        if (!nd_type(nd_lhs(root)) || nd_type(nd_lhs(root)) != nd_type(nd_rhs(root))) {
             report_error_ctx(ctx, "tipos incompatíveis para ==/!=", root);
         }
-        root->type = ty_int;
+        nd_set_type(root, ty_int);
         break;
     case ND_RETURN:
-        if (root->lhs) {
-            sema_analyze(ctx, root->lhs);
+        if (nd_lhs(root)) {
+            sema_analyze(ctx, nd_lhs(root));
         }
         break;
 
     case ND_IF:
-        sema_analyze(ctx, root->lhs);        // condição
-        sema_analyze(ctx, root->rhs);        // then-branch
-        if (root->els) sema_analyze(ctx, root->els);
+        sema_analyze(ctx, nd_cond(root));       // condição
+        sema_analyze(ctx, nd_then(root));       // then-branch
+        if (nd_else(root)) sema_analyze(ctx, nd_else(root));
         break;
 
     case ND_WHILE:
-        sema_analyze(ctx, root->lhs);        // condição
-        sema_analyze(ctx, root->rhs);        // corpo
+        sema_analyze(ctx, nd_cond(root));       // condição
+        sema_analyze(ctx, nd_body(root));       // corpo
         break;
 
     case ND_FOR:
-        if (root->init) sema_analyze(ctx, root->init);
-        if (root->cond) sema_analyze(ctx, root->cond);
-        if (root->inc ) sema_analyze(ctx, root->inc);
+        if (nd_init(root)) sema_analyze(ctx, nd_init(root));
+        if (nd_cond(root)) sema_analyze(ctx, nd_cond(root));
+        if (nd_inc(root) ) sema_analyze(ctx, nd_inc(root));
         sema_enter_scope(ctx);
-        for (int i = 0; i < root->stmt_count; i++) {
-            sema_analyze(ctx, root->stmts[i]);
-        }
+        sema_analyze(ctx, nd_body(root));       // corpo
         sema_leave_scope(ctx);
         break;
 
     case ND_ADDR:
-        sema_analyze(ctx, root->lhs);
-        root->type = pointer_to(root->lhs->type);
+        sema_analyze(ctx, nd_lhs(root));
+        nd_set_type(root, pointer_to(nd_type(nd_lhs(root))));
         break;
     case ND_POSTINC:
     case ND_POSTDEC:
         // primeiro tipa o operando
-        sema_analyze(ctx, root->lhs);
-        // só permita inteiros (ou ponteiros, se quiser)
-        if (root->lhs->type->kind != TY_INT) {
+        sema_analyze(ctx, nd_lhs(root));
+        // inteiros, ou ponteiros (que andam uma palavra: *p++)
+        if (nd_type(nd_lhs(root))->kind != TY_INT && nd_type(nd_lhs(root))->kind != TY_PTR) {
             report_error_ctx(ctx,
-                "operador ++/-- exige inteiro", root);
+                "operador ++/-- exige inteiro ou ponteiro", root);
         }
         // o tipo da expressão é o mesmo do operando
-        root->type = root->lhs->type;
+        nd_set_type(root, nd_type(nd_lhs(root)));
         break;
     case ND_LOGAND:
     case ND_LOGOR:
         // tipa ambos lados
-        sema_analyze(ctx, root->lhs);
-        sema_analyze(ctx, root->rhs);
+        sema_analyze(ctx, nd_lhs(root));
+        sema_analyze(ctx, nd_rhs(root));
         // exigimos inteiros como condição
-        if (root->lhs->type->kind != TY_INT ||
-            root->rhs->type->kind != TY_INT) {
+        if (nd_type(nd_lhs(root))->kind != TY_INT ||
+            nd_type(nd_rhs(root))->kind != TY_INT) {
             report_error_ctx(ctx,
                 "operador lógico exige inteiros", root);
         }
         // resultado de && e || também é int (0 ou 1)
-        root->type = ty_int;
+        nd_set_type(root, ty_int);
         break;
 
     case ND_CALL: {
-        /* a função é guardada em root->lhs (um ND_VAR)  */
-        sema_analyze(ctx, root->lhs);
-        if (!root->lhs->type) {
+        /* a função é resolvida pelo nome da própria chamada */
+        SemaSymbol *fn = sema_resolve(ctx, nd_name(root));
+        if (!fn) {
             report_error_ctx(ctx, "chamada de função sem declaração prévia", root);
             break;
         }
         /* visita e tipa cada argumento */
-        for (int i = 0; i < root->arg_count; i++)
-            sema_analyze(ctx, root->args[i]);
+        for (int i = 0; i < nd_count(root); i++)
+            sema_analyze(ctx, nd_list(root)[i]);
 
-        Type *fnty = root->lhs->type;
+        Type *fnty = fn->type;
         if (!fnty || fnty->kind != TY_FUNC) {
             report_error_ctx(ctx,"tentativa de chamar não-função", root);
             break;
         }
-        if (root->arg_count != fnty->param_count) {
+        if (nd_count(root) != fnty->param_count) {
             report_error_ctx(ctx,"nº de argumentos diferente do declarado", root);
             break;
         }
         /* (opcional) comparar cada arg[i]->type com fnty->params[i] */
-        root->type = fnty->base;   /* tipo de retorno */
+        nd_set_type(root, fnty->base);   /* tipo de retorno */
         break;
     }
 
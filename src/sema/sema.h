@@ -6,9 +6,10 @@
 #ifndef SEMA_H
 #define SEMA_H
 
-#include "../parser/parser.h"   // Definição de Node, NodeKind e FunctionDecl
+#include "../parser/parser.h"   // Definição de NodeId, NodeKind e acessores da AST
 #include "type.h"       // Definição de Type em include/
 #include <stdbool.h>
+#include <stddef.h>
 
 // Tipo de erro semântico
 typedef enum {
@@ -23,25 +24,38 @@ typedef enum {
 
 // Informação sobre um símbolo (variável ou função)
 typedef struct SemaSymbol {
-    const char *name;      // Nome do símbolo
+    const char *name;      // Nome do símbolo (internado: compare com ==)
     NodeKind kind;         // ND_VAR ou ND_FUNC (definidos em parser/parser.h)
     Type *type;            // Tipo (int, ponteiro, função, etc.) definido em include/type.h
     int stack_offset;      // Deslocamento no frame (para variáveis locais)
-    struct SemaSymbol *next;
+    int depth;             // Profundidade do escopo que o declarou
+    struct SemaSymbol *next;    // Próximo símbolo do mesmo escopo (desfeito ao sair)
+    struct SemaSymbol *shadow;  // Declaração de mesmo nome que este esconde
 } SemaSymbol;
 
-// Escopo: lista encadeada de símbolos + link para escopo pai
+// Escopo: símbolos declarados nele + link para escopo pai
 typedef struct SemaScope {
     SemaSymbol *symbols;
     struct SemaScope *parent;
+    int depth;
 } SemaScope;
 
+// Entrada da tabela hash: nome internado → símbolo visível no momento
+typedef struct {
+    const char *name;
+    SemaSymbol *sym;        // topo da pilha de sombreamento (NULL = nenhum)
+} SemaBinding;
+
 // Contexto global da análise semântica
 typedef struct {
     SemaScope *current_scope;
     bool error_reported;
     Type      *current_ret;     /* tipo de retorno da função visitada   */
     int        next_offset;     /* offset acumulado para locals (neg.)  */
+    SemaBinding *bindings;      /* endereçamento aberto, cap potência de 2 */
+    size_t     bind_cap, bind_count;
+    SemaScope  *free_scopes;    /* escopos e símbolos reaproveitados     */
+    SemaSymbol *free_syms;
 } SemaContext;
 
 // Inicializa o contexto (chamar no início da compilação)
@@ -53,13 +67,13 @@ void sema_enter_scope(SemaContext *ctx);
 // Sai do escopo atual
 void sema_leave_scope(SemaContext *ctx);
 
-// Declara um símbolo no escopo atual
+// Declara um símbolo no escopo atual (name deve vir de intern())
 SemaErrorCode sema_declare(SemaContext *ctx, const char *name, NodeKind kind, Type *type);
 
-// Resolve um nome no contexto (procura em escopos pai)
+// Resolve um nome no contexto (declaração visível mais interna)
 SemaSymbol *sema_resolve(SemaContext *ctx, const char *name);
 
 // Roda a análise semântica completa na AST raiz
-SemaErrorCode sema_analyze(SemaContext *ctx, Node *root);
+SemaErrorCode sema_analyze(SemaContext *ctx, NodeId root);
 
 #endif // SEMA_H
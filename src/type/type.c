@@ -1,42 +1,82 @@
 #include "type.h"
-#include <stdlib.h>
+#include "arena.h"
+#include <stdint.h>
+#include <string.h>
 
 /* singletons para tipos base */
-// static Type int_s  = { TY_INT };
-// Type *ty_int = &int_s;
-
-
 Type *ty_int;
 Type *ty_void;
 
+/* Tabela de tipos de função (hash-consing por retorno + parâmetros).
+ * Ponteiros não precisam de tabela: cada Type guarda seu pointer_to. */
+static Type  **func_buckets;
+static size_t  func_cap;        // sempre potência de 2
+static size_t  func_count;
+
+static Type *new_type(TypeKind kind, Type *base) {
+    Type *t = arena_calloc(&compile_arena, sizeof(Type));
+    t->kind = kind;
+    t->base = base;
+    return t;
+}
+
 void init_types(void) {
-    ty_int  = malloc(sizeof(Type));
-    ty_int->kind = TY_INT;
-    ty_int->base = NULL;
-    ty_int->params = NULL;
-    ty_int->param_count = 0;
-
-    ty_void = malloc(sizeof(Type));
-    ty_void->kind = TY_VOID;
-    ty_void->base = NULL;
-    ty_void->params = NULL;
-    ty_void->param_count = 0;
+    // a arena é liberada entre compilações: tudo recomeça do zero
+    ty_int  = new_type(TY_INT, NULL);
+    ty_void = new_type(TY_VOID, NULL);
+    func_buckets = NULL;
+    func_cap     = 0;
+    func_count   = 0;
 }
+
 /* helpers */
 Type *pointer_to(Type *base) {
-    Type *t = malloc(sizeof(Type));
-    t->kind = TY_PTR;
-    t->base = base;
-    t->params = NULL;
-    t->param_count = 0;
-    return t;
+    if (!base->ptr_cache)
+        base->ptr_cache = new_type(TY_PTR, base);
+    return base->ptr_cache;
+}
+
+// Tipos já são canônicos, então basta misturar os endereços
+static uint32_t func_hash(Type *ret, Type **params, int n) {
+    uint32_t h = 2166136261u ^ (uint32_t)n;
+    h = (h ^ (uint32_t)((uintptr_t)ret >> 4)) * 16777619u;
+    for (int i = 0; i < n; i++)
+        h = (h ^ (uint32_t)((uintptr_t)params[i] >> 4)) * 16777619u;
+    return h;
+}
+
+static void func_rehash(size_t new_cap) {
+    Type **old = func_buckets;
+    size_t old_cap = func_cap;
+    func_buckets = arena_calloc(&compile_arena, new_cap * sizeof(Type*));
+    func_cap     = new_cap;
+    for (size_t i = 0; i < old_cap; i++) {
+        for (Type *t = old[i], *nx; t; t = nx) {
+            nx = t->hnext;
+            size_t j = func_hash(t->base, t->params, t->param_count) & (func_cap - 1);
+            t->hnext = func_buckets[j];
+            func_buckets[j] = t;
+        }
+    }
 }
 
 Type *func_type(Type *ret, Type **params, int n) {
-    Type *t = malloc(sizeof(Type));
-    t->kind = TY_FUNC;
-    t->base = ret;
-    t->params = params;
+    if (func_count + 1 > func_cap)
+        func_rehash(func_cap ? func_cap * 2 : 64);
+    size_t i = func_hash(ret, params, n) & (func_cap - 1);
+    for (Type *t = func_buckets[i]; t; t = t->hnext) {
+        if (t->base == ret && t->param_count == n &&
+            (n == 0 || memcmp(t->params, params, sizeof(Type*) * n) == 0))
+            return t;
+    }
+    Type *t = new_type(TY_FUNC, ret);
+    if (n) {
+        t->params = arena_alloc(&compile_arena, sizeof(Type*) * n);
+        memcpy(t->params, params, sizeof(Type*) * n);
+    }
     t->param_count = n;
+    t->hnext = func_buckets[i];
+    func_buckets[i] = t;
+    func_count++;
     return t;
 }
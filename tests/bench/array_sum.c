@@ -0,0 +1,47 @@
+/* tests/bench/array_sum.c
+ * Kernel de soma de vetor para as otimizações de laço (src/ir/loop.c).
+ * A linguagem não tem vetores: o "vetor" são 16 globais inicializadas,
+ * emitidas em sequência na .data, percorridas por ponteiro.
+ *   make bench-loop        # tamanho do código com e sem -fno-loop-opt
+ */
+int v0 = 3;
+int v1 = 1;
+int v2 = 4;
+int v3 = 1;
+int v4 = 5;
+int v5 = 9;
+int v6 = 2;
+int v7 = 6;
+int v8 = 5;
+int v9 = 3;
+int v10 = 5;
+int v11 = 8;
+int v12 = 9;
+int v13 = 7;
+int v14 = 9;
+int v15 = 3;
+
+int soma(int *v, int n) {
+    int s = 0;
+    int i;
+    for (i = 0; i < n; i = i + 1)
+        s = s + *(v + i);
+    return s;
+}
+
+// n constante: contagem conhecida, o laço é desenrolado
+int soma16(int *v) {
+    int s = 0;
+    int i;
+    for (i = 0; i < 16; i = i + 1)
+        s = s + *(v + i);
+    return s;
+}
+
+int main() {
+    int t = 0;
+    int k;
+    for (k = 0; k < 100; k = k + 1)
+        t = t + soma(&v0, 16) + soma16(&v0);
+    return t;
+}
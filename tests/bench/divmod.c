@@ -0,0 +1,55 @@
+/* tests/bench/divmod.c
+ * Divisão e resto por constante (multiplicação pelo número mágico,
+ * src/ir/fold.c) contra o divisor só conhecido em execução, que chama
+ * __aeabi_idiv/__aeabi_idivmod. 'vazio' é o mesmo laço sem a operação:
+ * descontado dele, cada kernel dá o custo por operação. n e o divisor
+ * vêm de globais para o inlining não os tornar constantes.
+ *   make bench-div
+ */
+int vezes = 1000;
+int divisor = 10;
+
+int vazio(int n) {
+    int s = 0;
+    int i;
+    for (i = 0; i < n; i = i + 1)
+        s = s + i * 37;
+    return s;
+}
+
+int div_const(int n) {
+    int s = 0;
+    int i;
+    for (i = 0; i < n; i = i + 1)
+        s = s + i * 37 / 10;
+    return s;
+}
+
+int div_var(int n, int d) {
+    int s = 0;
+    int i;
+    for (i = 0; i < n; i = i + 1)
+        s = s + i * 37 / d;
+    return s;
+}
+
+int mod_const(int n) {
+    int s = 0;
+    int i;
+    for (i = 0; i < n; i = i + 1)
+        s = s + i * 37 % 10;
+    return s;
+}
+
+int mod_var(int n, int d) {
+    int s = 0;
+    int i;
+    for (i = 0; i < n; i = i + 1)
+        s = s + i * 37 % d;
+    return s;
+}
+
+int main() {
+    int n = vezes;
+    return vazio(n) + div_const(n) + div_var(n, divisor) + mod_const(n) + mod_var(n, divisor);
+}
@@ -0,0 +1,86 @@
+/* tests/bench/lexer_bench.c
+ * Vazão do lexer (MB/s) sobre um arquivo sintético grande.
+ *   make bench-lexer                      # 64 MB sintéticos
+ *   tests/bench/lexer_bench [MB] [arquivo.c]
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../../src/lexer/lexer.h"
+#include "arena.h"
+#include "intern.h"
+
+#define RUNS 5
+
+// Trecho típico: indentação, comentários, identificadores, números, operadores
+static const char *snippet =
+    "/* soma os elementos de um vetor\n"
+    " * e devolve o acumulado */\n"
+    "int soma_vetor(int *base, int quantidade, int passo_inicial) {\n"
+    "    int acumulado = 0;          // resultado parcial\n"
+    "    for (int indice = 0; indice < quantidade; indice++) {\n"
+    "        if (indice >= 0x10 && passo_inicial != 12345)\n"
+    "            acumulado = acumulado + *base * 3 - indice / 2;\n"
+    "        else\n"
+    "            acumulado = acumulado - 1;\n"
+    "    }\n"
+    "    while (acumulado <= 0 || quantidade == 0) acumulado = acumulado + 7;\n"
+    "    return acumulado;\n"
+    "}\n\n";
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static char *synth(size_t mb, size_t *len) {
+    size_t want = mb << 20, sl = strlen(snippet), n = 0;
+    char *buf = malloc(want + sl + 1);
+    if (!buf) { perror("malloc"); exit(1); }
+    while (n < want) {
+        memcpy(buf + n, snippet, sl);
+        n += sl;
+    }
+    buf[n] = '\0';
+    *len = n;
+    return buf;
+}
+
+static char *slurp(const char *path, size_t *len) {
+    FILE *f = fopen(path, "rb");
+    if (!f) { perror(path); exit(1); }
+    fseek(f, 0, SEEK_END);
+    long sz = ftell(f);
+    rewind(f);
+    char *buf = malloc(sz + 1);
+    if (!buf) { perror("malloc"); exit(1); }
+    *len = fread(buf, 1, sz, f);
+    buf[*len] = '\0';
+    fclose(f);
+    return buf;
+}
+
+int main(int argc, char **argv) {
+    size_t mb = argc > 1 ? (size_t)atoi(argv[1]) : 64, len;
+    char *src = argc > 2 ? slurp(argv[2], &len) : synth(mb ? mb : 1, &len);
+
+    double best = 1e30;
+    size_t ntok = 0;
+    for (int r = 0; r < RUNS; r++) {
+        double t0 = now();
+        Token *toks = tokenize_n(src, len);
+        double dt = now() - t0;
+        if (dt < best) best = dt;
+        for (ntok = 0; toks[ntok].kind != TK_EOF; ntok++)
+            ;
+        arena_release(&compile_arena);
+        intern_reset();
+    }
+    printf("lexer: %.1f MB em %.3f s (melhor de %d) -> %.1f MB/s, %.1f Mtokens/s\n",
+           len / 1048576.0, best, RUNS, len / 1048576.0 / best, ntok / best / 1e6);
+    free(src);
+    return 0;
+}
@@ -0,0 +1,71 @@
+/* tests/bench/parser_bench.c
+ * Estresse do parser: uma função com um corpo enorme (100k statements por
+ * padrão), para expor custo quadrático na montagem das listas de filhos.
+ *   make bench-parser
+ *   tests/bench/parser_bench [statements]
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../../src/lexer/lexer.h"
+#include "../../src/parser/parser.h"
+#include "arena.h"
+#include "intern.h"
+#include "type.h"
+
+#define RUNS 5
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Monta: int f(int a,int b,int c){return a;}  int main(){ ...n stmts... }
+static char *synth(int n, size_t *len) {
+    size_t cap = (size_t)n * 48 + 256, used = 0;
+    char *buf = malloc(cap);
+    if (!buf) { perror("malloc"); exit(1); }
+    used += sprintf(buf + used, "int f(int a, int b, int c) { return a; }\n"
+                                "int main() {\n    int x = 0, y = 1, *p = &x;\n");
+    for (int i = 0; i < n; i++) {
+        switch (i & 3) {
+        case 0: used += sprintf(buf + used, "    x = x + %d * y;\n", i); break;
+        case 1: used += sprintf(buf + used, "    int v%d = %d, w%d;\n", i, i, i); break;
+        case 2: used += sprintf(buf + used, "    y = f(x, y, %d);\n", i); break;
+        case 3: used += sprintf(buf + used, "    if (x < %d) { *p = y; }\n", i); break;
+        }
+    }
+    used += sprintf(buf + used, "    return x;\n}\n");
+    *len = used;
+    return buf;
+}
+
+int main(int argc, char **argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 100000;
+    size_t len;
+    char *src = synth(n > 0 ? n : 1, &len);
+
+    double best = 1e30;
+    int body = 0;
+    for (int r = 0; r < RUNS; r++) {
+        init_types();
+        double t0 = now();
+        Lexer lx;
+        lexer_init(&lx, src, len);
+        NodeId ast = parse_program(&lx);
+        double dt = now() - t0;
+        if (dt < best) best = dt;
+        NodeId last = nd_list(ast)[nd_count(ast) - 1];
+        body = nd_count(nd_body(last));
+        arena_release(&compile_arena);
+        ast_release();
+        intern_reset();
+    }
+    printf("parser: %d statements (%.1f MB) em %.3f s (melhor de %d) -> %.2f Mstmts/s\n",
+           body, len / 1048576.0, best, RUNS, body / best / 1e6);
+    free(src);
+    return 0;
+}
@@ -0,0 +1,24 @@
+// Condições desviam direto pelas flags: nenhum 0/1 materializado
+// nos testes de if/while/for, nem dentro de && e ||.
+int primeiro(int de, int ate, int passo) {
+    int i;
+    for (i = de; i < ate; i = i + passo) {
+        if (i / 7 * 7 == i && i != 0)
+            return i;
+    }
+    return -1;
+}
+
+int conta(int a, int b) {
+    int n;
+    n = 0;
+    while (a < b || a == 0) {
+        a = a + 1;
+        n = n + 1;
+    }
+    return n;
+}
+
+int main() {
+    return primeiro(1, 100, 3) + conta(0, 5);
+}
@@ -0,0 +1,138 @@
+.syntax unified
+.text
+.global _start
+_start:
+    ldr sp, =_stack_top   @ pilha = topo reservado no linker
+    ldr ip, =main
+    mov lr, pc
+    bx ip            @ chama main(), em Thumb
+    mov r7, #0x18     @ SYS_EXIT
+    svc 0x123456 
+.ltorg
+
+.text
+.thumb
+.global primeiro
+.thumb_func
+primeiro:
+    push {r4-r6, lr}
+    sub sp, #4
+    movs r5, r2
+    movs r4, r1
+    str r0, [sp, #0]
+    b .Lprimeiro_3
+.Lprimeiro_1:
+    ldr r0, [sp, #0]
+    ldr r1, =-1840700269
+    bl ____smulh_from_thumb
+    ldr r6, [sp, #0]
+    adds r0, r0, r6
+    asrs r0, r0, #2
+    lsrs r1, r0, #31
+    adds r0, r0, r1
+    movs r6, #7
+    muls r0, r6, r0
+    ldr r6, [sp, #0]
+    cmp r0, r6
+    bne .Lprimeiro_2
+.Lprimeiro_7:
+    ldr r6, [sp, #0]
+    cmp r6, #0
+    beq .Lprimeiro_2
+.Lprimeiro_5:
+    ldr r0, [sp, #0]
+    b .Lep_primeiro
+.Lprimeiro_2:
+    ldr r6, [sp, #0]
+    adds r6, r6, r5
+    str r6, [sp, #0]
+.Lprimeiro_3:
+    ldr r6, [sp, #0]
+    cmp r6, r4
+    blt .Lprimeiro_1
+.Lprimeiro_4:
+    movs r0, #0
+    mvns r0, r0
+.Lep_primeiro:
+    add sp, #4
+    pop {r4-r6, pc}
+.ltorg
+.global conta
+.thumb_func
+conta:
+    movs r2, #0
+    b .Lconta_2
+.Lconta_1:
+    adds r0, r0, #1
+    adds r2, r2, #1
+.Lconta_2:
+    cmp r0, r1
+    blt .Lconta_1
+.Lconta_4:
+    cmp r0, #0
+    beq .Lconta_1
+.Lconta_3:
+    movs r0, r2
+.Lep_conta:
+    bx lr
+.global main
+.thumb_func
+main:
+    push {r4, r6, lr}
+    movs r4, #1
+    b .Lmain_8
+.Lmain_4:
+    movs r0, r4
+    ldr r1, =-1840700269
+    bl ____smulh_from_thumb
+    adds r0, r0, r4
+    asrs r0, r0, #2
+    lsrs r1, r0, #31
+    adds r0, r0, r1
+    movs r6, #7
+    muls r0, r6, r0
+    cmp r0, r4
+    bne .Lmain_7
+.Lmain_5:
+    cmp r4, #0
+    beq .Lmain_7
+.Lmain_6:
+    movs r0, r4
+    b .Lmain_11
+.Lmain_7:
+    adds r4, r4, #3
+.Lmain_8:
+    cmp r4, #100
+    blt .Lmain_4
+.Lmain_9:
+    movs r0, #0
+    mvns r0, r0
+.Lmain_11:
+    movs r1, #0
+    movs r2, #0
+    b .Lmain_13
+.Lmain_12:
+    adds r1, r1, #1
+    adds r2, r2, #1
+.Lmain_13:
+    cmp r1, #5
+    blt .Lmain_12
+.Lmain_14:
+    cmp r1, #0
+    beq .Lmain_12
+.Lmain_15:
+    adds r0, r0, r2
+.Lep_main:
+    pop {r4, r6}
+    pop {r3}
+    bx r3
+.ltorg
+.arm
+.thumb
+.align 2
+.thumb_func
+____smulh_from_thumb:
+    bx pc
+    nop 
+.arm
+    b __smulh
@@ -0,0 +1,16 @@
+int mask = -65536;
+
+int pick(int x) {
+    if (x < -257)
+        return 305419896;
+    if (x == 16711935)
+        return -1;
+    return x + 1020 - 4096;
+}
+
+int main() {
+    int a = pick(-300) - 305419896;
+    int b = pick(16711935) + 1;
+    int c = pick(4096) - 1020;
+    return a + b + c + (mask + 65536);
+}
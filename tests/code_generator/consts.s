@@ -0,0 +1,59 @@
+.syntax unified
+.text
+.global _start
+_start:
+    ldr sp, =_stack_top   @ pilha = topo reservado no linker
+    ldr ip, =main
+    mov lr, pc
+    bx ip            @ chama main(), em Thumb
+    mov r7, #0x18     @ SYS_EXIT
+    svc 0x123456 
+.ltorg
+
+.data
+mask:
+    .word -65536
+.text
+.thumb
+.global pick
+.thumb_func
+pick:
+    push {r6}
+    ldr r6, =-257
+    cmp r0, r6
+    bge .Lpick_2
+.Lpick_1:
+    ldr r0, =305419896
+    b .Lep_pick
+.Lpick_2:
+    ldr r6, =16711935
+    cmp r0, r6
+    bne .Lpick_5
+.Lpick_4:
+    movs r0, #0
+    mvns r0, r0
+    b .Lep_pick
+.Lpick_5:
+    movs r6, #255
+    lsls r6, r6, #2
+    adds r0, r0, r6
+    ldr r6, =-4096
+    adds r0, r0, r6
+.Lep_pick:
+    pop {r6}
+    bx lr
+.ltorg
+.global main
+.thumb_func
+main:
+    push {r6}
+    ldr r0, =mask
+    ldr r0, [r0, #0]
+    movs r6, #1
+    lsls r6, r6, #16
+    adds r0, r0, r6
+.Lep_main:
+    pop {r6}
+    bx lr
+.ltorg
+.arm
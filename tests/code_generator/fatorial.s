@@ -0,0 +1,41 @@
+.syntax unified
+.text
+.global _start
+_start:
+    ldr sp, =_stack_top   @ pilha = topo reservado no linker
+    ldr ip, =main
+    mov lr, pc
+    bx ip            @ chama main(), em Thumb
+    mov r7, #0x18     @ SYS_EXIT
+    svc 0x123456 
+.ltorg
+
+.text
+.thumb
+.global fatorial
+.thumb_func
+fatorial:
+    movs r1, #1
+.Lfatorial_5:
+    cmp r0, #1
+    bgt .Lfatorial_2
+.Lfatorial_1:
+    movs r0, r1
+    bx lr
+.Lfatorial_2:
+    subs r2, r0, #1
+    muls r1, r0, r1
+    movs r0, r2
+    b .Lfatorial_5
+.Lep_fatorial:
+    bx lr
+.global main
+.thumb_func
+main:
+    push {lr}
+    movs r0, #5
+    bl fatorial
+.Lep_main:
+    pop {r3}
+    bx r3
+.arm
@@ -0,0 +1,24 @@
+// Quadros sob medida: 'soma' é folha e não empilha nada (volta com
+// mov pc, lr); 'media' lê argumentos da pilha relativos a sp e salva lr
+// por causa de __aeabi_idiv; 'usa_endereco' é folha mas precisa de fp
+// por causa do slot de 'x'.
+int soma(int a, int b) {
+    return a + b;
+}
+
+int media(int a, int b, int c, int d, int e, int f) {
+    return (a + b + c + d + e + f) / 6;
+}
+
+int usa_endereco(int v) {
+    int x;
+    int *p;
+    x = v;
+    p = &x;
+    *p = *p + 1;
+    return x;
+}
+
+int main() {
+    return soma(1, 2) + media(1, 2, 3, 4, 5, 6) + usa_endereco(4);
+}
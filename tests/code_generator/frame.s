@@ -0,0 +1,77 @@
+.syntax unified
+.text
+.global _start
+_start:
+    ldr sp, =_stack_top   @ pilha = topo reservado no linker
+    ldr ip, =main
+    mov lr, pc
+    bx ip            @ chama main(), em Thumb
+    mov r7, #0x18     @ SYS_EXIT
+    svc 0x123456 
+.ltorg
+
+.text
+.thumb
+.global soma
+.thumb_func
+soma:
+    adds r0, r0, r1
+.Lep_soma:
+    bx lr
+.global media
+.thumb_func
+media:
+    push {r4-r5, lr}
+    ldr r4, [sp, #12]
+    ldr r5, [sp, #16]
+    adds r0, r0, r1
+    adds r0, r0, r2
+    adds r0, r0, r3
+    adds r0, r0, r4
+    adds r0, r0, r5
+    ldr r1, =715827883
+    bl ____smulh_from_thumb
+    lsrs r1, r0, #31
+    adds r0, r0, r1
+.Lep_media:
+    pop {r4-r5, pc}
+.ltorg
+.global usa_endereco
+.thumb_func
+usa_endereco:
+    sub sp, #4
+    str r0, [sp, #0]
+    add r0, sp, #0
+    ldr r1, [r0, #0]
+    adds r1, r1, #1
+    str r1, [r0, #0]
+    ldr r0, [sp, #0]
+.Lep_usa_endereco:
+    add sp, #4
+    bx lr
+.global main
+.thumb_func
+main:
+    push {r6}
+    sub sp, #4
+    movs r6, #4
+    str r6, [sp, #0]
+    add r0, sp, #0
+    ldr r1, [r0, #0]
+    adds r1, r1, #1
+    str r1, [r0, #0]
+    ldr r0, [sp, #0]
+    adds r0, r0, #6
+.Lep_main:
+    add sp, #4
+    pop {r6}
+    bx lr
+.arm
+.thumb
+.align 2
+.thumb_func
+____smulh_from_thumb:
+    bx pc
+    nop 
+.arm
+    b __smulh
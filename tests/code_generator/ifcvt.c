@@ -0,0 +1,22 @@
+// if/else curtos viram instruções predicadas (movgt, rsblt, addne...)
+// em vez de desvios; braços longos ou com chamadas continuam desviando.
+int maior(int a, int b) {
+    if (a > b)
+        return a;
+    else
+        return b;
+}
+
+int modulo(int a) {
+    if (a < 0)
+        a = 0 - a;
+    return a;
+}
+
+int main(int a, int b) {
+    int c = b + 1 + 5;
+    if (a > 0)
+        return maior(c, modulo(b));
+    else
+        return 1;
+}
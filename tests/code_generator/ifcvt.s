@@ -0,0 +1,65 @@
+.syntax unified
+.text
+.global _start
+_start:
+    ldr sp, =_stack_top   @ pilha = topo reservado no linker
+    ldr ip, =main
+    mov lr, pc
+    bx ip            @ chama main(), em Thumb
+    mov r7, #0x18     @ SYS_EXIT
+    svc 0x123456 
+.ltorg
+
+.text
+.thumb
+.global maior
+.thumb_func
+maior:
+    cmp r1, r0
+    bge .Lmaior_2
+.Lmaior_1:
+    bx lr
+.Lmaior_2:
+    movs r0, r1
+.Lep_maior:
+    bx lr
+.global modulo
+.thumb_func
+modulo:
+    cmp r0, #0
+    bge .Lmodulo_2
+.Lmodulo_1:
+    rsbs r0, r0, #0
+.Lmodulo_2:
+.Lep_modulo:
+    bx lr
+.global main
+.thumb_func
+main:
+    adds r2, r1, #1
+    adds r2, r2, #5
+    cmp r0, #0
+    ble .Lmain_2
+.Lmain_7:
+    movs r0, r1
+    cmp r1, #0
+    bge .Lmain_9
+.Lmain_8:
+    rsbs r0, r0, #0
+.Lmain_9:
+    movs r1, r2
+    movs r3, r0
+    cmp r0, r2
+    bge .Lmain_13
+.Lmain_12:
+    movs r0, r1
+    b .Lmain_10
+.Lmain_13:
+    movs r0, r3
+.Lmain_10:
+    bx lr
+.Lmain_2:
+    movs r0, #1
+.Lep_main:
+    bx lr
+.arm
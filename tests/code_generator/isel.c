@@ -0,0 +1,42 @@
+// Seleção de instruções (isel.c): o deslocamento entra no segundo
+// operando (add r0, r0, r1, lsl #3), 'b*4 - a' vira rsb, 'a*b + c' vira
+// mla, '*(p + i)' vira ldr/str com índice escalado e a multiplicação por
+// constante vira somas deslocadas (x*10: add + mov; x*7: rsb). Com
+// -mcpu=arm9tdmi também x*100, que no ARM7TDMI fica no mul.
+int v0;
+int v1;
+int v2;
+int v3;
+
+int le(int *p, int i) {
+    return *(p + i);
+}
+
+int escreve(int *p, int i, int v) {
+    *(p + i) = v;
+    return v;
+}
+
+int desloca(int a, int b) {
+    return a + b * 8;
+}
+
+int invertida(int a, int b) {
+    return b * 4 - a;
+}
+
+int acumula(int a, int b, int c) {
+    return a * b + c;
+}
+
+int constantes(int x) {
+    return x * 10 + x * 7 + x * 100;
+}
+
+int main() {
+    int *p = &v0;
+    int i;
+    for (i = 0; i < 4; i = i + 1)
+        escreve(p, i * 0, i);
+    return le(p, 0) + desloca(1, 2) + invertida(3, 4) + acumula(3, 4, 5) + constantes(3);
+}
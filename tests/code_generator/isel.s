@@ -0,0 +1,126 @@
+.syntax unified
+.text
+.global _start
+_start:
+    ldr sp, =_stack_top   @ pilha = topo reservado no linker
+    ldr r0, =_bss_start
+    mov r1, #0
+    str r1, [r0, #0]
+    str r1, [r0, #4]
+    str r1, [r0, #8]
+    str r1, [r0, #12]
+    ldr ip, =main
+    mov lr, pc
+    bx ip            @ chama main(), em Thumb
+    mov r7, #0x18     @ SYS_EXIT
+    svc 0x123456 
+.ltorg
+
+.bss
+v0:
+    .space 4
+v1:
+    .space 4
+v2:
+    .space 4
+v3:
+    .space 4
+.text
+.thumb
+.global le
+.thumb_func
+le:
+    mov ip, r0
+    movs r0, r1
+    mov r1, ip
+    lsls r0, r0, #2
+    ldr r0, [r1, r0]
+.Lep_le:
+    bx lr
+.global escreve
+.thumb_func
+escreve:
+    mov ip, r0
+    movs r0, r1
+    mov r1, ip
+    lsls r0, r0, #2
+    str r2, [r1, r0]
+    movs r0, r2
+.Lep_escreve:
+    bx lr
+.global desloca
+.thumb_func
+desloca:
+    mov ip, r0
+    movs r0, r1
+    mov r1, ip
+    lsls r0, r0, #3
+    adds r0, r1, r0
+.Lep_desloca:
+    bx lr
+.global invertida
+.thumb_func
+invertida:
+    mov ip, r0
+    movs r0, r1
+    mov r1, ip
+    lsls r0, r0, #2
+    subs r0, r0, r1
+.Lep_invertida:
+    bx lr
+.global acumula
+.thumb_func
+acumula:
+    muls r0, r1, r0
+    adds r0, r0, r2
+.Lep_acumula:
+    bx lr
+.global constantes
+.thumb_func
+constantes:
+    push {r6}
+    movs r6, #10
+    movs r1, r6
+    muls r1, r0, r1
+    movs r6, #7
+    movs r2, r6
+    muls r2, r0, r2
+    adds r1, r1, r2
+    movs r6, #100
+    muls r0, r6, r0
+    adds r0, r1, r0
+.Lep_constantes:
+    pop {r6}
+    bx lr
+.global main
+.thumb_func
+main:
+    push {r6}
+    ldr r0, =v0
+    movs r1, #0
+    b .Lmain_3
+.Lmain_7:
+    str r1, [r0, #0]
+    adds r1, r1, #1
+    str r1, [r0, #0]
+    adds r1, r1, #1
+    str r1, [r0, #0]
+    adds r1, r1, #1
+    str r1, [r0, #0]
+    adds r1, r1, #1
+.Lmain_3:
+    cmp r1, #4
+    blt .Lmain_7
+.Lmain_9:
+    ldr r0, [r0, #0]
+    adds r0, #17
+    adds r0, #13
+    adds r0, #17
+    movs r6, #255
+    adds r6, #96
+    adds r0, r0, r6
+.Lep_main:
+    pop {r6}
+    bx lr
+.ltorg
+.arm
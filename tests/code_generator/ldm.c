@@ -0,0 +1,77 @@
+// Acessos múltiplos e endereçamento com escrita de volta: as duas
+// primeiras cargas de 'copia' vão num ldmia (a terceira cai no registrador
+// da base, fora de ordem), as duas últimas escritas de 'tras' num stmib,
+// as locais com '&' de 'locais' num stmdb sp! (que absorve o sub do
+// quadro) e num ldmia sp; em 'soma' e 'dobra', *p++ vira ldr/str
+// pós-indexado (ldr r3, [r0], #4) e em 'volta', com p--, ldr [r0], #-4.
+int v0 = 1;
+int v1 = 2;
+int v2 = 3;
+int v3 = 4;
+int v4 = 5;
+int v5 = 6;
+int v6 = 7;
+int v7 = 8;
+
+int copia(int *d, int *s) {
+    int a = *s;
+    int b = *(s + 1);
+    int c = *(s + 2);
+    *(d + 1) = a + b;
+    *(d + 2) = c - b;
+    return a * c;
+}
+
+int tras(int *p) {
+    int a = *(p + 3);
+    int b = *(p + 2);
+    int c = *(p + 1);
+    *(p + 3) = c;
+    *(p + 2) = b + c;
+    *(p + 1) = a;
+    return a - b;
+}
+
+int locais(int x) {
+    int a = x;
+    int b = x + 1;
+    int c = x * 2;
+    int d = x - 7;
+    int *pa = &a;
+    int *pd = &d;
+    *pa = *pa + *pd;
+    return a * 1000 + b * 100 + c * 10 + d;
+}
+
+int soma(int *p, int n) {
+    int s = 0;
+    while (n > 0) {
+        s = s + *p++;
+        n--;
+    }
+    return s;
+}
+
+int dobra(int *d, int *s, int n) {
+    while (n > 0) {
+        *d++ = *s++ * 2;
+        n--;
+    }
+    return n;
+}
+
+int volta(int *p, int n) {
+    int s = 0;
+    int *q = p + n;
+    while (q != p)
+        s = s * 3 + *q--;
+    return s + *q;
+}
+
+int main() {
+    int *p = &v0;
+    int r = copia(p + 4, p);
+    r = r + tras(p) + locais(3);
+    dobra(p + 4, p, 4);
+    return r + soma(p, 8) + volta(p, 7);
+}
@@ -0,0 +1,260 @@
+.syntax unified
+.text
+.global _start
+_start:
+    ldr sp, =_stack_top   @ pilha = topo reservado no linker
+    ldr ip, =main
+    mov lr, pc
+    bx ip            @ chama main(), em Thumb
+    mov r7, #0x18     @ SYS_EXIT
+    svc 0x123456 
+.ltorg
+
+.data
+v0:
+    .word 1
+v1:
+    .word 2
+v2:
+    .word 3
+v3:
+    .word 4
+v4:
+    .word 5
+v5:
+    .word 6
+v6:
+    .word 7
+v7:
+    .word 8
+.text
+.thumb
+.global copia
+.thumb_func
+copia:
+    push {r4}
+    mov ip, r0
+    movs r0, r1
+    mov r1, ip
+    ldr r2, [r0, #0]
+    ldr r3, [r0, #4]
+    ldr r0, [r0, #8]
+    adds r4, r2, r3
+    str r4, [r1, #4]
+    subs r3, r0, r3
+    str r3, [r1, #8]
+    muls r0, r2, r0
+.Lep_copia:
+    pop {r4}
+    bx lr
+.global tras
+.thumb_func
+tras:
+    ldr r1, [r0, #12]
+    ldr r2, [r0, #8]
+    ldr r3, [r0, #4]
+    str r3, [r0, #12]
+    adds r3, r2, r3
+    str r3, [r0, #8]
+    str r1, [r0, #4]
+    subs r0, r1, r2
+.Lep_tras:
+    bx lr
+.global locais
+.thumb_func
+locais:
+    push {r4, r6}
+    sub sp, #8
+    str r0, [sp, #0]
+    adds r1, r0, #1
+    lsls r2, r0, #1
+    subs r0, r0, #7
+    str r0, [sp, #4]
+    add r0, sp, #0
+    add r3, sp, #4
+    ldr r4, [r0, #0]
+    ldr r3, [r3, #0]
+    adds r3, r4, r3
+    str r3, [r0, #0]
+    ldr r0, [sp, #0]
+    movs r6, #125
+    lsls r6, r6, #3
+    muls r0, r6, r0
+    movs r6, #100
+    muls r1, r6, r1
+    adds r0, r0, r1
+    movs r6, #10
+    movs r1, r6
+    muls r1, r2, r1
+    adds r0, r0, r1
+    ldr r1, [sp, #4]
+    adds r0, r0, r1
+.Lep_locais:
+    add sp, #8
+    pop {r4, r6}
+    bx lr
+.global soma
+.thumb_func
+soma:
+    movs r2, #0
+    b .Lsoma_2
+.Lsoma_1:
+    ldr r3, [r0, #0]
+    adds r0, r0, #4
+    adds r2, r2, r3
+    subs r1, r1, #1
+.Lsoma_2:
+    cmp r1, #0
+    bgt .Lsoma_1
+.Lsoma_3:
+    movs r0, r2
+.Lep_soma:
+    bx lr
+.global dobra
+.thumb_func
+dobra:
+    b .Ldobra_2
+.Ldobra_1:
+    ldr r3, [r1, #0]
+    adds r1, r1, #4
+    lsls r3, r3, #1
+    str r3, [r0, #0]
+    adds r0, r0, #4
+    subs r2, r2, #1
+.Ldobra_2:
+    cmp r2, #0
+    bgt .Ldobra_1
+.Ldobra_3:
+    movs r0, r2
+.Lep_dobra:
+    bx lr
+.global volta
+.thumb_func
+volta:
+    push {r4, r6}
+    mov ip, r0
+    movs r0, r1
+    mov r1, ip
+    movs r2, #0
+    lsls r0, r0, #2
+    adds r0, r1, r0
+    b .Lvolta_2
+.Lvolta_1:
+    movs r6, #3
+    movs r3, r6
+    muls r3, r2, r3
+    ldr r4, [r0, #0]
+    subs r0, r0, #4
+    adds r2, r3, r4
+.Lvolta_2:
+    cmp r0, r1
+    bne .Lvolta_1
+.Lvolta_3:
+    ldr r0, [r0, #0]
+    adds r0, r2, r0
+.Lep_volta:
+    pop {r4, r6}
+    bx lr
+.global main
+.thumb_func
+main:
+    push {r4-r6}
+    sub sp, #8
+    ldr r0, =v0
+    movs r1, r0
+    adds r1, #16
+    ldr r2, [r0, #0]
+    ldr r3, [r0, #4]
+    ldr r4, [r0, #8]
+    adds r5, r2, r3
+    str r5, [r1, #4]
+    subs r3, r4, r3
+    str r3, [r1, #8]
+    movs r1, r4
+    muls r1, r2, r1
+    movs r2, r1
+    ldr r3, [r0, #12]
+    ldr r4, [r0, #8]
+    ldr r5, [r0, #4]
+    str r5, [r0, #12]
+    adds r5, r4, r5
+    str r5, [r0, #8]
+    str r3, [r0, #4]
+    subs r3, r3, r4
+    adds r1, r1, r3
+    movs r6, #3
+    str r6, [sp, #0]
+    movs r6, #3
+    mvns r6, r6
+    str r6, [sp, #4]
+    add r3, sp, #0
+    add r4, sp, #4
+    ldr r5, [r3, #0]
+    ldr r4, [r4, #0]
+    adds r4, r5, r4
+    str r4, [r3, #0]
+    ldr r3, [sp, #0]
+    movs r6, #125
+    lsls r6, r6, #3
+    muls r3, r6, r3
+    movs r6, #255
+    adds r6, #145
+    adds r3, r3, r6
+    adds r3, #60
+    ldr r4, [sp, #4]
+    adds r3, r3, r4
+    adds r2, r1, r3
+    movs r1, r0
+    adds r1, #16
+    movs r3, r0
+    movs r4, #4
+    b .Lmain_11
+.Lmain_10:
+    ldr r5, [r3, #0]
+    adds r3, r3, #4
+    lsls r5, r5, #1
+    str r5, [r1, #0]
+    adds r1, r1, #4
+    subs r4, r4, #1
+.Lmain_11:
+    cmp r4, #0
+    bgt .Lmain_10
+.Lmain_14:
+    movs r1, r0
+    movs r3, #8
+    movs r4, #0
+    b .Lmain_16
+.Lmain_15:
+    ldr r5, [r1, #0]
+    adds r1, r1, #4
+    adds r4, r4, r5
+    subs r3, r3, #1
+.Lmain_16:
+    cmp r3, #0
+    bgt .Lmain_15
+.Lmain_17:
+    adds r1, r2, r4
+    movs r2, r0
+    movs r3, #0
+    adds r0, #28
+    b .Lmain_21
+.Lmain_20:
+    movs r6, #3
+    movs r4, r6
+    muls r4, r3, r4
+    ldr r5, [r0, #0]
+    subs r0, r0, #4
+    adds r3, r4, r5
+.Lmain_21:
+    cmp r0, r2
+    bne .Lmain_20
+.Lmain_22:
+    ldr r0, [r0, #0]
+    adds r0, r3, r0
+    adds r0, r1, r0
+.Lep_main:
+    add sp, #8
+    pop {r4-r6}
+    bx lr
+.ltorg
+.arm
@@ -0,0 +1,28 @@
+.syntax unified
+.text
+.global _start
+_start:
+    ldr sp, =_stack_top   @ pilha = topo reservado no linker
+    ldr ip, =main
+    mov lr, pc
+    bx ip            @ chama main(), em Thumb
+    mov r7, #0x18     @ SYS_EXIT
+    svc 0x123456 
+.ltorg
+
+.text
+.thumb
+.global main
+.thumb_func
+main:
+    movs r0, #0
+    b .Lmain_2
+.Lmain_1:
+    adds r0, r0, #1
+.Lmain_2:
+    cmp r0, #10
+    ble .Lmain_1
+.Lmain_3:
+.Lep_main:
+    bx lr
+.arm
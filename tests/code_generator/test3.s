@@ -0,0 +1,31 @@
+.syntax unified
+.text
+.global _start
+_start:
+    ldr sp, =_stack_top   @ pilha = topo reservado no linker
+    ldr ip, =main
+    mov lr, pc
+    bx ip            @ chama main(), em Thumb
+    mov r7, #0x18     @ SYS_EXIT
+    svc 0x123456 
+.ltorg
+
+.text
+.thumb
+.global main
+.thumb_func
+main:
+    mov ip, r0
+    movs r0, r1
+    mov r1, ip
+    adds r0, r0, #1
+    adds r0, r0, #5
+    cmp r1, #0
+    ble .Lmain_2
+.Lmain_1:
+    bx lr
+.Lmain_2:
+    movs r0, #1
+.Lep_main:
+    bx lr
+.arm
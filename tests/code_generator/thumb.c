@@ -0,0 +1,43 @@
+// Thumb e interworking (-mthumb, -mthumb=auto; com -finline-limit=0 as
+// chamadas ficam): com -mthumb=auto 'soma' tem laço e fica em ARM, as
+// demais vão para Thumb. 'main' é chamada pelo _start com bx; de Thumb
+// para 'soma' e para __aeabi_idivmod (ARM) a chamada passa pelo stub
+// __X_from_thumb, e 'soma' volta com bx lr. 'seis' lê o 5º e o 6º
+// argumentos da pilha (push antes do bl), 'menor' é uma comparação como
+// valor (desvio no lugar de movlt) e 'gira' usa lsls e muls com os
+// operandos repetidos.
+int g = 7;
+
+int soma(int *p, int n) {
+    int s = 0;
+    while (n > 0) {
+        s = s + *p;
+        p = p + 1;
+        n = n - 1;
+    }
+    return s;
+}
+
+int seis(int a, int b, int c, int d, int e, int f) {
+    return a - b + c - d + e * f;
+}
+
+int menor(int a, int b) {
+    return a < b;
+}
+
+int gira(int x, int k) {
+    return x * 8 + x * x - k;
+}
+
+int resto(int a, int b) {
+    return a % b;
+}
+
+int main() {
+    int v = 3;
+    int *p = &v;
+    int r = soma(p, 1) + seis(1, 2, 3, 4, 5, g);
+    r = r + menor(r, 100) + gira(r, 2);
+    return r + resto(r, 9) + r / 10;
+}
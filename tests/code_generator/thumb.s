@@ -0,0 +1,160 @@
+.syntax unified
+.text
+.global _start
+_start:
+    ldr sp, =_stack_top   @ pilha = topo reservado no linker
+    ldr ip, =main
+    mov lr, pc
+    bx ip            @ chama main(), em Thumb
+    mov r7, #0x18     @ SYS_EXIT
+    svc 0x123456 
+.ltorg
+
+.data
+g:
+    .word 7
+.text
+.thumb
+.global soma
+.thumb_func
+soma:
+    movs r2, #0
+    b .Lsoma_2
+.Lsoma_1:
+    ldr r3, [r0, #0]
+    adds r2, r2, r3
+    adds r0, r0, #4
+    subs r1, r1, #1
+.Lsoma_2:
+    cmp r1, #0
+    bgt .Lsoma_1
+.Lsoma_3:
+    movs r0, r2
+.Lep_soma:
+    bx lr
+.global seis
+.thumb_func
+seis:
+    push {r4-r5}
+    ldr r4, [sp, #8]
+    ldr r5, [sp, #12]
+    subs r0, r0, r1
+    adds r0, r0, r2
+    subs r0, r0, r3
+    movs r1, r5
+    muls r1, r4, r1
+    adds r0, r0, r1
+.Lep_seis:
+    pop {r4-r5}
+    bx lr
+.global menor
+.thumb_func
+menor:
+    push {r6}
+    movs r6, #1
+    cmp r0, r1
+    blt .Lt1
+    movs r6, #0
+.Lt1:
+    movs r0, r6
+.Lep_menor:
+    pop {r6}
+    bx lr
+.global gira
+.thumb_func
+gira:
+    push {r6}
+    lsls r2, r0, #3
+    movs r6, r0
+    muls r0, r6, r0
+    adds r0, r2, r0
+    subs r0, r0, r1
+.Lep_gira:
+    pop {r6}
+    bx lr
+.global resto
+.thumb_func
+resto:
+    push {lr}
+    bl ____aeabi_idivmod_from_thumb
+    movs r0, r1
+.Lep_resto:
+    pop {pc}
+.global main
+.thumb_func
+main:
+    push {r4-r6, lr}
+    sub sp, #4
+    movs r6, #3
+    str r6, [sp, #0]
+    add r0, sp, #0
+    movs r1, #1
+    movs r2, #0
+    b .Lmain_5
+.Lmain_4:
+    ldr r3, [r0, #0]
+    adds r2, r2, r3
+    adds r0, r0, #4
+    subs r1, r1, #1
+.Lmain_5:
+    cmp r1, #0
+    bgt .Lmain_4
+.Lmain_6:
+    ldr r0, =g
+    ldr r0, [r0, #0]
+    movs r6, #5
+    muls r0, r6, r0
+    subs r0, r0, #2
+    adds r4, r2, r0
+    movs r0, #1
+    cmp r4, #100
+    blt .Lt3
+    movs r0, #0
+.Lt3:
+    adds r0, r4, r0
+    lsls r1, r4, #3
+    movs r2, r4
+    muls r2, r4, r2
+    adds r1, r1, r2
+    subs r1, r1, #2
+    adds r4, r0, r1
+    movs r0, r4
+    ldr r1, =954437177
+    bl ____smulh_from_thumb
+    asrs r0, r0, #1
+    lsrs r1, r0, #31
+    adds r0, r0, r1
+    movs r6, #9
+    muls r0, r6, r0
+    subs r0, r4, r0
+    adds r5, r4, r0
+    movs r0, r4
+    ldr r1, =1717986919
+    bl ____smulh_from_thumb
+    asrs r0, r0, #2
+    lsrs r1, r0, #31
+    adds r0, r0, r1
+    adds r0, r5, r0
+.Lep_main:
+    add sp, #4
+    pop {r4-r6}
+    pop {r3}
+    bx r3
+.ltorg
+.arm
+.thumb
+.align 2
+.thumb_func
+____aeabi_idivmod_from_thumb:
+    bx pc
+    nop 
+.arm
+    b __aeabi_idivmod
+.thumb
+.align 2
+.thumb_func
+____smulh_from_thumb:
+    bx pc
+    nop 
+.arm
+    b __smulh
@@ -0,0 +1,37 @@
+// Cópias só dentro do bloco: 'last = v' está no laço e 'v' muda a cada
+// volta, então 'return last' não pode virar 'return v' (ultimo(6) é 5,
+// não 11). Em 'primeiro', 'first' guarda o valor da primeira volta
+// (96), não o da última.
+int g(int i) {
+    return i * 3 - 4;
+}
+
+int ultimo(int n) {
+    int i = 0;
+    int last;
+    while (i < n) {
+        int v = g(i);
+        if (v > 0 && v < 6) last = v;
+        i++;
+    }
+    return last;
+}
+
+int primeiro(int n) {
+    int i = 0;
+    int achou = 0;
+    int first;
+    while (i < n) {
+        int v = g(i) + 100;
+        if (achou == 0) {
+            first = v;
+            achou = 1;
+        }
+        i++;
+    }
+    return first;
+}
+
+int main() {
+    return ultimo(6) + primeiro(5);
+}
@@ -0,0 +1,125 @@
+.syntax unified
+.text
+.global _start
+_start:
+    ldr sp, =_stack_top   @ pilha = topo reservado no linker
+    ldr ip, =main
+    mov lr, pc
+    bx ip            @ chama main(), em Thumb
+    mov r7, #0x18     @ SYS_EXIT
+    svc 0x123456 
+.ltorg
+
+.text
+.thumb
+.global g
+.thumb_func
+g:
+    push {r6}
+    movs r6, #3
+    muls r0, r6, r0
+    subs r0, r0, #4
+.Lep_g:
+    pop {r6}
+    bx lr
+.global ultimo
+.thumb_func
+ultimo:
+    push {r4}
+    movs r2, #0
+    movs r3, #3
+    mvns r3, r3
+    b .Lultimo_2
+.Lultimo_9:
+    movs r4, r3
+    cmp r3, #0
+    ble .Lultimo_5
+.Lultimo_6:
+    cmp r4, #6
+    bge .Lultimo_5
+.Lultimo_4:
+    movs r1, r4
+.Lultimo_5:
+    adds r2, r2, #1
+    adds r3, r3, #3
+.Lultimo_2:
+    cmp r2, r0
+    blt .Lultimo_9
+.Lultimo_3:
+    movs r0, r1
+.Lep_ultimo:
+    pop {r4}
+    bx lr
+.global primeiro
+.thumb_func
+primeiro:
+    push {r4-r5}
+    movs r2, #0
+    movs r3, #0
+    movs r4, #96
+    b .Lprimeiro_2
+.Lprimeiro_8:
+    movs r5, r4
+    cmp r3, #0
+    bne .Lprimeiro_5
+.Lprimeiro_4:
+    movs r1, r5
+    movs r3, #1
+.Lprimeiro_5:
+    adds r2, r2, #1
+    adds r4, r4, #3
+.Lprimeiro_2:
+    cmp r2, r0
+    blt .Lprimeiro_8
+.Lprimeiro_3:
+    movs r0, r1
+.Lep_primeiro:
+    pop {r4-r5}
+    bx lr
+.global main
+.thumb_func
+main:
+    push {r4-r5}
+    movs r2, #0
+    movs r3, #3
+    mvns r3, r3
+    b .Lmain_8
+.Lmain_4:
+    movs r4, r3
+    cmp r3, #0
+    ble .Lmain_7
+.Lmain_5:
+    cmp r4, #6
+    bge .Lmain_7
+.Lmain_6:
+    movs r0, r4
+.Lmain_7:
+    adds r2, r2, #1
+    adds r3, r3, #3
+.Lmain_8:
+    cmp r2, #6
+    blt .Lmain_4
+.Lmain_9:
+    movs r2, #0
+    movs r3, #0
+    movs r4, #96
+    b .Lmain_15
+.Lmain_12:
+    movs r5, r4
+    cmp r3, #0
+    bne .Lmain_14
+.Lmain_13:
+    movs r1, r5
+    movs r3, #1
+.Lmain_14:
+    adds r2, r2, #1
+    adds r4, r4, #3
+.Lmain_15:
+    cmp r2, #5
+    blt .Lmain_12
+.Lmain_16:
+    adds r0, r0, r1
+.Lep_main:
+    pop {r4-r5}
+    bx lr
+.arm
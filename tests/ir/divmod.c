@@ -0,0 +1,26 @@
+// Divisão e resto: por 2^k viram deslocamentos, pelas demais constantes
+// 'mulh' pelo número mágico mais ajustes; x % k vira x - (x/k)*k. Só
+// 'x % y', com y variável, continua chamando a biblioteca.
+int div7(int x) {
+    return x / 7;
+}
+
+int resto10(int x) {
+    return x % 10;
+}
+
+int resto8(int x) {
+    return x % 8;
+}
+
+int div_neg(int x) {
+    return x / -3;
+}
+
+int resto(int x, int y) {
+    return x % y;
+}
+
+int main() {
+    return div7(100) + resto10(-47) + resto8(-13) + div_neg(20) + resto(17, 5);
+}
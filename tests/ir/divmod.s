@@ -0,0 +1,104 @@
+.syntax unified
+.text
+.global _start
+_start:
+    ldr sp, =_stack_top   @ pilha = topo reservado no linker
+    ldr ip, =main
+    mov lr, pc
+    bx ip            @ chama main(), em Thumb
+    mov r7, #0x18     @ SYS_EXIT
+    svc 0x123456 
+.ltorg
+
+.text
+.thumb
+.global div7
+.thumb_func
+div7:
+    push {r4, lr}
+    movs r4, r0
+    movs r0, r4
+    ldr r1, =-1840700269
+    bl ____smulh_from_thumb
+    adds r0, r0, r4
+    asrs r0, r0, #2
+    lsrs r1, r0, #31
+    adds r0, r0, r1
+.Lep_div7:
+    pop {r4, pc}
+.ltorg
+.global resto10
+.thumb_func
+resto10:
+    push {r4, r6, lr}
+    movs r4, r0
+    movs r0, r4
+    ldr r1, =1717986919
+    bl ____smulh_from_thumb
+    asrs r0, r0, #2
+    lsrs r1, r0, #31
+    adds r0, r0, r1
+    movs r6, #10
+    muls r0, r6, r0
+    subs r0, r4, r0
+.Lep_resto10:
+    pop {r4, r6, pc}
+.ltorg
+.global resto8
+.thumb_func
+resto8:
+    asrs r1, r0, #31
+    lsrs r1, r1, #29
+    adds r1, r0, r1
+    asrs r1, r1, #3
+    lsls r1, r1, #3
+    subs r0, r0, r1
+.Lep_resto8:
+    bx lr
+.global div_neg
+.thumb_func
+div_neg:
+    push {r4, lr}
+    movs r4, r0
+    movs r0, r4
+    ldr r1, =1431655765
+    bl ____smulh_from_thumb
+    subs r0, r0, r4
+    asrs r0, r0, #1
+    lsrs r1, r0, #31
+    adds r0, r0, r1
+.Lep_div_neg:
+    pop {r4, pc}
+.ltorg
+.global resto
+.thumb_func
+resto:
+    push {lr}
+    bl ____aeabi_idivmod_from_thumb
+    movs r0, r1
+.Lep_resto:
+    pop {pc}
+.global main
+.thumb_func
+main:
+    movs r0, #1
+    mvns r0, r0
+.Lep_main:
+    bx lr
+.arm
+.thumb
+.align 2
+.thumb_func
+____smulh_from_thumb:
+    bx pc
+    nop 
+.arm
+    b __smulh
+.thumb
+.align 2
+.thumb_func
+____aeabi_idivmod_from_thumb:
+    bx pc
+    nop 
+.arm
+    b __aeabi_idivmod
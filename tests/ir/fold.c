@@ -0,0 +1,17 @@
+int scale(int x) {
+    return x * 1 + 0 + x * 0 + x * 8 + (2 + 3 * 4);
+}
+
+int halves(int x) {
+    return x / 2 + x / 16 + x / -4 + x / 1;
+}
+
+int main() {
+    int a = 5;
+    int b = a * 4;
+    if (1 && a == 5)
+        b = b + 1;
+    while (0)
+        b = b - 1;
+    return scale(b) + halves(b - 100) + (a < a);
+}
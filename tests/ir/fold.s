@@ -0,0 +1,49 @@
+.syntax unified
+.text
+.global _start
+_start:
+    ldr sp, =_stack_top   @ pilha = topo reservado no linker
+    ldr ip, =main
+    mov lr, pc
+    bx ip            @ chama main(), em Thumb
+    mov r7, #0x18     @ SYS_EXIT
+    svc 0x123456 
+.ltorg
+
+.text
+.thumb
+.global scale
+.thumb_func
+scale:
+    lsls r1, r0, #3
+    adds r0, r0, r1
+    adds r0, #14
+.Lep_scale:
+    bx lr
+.global halves
+.thumb_func
+halves:
+    lsrs r1, r0, #31
+    adds r1, r0, r1
+    asrs r1, r1, #1
+    asrs r2, r0, #31
+    lsrs r2, r2, #28
+    adds r2, r0, r2
+    asrs r2, r2, #4
+    adds r1, r1, r2
+    asrs r2, r0, #31
+    lsrs r2, r2, #30
+    adds r2, r0, r2
+    asrs r2, r2, #2
+    rsbs r2, r2, #0
+    adds r1, r1, r2
+    adds r0, r1, r0
+.Lep_halves:
+    bx lr
+.global main
+.thumb_func
+main:
+    movs r0, #100
+.Lep_main:
+    bx lr
+.arm
@@ -0,0 +1,33 @@
+// Inlining: 'quadrado' e 'soma3' são expandidas em main (o endereço
+// tomado em 'dobro' ganha um slot próprio em main); 'fatorial' é
+// recursiva e continua sendo chamada. Com -finline-limit=0 nada muda.
+int quadrado(int x) {
+    return x * x;
+}
+
+int dobro(int x) {
+    int y;
+    int *p;
+    y = x;
+    p = &y;
+    *p = *p * 2;
+    return y;
+}
+
+int soma3(int a, int b, int c) {
+    return quadrado(a) + dobro(b) + c;
+}
+
+int fatorial(int n) {
+    if (n <= 1) return 1;
+    return n * fatorial(n - 1);
+}
+
+int main() {
+    int i;
+    int s;
+    s = 0;
+    for (i = 0; i < 4; i++)
+        s = s + soma3(i, s, 1);
+    return s + fatorial(5);
+}
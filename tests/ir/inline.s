@@ -0,0 +1,117 @@
+.syntax unified
+.text
+.global _start
+_start:
+    ldr sp, =_stack_top   @ pilha = topo reservado no linker
+    ldr ip, =main
+    mov lr, pc
+    bx ip            @ chama main(), em Thumb
+    mov r7, #0x18     @ SYS_EXIT
+    svc 0x123456 
+.ltorg
+
+.text
+.thumb
+.global quadrado
+.thumb_func
+quadrado:
+    push {r6}
+    movs r6, r0
+    muls r0, r6, r0
+.Lep_quadrado:
+    pop {r6}
+    bx lr
+.global dobro
+.thumb_func
+dobro:
+    sub sp, #4
+    str r0, [sp, #0]
+    add r0, sp, #0
+    ldr r1, [r0, #0]
+    lsls r1, r1, #1
+    str r1, [r0, #0]
+    ldr r0, [sp, #0]
+.Lep_dobro:
+    add sp, #4
+    bx lr
+.global soma3
+.thumb_func
+soma3:
+    push {r6}
+    sub sp, #4
+    movs r6, r0
+    muls r0, r6, r0
+    str r1, [sp, #0]
+    add r1, sp, #0
+    ldr r3, [r1, #0]
+    lsls r3, r3, #1
+    str r3, [r1, #0]
+    ldr r1, [sp, #0]
+    adds r0, r0, r1
+    adds r0, r0, r2
+.Lep_soma3:
+    add sp, #4
+    pop {r6}
+    bx lr
+.global fatorial
+.thumb_func
+fatorial:
+    movs r1, #1
+.Lfatorial_5:
+    cmp r0, #1
+    bgt .Lfatorial_2
+.Lfatorial_1:
+    movs r0, r1
+    bx lr
+.Lfatorial_2:
+    subs r2, r0, #1
+    muls r1, r0, r1
+    movs r0, r2
+    b .Lfatorial_5
+.Lep_fatorial:
+    bx lr
+.global main
+.thumb_func
+main:
+    push {r4, lr}
+    sub sp, #4
+    movs r4, #0
+    movs r0, #0
+    add r1, sp, #0
+    b .Lmain_3
+.Lmain_7:
+    movs r2, r0
+    muls r2, r0, r2
+    str r4, [sp, #0]
+    ldr r3, [r1, #0]
+    lsls r3, r3, #1
+    str r3, [r1, #0]
+    ldr r3, [sp, #0]
+    adds r2, r2, r3
+    adds r2, r2, #1
+    adds r4, r4, r2
+    adds r0, r0, #1
+    movs r2, r0
+    muls r2, r0, r2
+    str r4, [sp, #0]
+    ldr r3, [r1, #0]
+    lsls r3, r3, #1
+    str r3, [r1, #0]
+    ldr r3, [sp, #0]
+    adds r2, r2, r3
+    adds r2, r2, #1
+    adds r4, r4, r2
+    adds r0, r0, #1
+.Lmain_3:
+    cmp r0, #4
+    blt .Lmain_7
+.Lmain_4:
+    movs r0, #5
+    bl fatorial
+    adds r0, r4, r0
+.Lep_main:
+    add sp, #4
+    pop {r4}
+    pop {r3}
+    bx r3
+.arm
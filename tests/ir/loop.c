@@ -0,0 +1,32 @@
+// Laços: em 'soma' o endereço v + i*4 vira um ponteiro que anda 4 bytes
+// por volta (redução de força) e 'k * 2' sai do laço (LICM); 'soma8'
+// tem contagem constante e é desenrolado 4 vezes, com os loads em
+// [p], [p, #4], [p, #8], [p, #12] e uma só soma do ponteiro por volta.
+int a0 = 1;
+int a1 = 2;
+int a2 = 3;
+int a3 = 4;
+int a4 = 5;
+int a5 = 6;
+int a6 = 7;
+int a7 = 8;
+
+int soma(int *v, int n, int k) {
+    int s = 0;
+    int i;
+    for (i = 0; i < n; i = i + 1)
+        s = s + *(v + i) + k * 2;
+    return s;
+}
+
+int soma8(int *v) {
+    int s = 0;
+    int i;
+    for (i = 0; i < 8; i = i + 1)
+        s = s + *(v + i);
+    return s;
+}
+
+int main() {
+    return soma(&a0, 8, 3) + soma8(&a0);
+}
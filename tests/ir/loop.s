@@ -0,0 +1,134 @@
+.syntax unified
+.text
+.global _start
+_start:
+    ldr sp, =_stack_top   @ pilha = topo reservado no linker
+    ldr ip, =main
+    mov lr, pc
+    bx ip            @ chama main(), em Thumb
+    mov r7, #0x18     @ SYS_EXIT
+    svc 0x123456 
+.ltorg
+
+.data
+a0:
+    .word 1
+a1:
+    .word 2
+a2:
+    .word 3
+a3:
+    .word 4
+a4:
+    .word 5
+a5:
+    .word 6
+a6:
+    .word 7
+a7:
+    .word 8
+.text
+.thumb
+.global soma
+.thumb_func
+soma:
+    push {r4-r5}
+    mov ip, r0
+    movs r0, r2
+    movs r2, r1
+    mov r1, ip
+    movs r3, #0
+    movs r4, #0
+    lsls r0, r0, #1
+    b .Lsoma_3
+.Lsoma_1:
+    ldr r5, [r1, #0]
+    adds r5, r3, r5
+    adds r3, r5, r0
+    adds r4, r4, #1
+    adds r1, r1, #4
+.Lsoma_3:
+    cmp r4, r2
+    blt .Lsoma_1
+.Lsoma_4:
+    movs r0, r3
+.Lep_soma:
+    pop {r4-r5}
+    bx lr
+.global soma8
+.thumb_func
+soma8:
+    movs r1, #0
+    movs r2, #0
+    b .Lsoma8_3
+.Lsoma8_1:
+    ldr r3, [r0, #0]
+    adds r1, r1, r3
+    ldr r3, [r0, #4]
+    adds r1, r1, r3
+    ldr r3, [r0, #8]
+    adds r1, r1, r3
+    ldr r3, [r0, #12]
+    adds r1, r1, r3
+    adds r2, r2, #4
+    adds r0, #16
+.Lsoma8_3:
+    cmp r2, #8
+    blt .Lsoma8_1
+.Lsoma8_4:
+    movs r0, r1
+.Lep_soma8:
+    bx lr
+.global main
+.thumb_func
+main:
+    push {r4}
+    ldr r0, =a0
+    movs r1, #0
+    movs r2, #0
+    b .Lmain_5
+.Lmain_4:
+    ldr r3, [r0, #0]
+    adds r3, r1, r3
+    adds r1, r3, #6
+    ldr r3, [r0, #4]
+    adds r3, r1, r3
+    adds r1, r3, #6
+    ldr r3, [r0, #8]
+    adds r3, r1, r3
+    adds r1, r3, #6
+    ldr r3, [r0, #12]
+    adds r3, r1, r3
+    adds r1, r3, #6
+    adds r2, r2, #4
+    adds r0, #16
+.Lmain_5:
+    cmp r2, #8
+    blt .Lmain_4
+.Lmain_6:
+    movs r0, r1
+    ldr r1, =a0
+    movs r2, #0
+    movs r3, #0
+    b .Lmain_10
+.Lmain_9:
+    ldr r4, [r1, #0]
+    adds r2, r2, r4
+    ldr r4, [r1, #4]
+    adds r2, r2, r4
+    ldr r4, [r1, #8]
+    adds r2, r2, r4
+    ldr r4, [r1, #12]
+    adds r2, r2, r4
+    adds r3, r3, #4
+    adds r1, #16
+.Lmain_10:
+    cmp r3, #8
+    blt .Lmain_9
+.Lmain_11:
+    adds r0, r0, r2
+.Lep_main:
+    pop {r4}
+    bx lr
+.ltorg
+.arm
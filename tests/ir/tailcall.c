@@ -0,0 +1,27 @@
+// Chamadas de cauda: 'mdc' chama a si mesma na cauda e vira laço;
+// 'soma' (return n + soma(n - 1)) vira laço com acumulador, sem pilha
+// proporcional a n; 'dobra' termina chamando outra função e vira
+// 'tailcall' (b depois do epílogo). 'fib' só tem a segunda chamada
+// em cauda (acumulada); a primeira continua recursiva.
+int mdc(int a, int b) {
+    if (b == 0) return a;
+    return mdc(b, a - a / b * b);
+}
+
+int soma(int n) {
+    if (n == 0) return 0;
+    return n + soma(n - 1);
+}
+
+int fib(int n) {
+    if (n < 2) return n;
+    return fib(n - 1) + fib(n - 2);
+}
+
+int dobra(int x) {
+    return mdc(x * 2, 6);
+}
+
+int main() {
+    return mdc(1071, 462) + soma(100000) + fib(10) + dobra(9);
+}
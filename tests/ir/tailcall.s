@@ -0,0 +1,117 @@
+.syntax unified
+.text
+.global _start
+_start:
+    ldr sp, =_stack_top   @ pilha = topo reservado no linker
+    ldr ip, =main
+    mov lr, pc
+    bx ip            @ chama main(), em Thumb
+    mov r7, #0x18     @ SYS_EXIT
+    svc 0x123456 
+.ltorg
+
+.text
+.thumb
+.global mdc
+.thumb_func
+mdc:
+    push {r4-r5, lr}
+    movs r4, r0
+    movs r5, r1
+.Lmdc_5:
+    cmp r5, #0
+    bne .Lmdc_2
+.Lmdc_1:
+    movs r0, r4
+    b .Lep_mdc
+.Lmdc_2:
+    movs r0, r4
+    movs r1, r5
+    bl ____aeabi_idiv_from_thumb
+    muls r0, r5, r0
+    subs r0, r4, r0
+    movs r4, r5
+    movs r5, r0
+    b .Lmdc_5
+.Lep_mdc:
+    pop {r4-r5, pc}
+.global soma
+.thumb_func
+soma:
+    movs r1, #0
+.Lsoma_5:
+    cmp r0, #0
+    bne .Lsoma_2
+.Lsoma_1:
+    movs r0, r1
+    bx lr
+.Lsoma_2:
+    subs r2, r0, #1
+    adds r1, r1, r0
+    movs r0, r2
+    b .Lsoma_5
+.Lep_soma:
+    bx lr
+.global fib
+.thumb_func
+fib:
+    push {r4-r5, lr}
+    movs r4, r0
+    movs r5, #0
+.Lfib_5:
+    cmp r4, #2
+    bge .Lfib_2
+.Lfib_1:
+    adds r0, r5, r4
+    b .Lep_fib
+.Lfib_2:
+    subs r0, r4, #1
+    bl fib
+    subs r1, r4, #2
+    adds r5, r5, r0
+    movs r4, r1
+    b .Lfib_5
+.Lep_fib:
+    pop {r4-r5, pc}
+.global dobra
+.thumb_func
+dobra:
+    push {lr}
+    lsls r0, r0, #1
+    movs r1, #6
+    bl mdc
+.Lep_dobra:
+    pop {pc}
+.global main
+.thumb_func
+main:
+    push {r4, lr}
+    ldr r0, =1071
+    movs r1, #255
+    adds r1, #207
+    bl mdc
+    movs r4, r0
+    ldr r0, =100000
+    bl soma
+    adds r4, r4, r0
+    movs r0, #10
+    bl fib
+    adds r4, r4, r0
+    movs r0, #18
+    movs r1, #6
+    bl mdc
+    adds r0, r4, r0
+.Lep_main:
+    pop {r4}
+    pop {r3}
+    bx r3
+.ltorg
+.arm
+.thumb
+.align 2
+.thumb_func
+____aeabi_idiv_from_thumb:
+    bx pc
+    nop 
+.arm
+    b __aeabi_idiv
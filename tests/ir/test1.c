@@ -0,0 +1,25 @@
+int g;
+
+int clamp(int x, int lo, int hi) {
+    if (x < lo || x > hi) {
+        if (x < lo)
+            return lo;
+        return hi;
+    }
+    return x;
+}
+
+int sum(int n) {
+    int s = 0;
+    for (int i = 0; i < n && s < 1000; i++)
+        s = s + i;
+    return s;
+}
+
+int main() {
+    int a = 3;
+    int *p = &a;
+    *p = *p + 1;
+    g = sum(a) + (a > 2 && g == 0);
+    return g;
+}
@@ -0,0 +1,120 @@
+.syntax unified
+.text
+.global _start
+_start:
+    ldr sp, =_stack_top   @ pilha = topo reservado no linker
+    ldr r0, =_bss_start
+    mov r1, #0
+    str r1, [r0, #0]
+    ldr ip, =main
+    mov lr, pc
+    bx ip            @ chama main(), em Thumb
+    mov r7, #0x18     @ SYS_EXIT
+    svc 0x123456 
+.ltorg
+
+.bss
+g:
+    .space 4
+.text
+.thumb
+.global clamp
+.thumb_func
+clamp:
+    mov ip, r0
+    movs r0, r1
+    movs r1, r2
+    mov r2, ip
+    cmp r2, r0
+    blt .Lclamp_1
+.Lclamp_3:
+    cmp r1, r2
+    bge .Lclamp_2
+.Lclamp_1:
+    cmp r2, r0
+    bge .Lclamp_5
+.Lclamp_4:
+    bx lr
+.Lclamp_5:
+    movs r0, r1
+    bx lr
+.Lclamp_2:
+    movs r0, r2
+.Lep_clamp:
+    bx lr
+.global sum
+.thumb_func
+sum:
+    push {r6}
+    movs r1, #0
+    movs r2, #0
+    b .Lsum_3
+.Lsum_1:
+    adds r1, r1, r2
+    adds r2, r2, #1
+.Lsum_3:
+    cmp r2, r0
+    bge .Lsum_4
+.Lsum_5:
+    movs r6, #125
+    lsls r6, r6, #3
+    cmp r1, r6
+    blt .Lsum_1
+.Lsum_4:
+    movs r0, r1
+.Lep_sum:
+    pop {r6}
+    bx lr
+.global main
+.thumb_func
+main:
+    push {r6}
+    sub sp, #4
+    movs r6, #3
+    str r6, [sp, #0]
+    add r0, sp, #0
+    ldr r1, [r0, #0]
+    adds r1, r1, #1
+    str r1, [r0, #0]
+    ldr r0, [sp, #0]
+    movs r1, #0
+    movs r2, #0
+    b .Lmain_9
+.Lmain_8:
+    adds r1, r1, r2
+    adds r2, r2, #1
+.Lmain_9:
+    cmp r2, r0
+    bge .Lmain_11
+.Lmain_10:
+    movs r6, #125
+    lsls r6, r6, #3
+    cmp r1, r6
+    blt .Lmain_8
+.Lmain_11:
+    movs r0, r1
+    ldr r1, [sp, #0]
+    cmp r1, #2
+    ble .Lmain_2
+.Lmain_4:
+    ldr r1, =g
+    ldr r1, [r1, #0]
+    cmp r1, #0
+    bne .Lmain_2
+.Lmain_1:
+    movs r1, #1
+    b .Lmain_3
+.Lmain_2:
+    movs r1, #0
+.Lmain_3:
+    adds r0, r0, r1
+    ldr r1, =g
+    str r0, [r1, #0]
+    ldr r0, =g
+    ldr r0, [r0, #0]
+.Lep_main:
+    add sp, #4
+    pop {r6}
+    bx lr
+.ltorg
+.arm
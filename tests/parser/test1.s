@@ -0,0 +1,27 @@
+.syntax unified
+.text
+.global _start
+_start:
+    ldr sp, =_stack_top   @ pilha = topo reservado no linker
+    ldr ip, =main
+    mov lr, pc
+    bx ip            @ chama main(), em Thumb
+    mov r7, #0x18     @ SYS_EXIT
+    svc 0x123456 
+.ltorg
+
+.text
+.thumb
+.global add
+.thumb_func
+add:
+    adds r0, r0, r1
+.Lep_add:
+    bx lr
+.global main
+.thumb_func
+main:
+    movs r0, #5
+.Lep_main:
+    bx lr
+.arm
@@ -0,0 +1,30 @@
+.syntax unified
+.text
+.global _start
+_start:
+    ldr sp, =_stack_top   @ pilha = topo reservado no linker
+    ldr ip, =main
+    mov lr, pc
+    bx ip            @ chama main(), em Thumb
+    mov r7, #0x18     @ SYS_EXIT
+    svc 0x123456 
+.ltorg
+
+.text
+.thumb
+.global main
+.thumb_func
+main:
+    movs r0, #2
+    movs r1, #0
+    b .Lmain_3
+.Lmain_1:
+    lsls r0, r0, #1
+    adds r1, r1, #1
+.Lmain_3:
+    cmp r1, #5
+    blt .Lmain_1
+.Lmain_4:
+.Lep_main:
+    bx lr
+.arm
@@ -0,0 +1,59 @@
+.syntax unified
+.text
+.global _start
+_start:
+    ldr sp, =_stack_top   @ pilha = topo reservado no linker
+    ldr r0, =_bss_start
+    mov r1, #0
+    str r1, [r0, #0]
+    ldr ip, =main
+    mov lr, pc
+    bx ip            @ chama main(), em Thumb
+    mov r7, #0x18     @ SYS_EXIT
+    svc 0x123456 
+.ltorg
+
+.data
+y:
+    .word 123
+.bss
+x:
+    .space 4
+.text
+.thumb
+.global add
+.thumb_func
+add:
+    adds r0, r0, r1
+.Lep_add:
+    bx lr
+.global main
+.thumb_func
+main:
+    push {r6}
+    ldr r0, =x
+    movs r6, #2
+    str r6, [r0, #0]
+    movs r0, #0
+    ldr r1, =x
+    ldr r2, =x
+    b .Lmain_3
+.Lmain_1:
+    ldr r3, [r1, #0]
+    lsls r3, r3, #1
+    str r3, [r2, #0]
+    adds r0, r0, #1
+.Lmain_3:
+    cmp r0, #5
+    blt .Lmain_1
+.Lmain_4:
+    ldr r0, =x
+    ldr r0, [r0, #0]
+    ldr r1, =y
+    ldr r1, [r1, #0]
+    adds r0, r0, r1
+.Lep_main:
+    pop {r6}
+    bx lr
+.ltorg
+.arm
@@ -0,0 +1,29 @@
+.syntax unified
+.text
+.global _start
+_start:
+    ldr sp, =_stack_top   @ pilha = topo reservado no linker
+    ldr ip, =main
+    mov lr, pc
+    bx ip            @ chama main(), em Thumb
+    mov r7, #0x18     @ SYS_EXIT
+    svc 0x123456 
+.ltorg
+
+.text
+.thumb
+.global main
+.thumb_func
+main:
+    push {r6}
+    sub sp, #4
+    movs r6, #4
+    str r6, [sp, #0]
+    add r0, sp, #0
+    ldr r0, [r0, #0]
+    adds r0, r0, #1
+.Lep_main:
+    add sp, #4
+    pop {r6}
+    bx lr
+.arm
@@ -0,0 +1,9 @@
+int main() {
+    int x;
+    int *p;
+    int **pp;
+    p = &x;
+    pp = &p;
+    p = pp;                       // erro: int* <- int**
+    return 0;
+}
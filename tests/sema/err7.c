@@ -0,0 +1,3 @@
+int main() {
+    return f(1);     // f não declarada: um único erro
+}